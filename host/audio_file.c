@@ -0,0 +1,183 @@
+#include "audio_file.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WAVE_FORMAT_PCM         0x0001
+#define WAVE_FORMAT_IEEE_FLOAT  0x0003
+#define WAVE_FORMAT_EXTENSIBLE  0xFFFE
+
+static uint16_t readLE16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t readLE32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Convert one little-endian sample to a left-justified int32
+static int32_t decodeSample(const uint8_t *p, int format, int bits)
+{
+    if (format == WAVE_FORMAT_IEEE_FLOAT)
+    {
+        uint32_t raw = readLE32(p);
+        float f;
+        memcpy(&f, &raw, sizeof(f));
+        if (isnan(f))
+            f = 0.0f;
+        double v = (double)f * 2147483648.0;
+        if (v > 2147483647.0)  v = 2147483647.0;
+        if (v < -2147483648.0) v = -2147483648.0;
+        return (int32_t)v;
+    }
+
+    switch (bits)
+    {
+        case 16: return (int32_t)((uint32_t)readLE16(p) << 16);
+        case 24: return (int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 24));
+        default: return (int32_t)readLE32(p);
+    }
+}
+
+bool audioLoadWav(const char *path, int channel, audio_clip_t *clip)
+{
+    memset(clip, 0, sizeof(*clip));
+
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL)
+    {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+
+    uint8_t hdr[12];
+    if (fread(hdr, 1, sizeof(hdr), fp) != sizeof(hdr) ||
+        memcmp(hdr, "RIFF", 4) != 0 || memcmp(hdr + 8, "WAVE", 4) != 0)
+    {
+        fprintf(stderr, "%s: not a RIFF/WAVE file\n", path);
+        fclose(fp);
+        return false;
+    }
+
+    int format = 0, channels = 0, bits = 0;
+    uint32_t rate = 0;
+    bool ok = false;
+
+    // Walk chunks until "data"
+    uint8_t chunk[8];
+    while (fread(chunk, 1, sizeof(chunk), fp) == sizeof(chunk))
+    {
+        uint32_t size = readLE32(chunk + 4);
+
+        if (memcmp(chunk, "fmt ", 4) == 0)
+        {
+            uint8_t fmt[40] = {0};
+            size_t want = size < sizeof(fmt) ? size : sizeof(fmt);
+            if (size < 16 || fread(fmt, 1, want, fp) != want)
+                break;
+            fseek(fp, (long)(size - want + (size & 1)), SEEK_CUR);
+
+            format   = readLE16(fmt + 0);
+            channels = readLE16(fmt + 2);
+            rate     = readLE32(fmt + 4);
+            bits     = readLE16(fmt + 14);
+            if (format == WAVE_FORMAT_EXTENSIBLE && size >= 26)
+                format = readLE16(fmt + 24);    // SubFormat GUID starts with the format tag
+        }
+        else if (memcmp(chunk, "data", 4) == 0)
+        {
+            bool pcm_ok   = format == WAVE_FORMAT_PCM && (bits == 16 || bits == 24 || bits == 32);
+            bool float_ok = format == WAVE_FORMAT_IEEE_FLOAT && bits == 32;
+            if (!(pcm_ok || float_ok) || channels <= 0)
+            {
+                fprintf(stderr, "%s: unsupported format %d / %d-bit\n", path, format, bits);
+                break;
+            }
+            if (channel < 0 || channel >= channels)
+            {
+                fprintf(stderr, "%s: channel %d out of range (%d channels)\n", path, channel, channels);
+                break;
+            }
+
+            size_t frame_bytes = (size_t)channels * (bits / 8);
+            size_t frames = size / frame_bytes;
+            uint8_t *raw = malloc(frames * frame_bytes);
+            clip->samples = malloc(sizeof(int32_t) * (frames ? frames : 1));
+            if (raw == NULL || clip->samples == NULL)
+            {
+                free(raw);
+                break;
+            }
+
+            frames = fread(raw, frame_bytes, frames, fp);
+            for (size_t i = 0; i < frames; i++)
+                clip->samples[i] = decodeSample(raw + i * frame_bytes + channel * (bits / 8), format, bits);
+
+            free(raw);
+            clip->count = frames;
+            clip->sample_rate = rate;
+            ok = true;
+            break;
+        }
+        else
+        {
+            fseek(fp, (long)(size + (size & 1)), SEEK_CUR);
+        }
+    }
+
+    fclose(fp);
+    if (!ok)
+    {
+        if (format == 0)
+            fprintf(stderr, "%s: missing fmt/data chunk\n", path);
+        audioFree(clip);
+    }
+    return ok;
+}
+
+bool audioLoadRaw(const char *path, uint32_t sample_rate, audio_clip_t *clip)
+{
+    memset(clip, 0, sizeof(*clip));
+
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL)
+    {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    long bytes = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    size_t count = bytes > 0 ? (size_t)bytes / sizeof(int32_t) : 0;
+    uint8_t *raw = malloc(count * sizeof(int32_t) + 1);
+    clip->samples = malloc(sizeof(int32_t) * (count ? count : 1));
+    if (raw == NULL || clip->samples == NULL)
+    {
+        free(raw);
+        fclose(fp);
+        audioFree(clip);
+        return false;
+    }
+
+    count = fread(raw, sizeof(int32_t), count, fp);
+    for (size_t i = 0; i < count; i++)
+        clip->samples[i] = (int32_t)readLE32(raw + i * sizeof(int32_t));
+
+    free(raw);
+    fclose(fp);
+    clip->count = count;
+    clip->sample_rate = sample_rate;
+    return true;
+}
+
+void audioFree(audio_clip_t *clip)
+{
+    free(clip->samples);
+    clip->samples = NULL;
+    clip->count = 0;
+}
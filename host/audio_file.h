@@ -0,0 +1,28 @@
+#pragma once
+
+/*
+ * Loads WAV or raw captures into memory as left-justified int32 samples,
+ * the same format vTaskI2SReader hands to the DSP core.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    int32_t *samples;       // One channel, left-justified to 32 bits
+    size_t   count;         // Number of samples
+    uint32_t sample_rate;   // Hz
+} audio_clip_t;
+
+/**
+ * @brief Load one channel of a PCM (16/24/32-bit) or float32 WAV file
+ */
+bool audioLoadWav(const char *path, int channel, audio_clip_t *clip);
+
+/**
+ * @brief Load a raw little-endian int32 mono capture
+ */
+bool audioLoadRaw(const char *path, uint32_t sample_rate, audio_clip_t *clip);
+
+void audioFree(audio_clip_t *clip);
@@ -0,0 +1,332 @@
+/*
+ * Detector benchmark over the synthetic corpus (corpus.h). Streams every
+ * clip through the DSP core and the alarm lifecycle exactly as the firmware
+ * does, once per decision mode, and reports per mode:
+ *
+ *   - time to detect: onset of the alarm to its first confirmed frame (p50, p90, max)
+ *   - miss rate: alarm clips with no confirmation after the onset
+ *   - false alarms per hour: alarm starts in audio with no alarm in it
+ *   - CPU: ns per analyzed frame (dspStreamPush, the gated spectrum stage and detection)
+ *   - gated: frames the energy gate kept from the transform; with --audit every
+ *     one is transformed anyway, and a tone found in one is a gate miss
+ *
+ * The last line is one score per build, lower is better: for each mode,
+ * miss % + false alarms per hour + p90 time to detect in s + us per frame,
+ * summed over the modes. A point is about a 1% miss, one false alarm an
+ * hour, a second of latency or a microsecond of CPU per frame.
+ *
+ * The engine (FFT, Goertzel, Q15, zoom FFT) and threshold are fixed at compile time;
+ * the host build has one benchmark binary per engine.
+ *
+ *   bench [--quick] [--mode short|long] [--verbose] [--audit] [--max-score X] [--dump DIR]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "corpus.h"
+#include "dsp_alarm.h"
+#include "dsp_core.h"
+#include "wav_format.h"
+
+#define MAX_CASES   256
+
+typedef struct {
+    const char *name;
+    bool long_window;
+} bench_mode_t;
+
+static const bench_mode_t modes[] = {
+    { "short", false },
+    { "long",  true  },
+};
+#define MODE_COUNT  ((int)(sizeof(modes) / sizeof(modes[0])))
+
+typedef struct {
+    int alarms;
+    int detected;
+    float latency_s[MAX_CASES];     // Per detected alarm clip
+    int false_alarms;
+    double quiet_s;                 // Audio without an alarm
+    int64_t frame_ns;
+    size_t frames;
+    size_t gated;                   // Below the energy gate (transformed only when audited)
+    size_t gate_misses;             // Audited gated frames with a tone on
+} bench_result_t;
+
+static bench_result_t results[MODE_COUNT];
+
+
+static int64_t nowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  --quick        small corpus (every kind, extreme levels)\n"
+        "  --mode NAME    only run short or long window decisions\n"
+        "  --verbose      result of every clip\n"
+        "  --audit        transform every gated frame and count gate misses (CPU as without the gate)\n"
+        "  --max-score X  exit 1 if the score is above X\n"
+        "  --dump DIR     also write every clip to DIR as 32-bit WAV (for replay)\n",
+        prog);
+}
+
+static bool dumpClip(const char *dir, const corpus_case_t *c, const audio_clip_t *clip)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.wav", dir, c->name);
+
+    uint8_t *data = malloc(clip->count * sizeof(int32_t));
+    FILE *f = fopen(path, "wb");
+    bool ok = data != NULL && f != NULL;
+    if (ok)
+    {
+        uint8_t header[WAV_HEADER_SIZE];
+        int bytes = wavPackSamples(clip->samples, (int)clip->count, 32, data);
+        wavHeader(header, clip->sample_rate, 32, 1, (uint32_t)bytes);
+        ok = fwrite(header, 1, sizeof(header), f) == sizeof(header) &&
+             fwrite(data, 1, bytes, f) == (size_t)bytes;
+    }
+    if (f != NULL)
+        fclose(f);
+    free(data);
+    if (!ok)
+        fprintf(stderr, "%s: cannot write\n", path);
+    return ok;
+}
+
+
+// Stream one clip in capture-sized blocks, as vFFTProcessorTask receives them
+static void runCase(const corpus_case_t *c, const audio_clip_t *clip, bench_result_t *r, bool verbose,
+                    const char *mode)
+{
+    bool alarm = c->kind == CORPUS_T3_ALARM;
+    size_t onset = alarm ? (size_t)(c->onset_s * clip->sample_rate) : clip->count;
+    size_t blocks = clip->count / SAMPLE_BUFFER_SIZE;
+    float latency = -1.0f;
+    int falseAlarms = 0;
+
+    dspCoreReset();
+    alarmReset();
+
+    for (size_t b = 0; b < blocks; b++)
+    {
+        const int32_t *block = clip->samples + b * SAMPLE_BUFFER_SIZE;
+        size_t position = b * SAMPLE_BUFFER_SIZE;
+        int left = SAMPLE_BUFFER_SIZE;
+
+        while (left > 0)
+        {
+            int64_t t0 = nowNs();
+            int used = dspStreamPush(block, left);
+            r->frame_ns += nowNs() - t0;
+            block += used;
+            left -= used;
+            position += used;
+
+            if (dspStreamFrame() == NULL)
+                continue;
+
+            static dsp_spectrum_t spectrum;
+            dsp_detection_t detection;
+            t0 = nowNs();
+            dspComputeStreamSpectrum(&spectrum);
+            bool confirmed = dspAnalyzeSpectrum(&spectrum, &detection);
+            r->frame_ns += nowNs() - t0;
+            r->frames++;
+            r->gated += spectrum.gate != DSP_GATE_OPEN;
+            r->gate_misses += spectrum.gate == DSP_GATE_AUDIT && detection.tone_on;
+            dspStreamAdvance();
+
+            // Frame time: its last sample
+            int64_t now_ms = (int64_t)position * 1000 / clip->sample_rate;
+            alarm_report_t report;
+            if (alarmUpdate(&detection, now_ms, &report) && report.phase == ALARM_START && position < onset)
+                falseAlarms++;
+
+            if (confirmed && position >= onset && latency < 0.0f)
+                latency = (float)(position - onset) / clip->sample_rate;
+        }
+    }
+
+    r->false_alarms += falseAlarms;
+    r->quiet_s += (double)(onset < clip->count ? onset : clip->count) / clip->sample_rate;
+    if (alarm)
+    {
+        r->alarms++;
+        if (latency >= 0.0f)
+            r->latency_s[r->detected++] = latency;
+    }
+
+    if (verbose)
+    {
+        printf("  %-5s %-36s", mode, c->name);
+        if (alarm)
+            printf(latency >= 0.0f ? " detected %5.2f s" : " MISSED          ", latency);
+        else
+            printf("                 ");
+        printf(falseAlarms ? "  %d false alarm%s\n" : "\n", falseAlarms, falseAlarms == 1 ? "" : "s");
+    }
+}
+
+
+static int compareFloat(const void *a, const void *b)
+{
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of a sorted array
+static float percentile(const float *sorted, int count, int pct)
+{
+    if (count == 0)
+        return 0.0f;
+    int rank = (pct * count + 99) / 100;
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+
+int main(int argc, char **argv)
+{
+    bool quick = false, verbose = false, audit = false;
+    const char *only = NULL, *dumpDir = NULL;
+    double maxScore = -1.0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--quick") == 0)
+            quick = true;
+        else if (strcmp(argv[i], "--verbose") == 0)
+            verbose = true;
+        else if (strcmp(argv[i], "--audit") == 0)
+            audit = true;
+        else if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc)
+            only = argv[++i];
+        else if (strcmp(argv[i], "--max-score") == 0 && i + 1 < argc)
+            maxScore = atof(argv[++i]);
+        else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc)
+            dumpDir = argv[++i];
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    bool enabled[MODE_COUNT];
+    bool any = false;
+    for (int m = 0; m < MODE_COUNT; m++)
+    {
+        enabled[m] = only == NULL || strcmp(only, modes[m].name) == 0;
+        any |= enabled[m];
+    }
+    if (!any)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (!dspCoreInit())
+    {
+        fprintf(stderr, "Failed to initialize FFT\n");
+        return 1;
+    }
+    if (audit)
+        dspGateSetAudit(1);
+
+    static corpus_case_t cases[MAX_CASES];
+    int caseCount = corpusCases(cases, MAX_CASES, quick);
+    uint32_t rate = (uint32_t)I2S_SAMPLE_RATE_HZ;
+    double audio_s = 0.0;
+    for (int i = 0; i < caseCount; i++)
+        audio_s += cases[i].length_s;
+
+    printf("corpus: %d clips, %.1f min @ %u Hz, analyzed at %d Hz, frame %d / hop %d\n",
+           caseCount, audio_s / 60.0, (unsigned)rate, (int)SAMPLE_RATE, FFT_SIZE, HOP_SIZE);
+    printf("engine: %s, %s", USE_FIXED_POINT ? "q15 real fft" : (USE_ZOOM_FFT ? "zoom fft" :
+           (USE_GOERTZEL ? "goertzel" : (USE_REAL_FFT ? "real fft" : "complex fft"))),
+           LONG_WINDOW_SLIDING ? "sliding long window" : "tumbling long window");
+    if (USE_NOISE_FLOOR)
+        printf(", %.1f dB over noise floor", NOISE_FLOOR_SNR_DB);
+    else
+        printf(", threshold %.1f dB", THRESHOLD_DB);
+    if (USE_ENERGY_GATE)
+        printf(", energy gate %.0f dB under\n", GATE_MARGIN_DB);
+    else
+        printf(", no energy gate\n");
+
+    // Each clip is generated once and run through every mode
+    for (int i = 0; i < caseCount; i++)
+    {
+        audio_clip_t clip;
+        if (!corpusRender(&cases[i], rate, &clip))
+        {
+            fprintf(stderr, "%s: out of memory\n", cases[i].name);
+            return 1;
+        }
+        if (dumpDir != NULL && !dumpClip(dumpDir, &cases[i], &clip))
+        {
+            audioFree(&clip);
+            return 1;
+        }
+
+        for (int m = 0; m < MODE_COUNT; m++)
+        {
+            if (!enabled[m])
+                continue;
+
+            detector_config_t cfg;
+            detectorConfigDefaults(&cfg);
+            cfg.long_window = modes[m].long_window;
+            if (dspCoreConfigure(&cfg) != DSP_CONFIG_OK)
+            {
+                fprintf(stderr, "Failed to configure %s window\n", modes[m].name);
+                audioFree(&clip);
+                return 1;
+            }
+            runCase(&cases[i], &clip, &results[m], verbose, modes[m].name);
+        }
+        audioFree(&clip);
+    }
+
+    printf("mode   detected  miss %%   ttd p50    p90    max   false alarms  per hour   ns/frame  gated %%\n");
+    double score = 0.0;
+    for (int m = 0; m < MODE_COUNT; m++)
+    {
+        if (!enabled[m])
+            continue;
+
+        bench_result_t *r = &results[m];
+        qsort(r->latency_s, r->detected, sizeof(float), compareFloat);
+        double miss = r->alarms ? 100.0 * (r->alarms - r->detected) / r->alarms : 0.0;
+        double perHour = r->quiet_s > 0.0 ? r->false_alarms * 3600.0 / r->quiet_s : 0.0;
+        double p90 = percentile(r->latency_s, r->detected, 90);
+        double ns = r->frames ? (double)r->frame_ns / r->frames : 0.0;
+        double gated = r->frames ? 100.0 * r->gated / r->frames : 0.0;
+
+        printf("%-5s  %4d/%-4d %6.1f  %6.2f s %6.2f %6.2f  %12d  %8.1f  %9.0f  %7.1f\n",
+               modes[m].name, r->detected, r->alarms, miss,
+               percentile(r->latency_s, r->detected, 50), p90,
+               r->detected ? r->latency_s[r->detected - 1] : 0.0f,
+               r->false_alarms, perHour, ns, gated);
+        if (audit)
+            printf("       gate misses: %zu of %zu gated frames\n", r->gate_misses, r->gated);
+
+        score += miss + perHour + p90 + ns / 1000.0;
+    }
+    printf("score: %.2f\n", score);
+
+    if (maxScore >= 0.0 && score > maxScore)
+    {
+        printf("score above %.2f\n", maxScore);
+        return 1;
+    }
+    return 0;
+}
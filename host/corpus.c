@@ -0,0 +1,380 @@
+#include "corpus.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ONSET_S             10.0f   // Lead-in of noise only: longer than NOISE_FLOOR_WINDOW_S
+#define ALARM_TAIL_S        24.0f   // Six T3 groups after the onset
+#define OTHER_LENGTH_S      90.0f
+#define RAMP_S              0.005f  // Attack and release of tone pulses
+
+static const char *kindNames[CORPUS_KIND_COUNT] = {
+    [CORPUS_T3_ALARM] = "t3",
+    [CORPUS_CHIRP]    = "chirp",
+    [CORPUS_KETTLE]   = "kettle",
+    [CORPUS_SPEECH]   = "speech",
+    [CORPUS_NOISE]    = "noise",
+};
+
+// F1-F3 of a few vowels; /i/ puts F3 right in the alarm band
+static const float vowelFormants[][3] = {
+    { 730, 1090, 2440 },    // a
+    { 270, 2290, 3010 },    // i
+    { 300,  870, 2240 },    // u
+    { 530, 1840, 2480 },    // e
+    { 570,  840, 2410 },    // o
+};
+
+typedef struct {
+    uint32_t state;
+} rng_t;
+
+
+static float uniform(rng_t *r)
+{
+    // xorshift32
+    r->state ^= r->state << 13;
+    r->state ^= r->state >> 17;
+    r->state ^= r->state << 5;
+    return (r->state >> 8) * (1.0f / 16777216.0f);
+}
+
+static float between(rng_t *r, float lo, float hi)
+{
+    return lo + (hi - lo) * uniform(r);
+}
+
+static float gauss(rng_t *r)
+{
+    float u = uniform(r) + 1e-7f;
+    float v = uniform(r);
+    return sqrtf(-2.0f * logf(u)) * cosf(2.0f * (float)M_PI * v);
+}
+
+
+// Add a tone of amplitude `amp` on [start, end) with RAMP_S edges; `harmonic` is the 3rd's relative level
+static void addPulse(float *out, size_t n, uint32_t rate, float start_s, float end_s,
+                     float freq_hz, float amp, float harmonic)
+{
+    size_t first = (size_t)(start_s * rate);
+    size_t last = (size_t)(end_s * rate);
+    size_t ramp = (size_t)(RAMP_S * rate);
+    if (last > n)
+        last = n;
+
+    for (size_t i = first; i < last; i++)
+    {
+        float t = (float)(i - first) / rate;
+        float gain = 1.0f;
+        if (i - first < ramp)
+            gain = (float)(i - first) / ramp;
+        else if (last - i < ramp)
+            gain = (float)(last - i) / ramp;
+
+        float phase = 2.0f * (float)M_PI * freq_hz * t;
+        out[i] += amp * gain * (sinf(phase) + harmonic * sinf(3.0f * phase));
+    }
+}
+
+// 0.5 s on / 0.5 s off three times, then 1.5 s off; the sounder's timing wanders a little
+static void renderAlarm(const corpus_case_t *c, float *out, size_t n, uint32_t rate, rng_t *r)
+{
+    float t = c->onset_s;
+    while (t < c->length_s)
+    {
+        for (int pulse = 0; pulse < 3; pulse++)
+        {
+            float on = 0.5f + between(r, -0.02f, 0.02f);
+            float freq = c->freq_hz * (1.0f + between(r, -0.003f, 0.003f));
+            addPulse(out, n, rate, t, t + on, freq, 1.0f, 0.25f);
+            t += on + (pulse < 2 ? 0.5f : 1.5f) + between(r, -0.02f, 0.02f);
+        }
+    }
+}
+
+// Bursts of 3-8 chirps sweeping down from ~5 kHz to ~2 kHz, a burst every 2-6 s
+static void renderChirps(const corpus_case_t *c, float *out, size_t n, uint32_t rate, rng_t *r)
+{
+    for (float t = c->onset_s; t < c->length_s; t += between(r, 2.0f, 6.0f))
+    {
+        int chirps = 3 + (int)(uniform(r) * 6);
+        float at = t;
+        for (int k = 0; k < chirps; k++)
+        {
+            float length = between(r, 0.06f, 0.15f);
+            float f0 = between(r, 4000.0f, 5500.0f);
+            float f1 = between(r, 1800.0f, 2600.0f);
+            size_t first = (size_t)(at * rate);
+            size_t count = (size_t)(length * rate);
+            float phase = 0.0f;
+
+            for (size_t i = 0; i < count && first + i < n; i++)
+            {
+                float x = (float)i / count;
+                float freq = f0 * powf(f1 / f0, x);
+                phase += 2.0f * (float)M_PI * freq / rate;
+                out[first + i] += 0.5f * (1.0f - cosf(2.0f * (float)M_PI * x)) * sinf(phase);
+            }
+            at += length + between(r, 0.08f, 0.25f);
+        }
+    }
+}
+
+// Whistle that rises from 2.0 to 3.6 kHz as it heats up, with 5 Hz vibrato
+static void renderKettle(const corpus_case_t *c, float *out, size_t n, uint32_t rate, rng_t *r)
+{
+    size_t first = (size_t)(c->onset_s * rate);
+    float rise_s = 0.8f * (c->length_s - c->onset_s);
+    float wobble = between(r, 0.005f, 0.015f);
+    float phase = 0.0f;
+
+    for (size_t i = first; i < n; i++)
+    {
+        float t = (float)(i - first) / rate;
+        float sweep = t < rise_s ? t / rise_s : 1.0f;
+        float freq = (2000.0f + 1600.0f * sweep) * (1.0f + wobble * sinf(2.0f * (float)M_PI * 5.0f * t));
+        float gain = t < 2.0f ? t / 2.0f : 1.0f;
+
+        phase += 2.0f * (float)M_PI * freq / rate;
+        if (phase > 2.0f * (float)M_PI)
+            phase -= 2.0f * (float)M_PI;
+        out[i] += gain * (1.0f + 0.1f * gauss(r)) * sinf(phase);
+    }
+}
+
+// Two-pole resonator at `freq` with bandwidth `bw`, unity gain at the peak
+typedef struct {
+    float a1, a2, b0, y1, y2;
+} resonator_t;
+
+static void resonatorTune(resonator_t *f, float freq, float bw, uint32_t rate)
+{
+    float radius = expf(-(float)M_PI * bw / rate);
+    f->a1 = 2.0f * radius * cosf(2.0f * (float)M_PI * freq / rate);
+    f->a2 = -radius * radius;
+    f->b0 = 1.0f - radius;
+}
+
+static float resonatorRun(resonator_t *f, float x)
+{
+    float y = f->b0 * x + f->a1 * f->y1 + f->a2 * f->y2;
+    f->y2 = f->y1;
+    f->y1 = y;
+    return y;
+}
+
+// Phrases of 5-12 voiced syllables: a glottal pulse train with falling pitch
+// and spectral tilt through three formants, one vowel per syllable
+static void renderSpeech(const corpus_case_t *c, float *out, size_t n, uint32_t rate, rng_t *r)
+{
+    float pitch = between(r, 100.0f, 220.0f);
+    resonator_t formant[3] = {0};
+    float tilt1 = 0.0f, tilt2 = 0.0f;
+    float t = c->onset_s;
+
+    while (t < c->length_s)
+    {
+        int syllables = 5 + (int)(uniform(r) * 8);
+        for (int s = 0; s < syllables; s++)
+        {
+            const float *vowel = vowelFormants[(int)(uniform(r) * 5) % 5];
+            for (int k = 0; k < 3; k++)
+                resonatorTune(&formant[k], vowel[k] * between(r, 0.95f, 1.05f), 80.0f + 40.0f * k, rate);
+
+            float length = between(r, 0.15f, 0.3f);
+            size_t first = (size_t)(t * rate);
+            size_t count = (size_t)(length * rate);
+            float f0 = pitch * (1.0f - 0.15f * s / syllables);
+            float nextPulse = 0.0f;
+
+            for (size_t i = 0; i < count && first + i < n; i++)
+            {
+                float x = 0.0f;
+                if (i >= nextPulse)
+                {
+                    x = 1.0f;
+                    nextPulse += rate / (f0 * between(r, 0.98f, 1.02f));
+                }
+                tilt1 = 0.9f * tilt1 + x;
+                tilt2 = 0.7f * tilt2 + tilt1;
+
+                float y = tilt2;
+                for (int k = 0; k < 3; k++)
+                    y = resonatorRun(&formant[k], y) * (k == 0 ? 1.0f : 4.0f);
+                float env = sinf((float)M_PI * i / count);
+                out[first + i] += env * y;
+            }
+            t += length + between(r, 0.05f, 0.15f);
+        }
+        t += between(r, 0.5f, 1.5f);
+    }
+}
+
+static void renderNoise(corpus_noise_t colour, float *out, size_t n, rng_t *r)
+{
+    float b[7] = {0};
+
+    for (size_t i = 0; i < n; i++)
+    {
+        float w = gauss(r);
+        if (colour == CORPUS_WHITE)
+        {
+            out[i] = w;
+            continue;
+        }
+
+        // Paul Kellet's pink filter (-3 dB/octave within 0.05 dB above 10 Hz at 44.1-48 kHz)
+        b[0] = 0.99886f * b[0] + w * 0.0555179f;
+        b[1] = 0.99332f * b[1] + w * 0.0750759f;
+        b[2] = 0.96900f * b[2] + w * 0.1538520f;
+        b[3] = 0.86650f * b[3] + w * 0.3104856f;
+        b[4] = 0.55000f * b[4] + w * 0.5329522f;
+        b[5] = -0.7616f * b[5] - w * 0.0168980f;
+        out[i] = b[0] + b[1] + b[2] + b[3] + b[4] + b[5] + b[6] + w * 0.5362f;
+        b[6] = w * 0.115926f;
+    }
+}
+
+// Scale `x` so its RMS over the non-silent samples is `rms`
+static void scaleTo(float *x, size_t n, float rms)
+{
+    double sum = 0.0;
+    size_t active = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (x[i] != 0.0f)
+        {
+            sum += (double)x[i] * x[i];
+            active++;
+        }
+    }
+    if (active == 0 || sum == 0.0)
+        return;
+
+    float gain = rms / (float)sqrt(sum / active);
+    for (size_t i = 0; i < n; i++)
+        x[i] *= gain;
+}
+
+
+static int addCase(corpus_case_t *out, int count, int max, corpus_kind_t kind, corpus_noise_t noise,
+                   float freq_hz, float level_db, float snr_db)
+{
+    if (count >= max)
+        return count;
+
+    corpus_case_t *c = &out[count];
+    memset(c, 0, sizeof(*c));
+    c->kind = kind;
+    c->noise = noise;
+    c->freq_hz = freq_hz;
+    c->level_db = level_db;
+    c->snr_db = snr_db;
+    c->seed = 0x9E3779B9u * (uint32_t)(count + 1);
+
+    // Alarm onsets are spread over a cadence group and the hop grid
+    rng_t r = { c->seed };
+    c->onset_s = ONSET_S + (kind == CORPUS_T3_ALARM ? between(&r, 0.0f, 2.0f) : 0.0f);
+    c->length_s = kind == CORPUS_T3_ALARM ? c->onset_s + ALARM_TAIL_S : OTHER_LENGTH_S;
+
+    const char *colour = noise == CORPUS_PINK ? "pink" : "white";
+    if (kind == CORPUS_T3_ALARM)
+        snprintf(c->name, sizeof(c->name), "t3_%dhz_%s_%ddb_snr%d", (int)freq_hz, colour, (int)level_db, (int)snr_db);
+    else if (kind == CORPUS_NOISE)
+        snprintf(c->name, sizeof(c->name), "noise_%s_%ddb", colour, (int)level_db);
+    else
+        snprintf(c->name, sizeof(c->name), "%s_%s_%ddb_snr%d", kindNames[kind], colour, (int)level_db, (int)snr_db);
+    return count + 1;
+}
+
+int corpusCases(corpus_case_t *out, int max, bool quick)
+{
+    static const float alarmHz[] = { 2800, 2900, 3000, 3100, 3200, 3300 };
+    static const float alarmSnr[] = { 20, 10, 0, -10, -20 };
+    static const float levels[] = { -20, -40 };
+    static const float otherSnr[] = { 20, 0 };
+    static const float noiseLevels[] = { -30, -50, -70 };
+    int count = 0;
+
+    for (int noise = CORPUS_WHITE; noise <= CORPUS_PINK; noise++)
+    {
+        if (quick)
+        {
+            count = addCase(out, count, max, CORPUS_T3_ALARM, noise, 2800, -20, 20);
+            count = addCase(out, count, max, CORPUS_T3_ALARM, noise, 3100, -40, 0);
+            count = addCase(out, count, max, CORPUS_T3_ALARM, noise, 3300, -20, -10);
+            count = addCase(out, count, max, noise == CORPUS_WHITE ? CORPUS_CHIRP : CORPUS_SPEECH, noise, 0, -20, 0);
+            count = addCase(out, count, max, CORPUS_KETTLE, noise, 0, -40, 20);
+            count = addCase(out, count, max, CORPUS_NOISE, noise, 0, noise == CORPUS_WHITE ? -30 : -70, 0);
+            continue;
+        }
+
+        for (size_t f = 0; f < sizeof(alarmHz) / sizeof(alarmHz[0]); f++)
+            for (size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); l++)
+                for (size_t s = 0; s < sizeof(alarmSnr) / sizeof(alarmSnr[0]); s++)
+                    count = addCase(out, count, max, CORPUS_T3_ALARM, noise, alarmHz[f], levels[l], alarmSnr[s]);
+
+        for (int kind = CORPUS_CHIRP; kind <= CORPUS_SPEECH; kind++)
+            for (size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); l++)
+                for (size_t s = 0; s < sizeof(otherSnr) / sizeof(otherSnr[0]); s++)
+                    count = addCase(out, count, max, kind, noise, 0, levels[l], otherSnr[s]);
+
+        for (size_t l = 0; l < sizeof(noiseLevels) / sizeof(noiseLevels[0]); l++)
+            count = addCase(out, count, max, CORPUS_NOISE, noise, 0, noiseLevels[l], 0);
+    }
+    return count;
+}
+
+
+bool corpusRender(const corpus_case_t *c, uint32_t sample_rate, audio_clip_t *clip)
+{
+    memset(clip, 0, sizeof(*clip));
+    size_t n = (size_t)(c->length_s * sample_rate);
+    float *source = calloc(n, sizeof(float));
+    float *noise = calloc(n, sizeof(float));
+    clip->samples = malloc(n * sizeof(int32_t));
+    if (source == NULL || noise == NULL || clip->samples == NULL)
+    {
+        free(source);
+        free(noise);
+        audioFree(clip);
+        return false;
+    }
+
+    rng_t r = { c->seed };
+    switch (c->kind)
+    {
+        case CORPUS_T3_ALARM: renderAlarm(c, source, n, sample_rate, &r);  break;
+        case CORPUS_CHIRP:    renderChirps(c, source, n, sample_rate, &r); break;
+        case CORPUS_KETTLE:   renderKettle(c, source, n, sample_rate, &r); break;
+        case CORPUS_SPEECH:   renderSpeech(c, source, n, sample_rate, &r); break;
+        default:                                                           break;
+    }
+    renderNoise(c->noise, noise, n, &r);
+
+    // Levels are RMS relative to a full-scale sine (1/sqrt(2))
+    float sourceRms = powf(10.0f, c->level_db / 20.0f) * (float)M_SQRT1_2;
+    scaleTo(source, n, sourceRms);
+    scaleTo(noise, n, c->kind == CORPUS_NOISE ? sourceRms : sourceRms / powf(10.0f, c->snr_db / 20.0f));
+
+    for (size_t i = 0; i < n; i++)
+    {
+        double v = (double)(source[i] + noise[i]) * 2147483648.0;
+        if (v > 2147483647.0)  v = 2147483647.0;
+        if (v < -2147483648.0) v = -2147483648.0;
+        clip->samples[i] = (int32_t)v;
+    }
+    clip->count = n;
+    clip->sample_rate = sample_rate;
+
+    free(source);
+    free(noise);
+    return true;
+}
+
+
+const char *corpusKindName(corpus_kind_t kind)
+{
+    return (unsigned)kind < CORPUS_KIND_COUNT ? kindNames[kind] : "unknown";
+}
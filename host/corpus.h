@@ -0,0 +1,56 @@
+#pragma once
+
+/*
+ * Synthetic regression corpus for the detector: T3 smoke alarms across the
+ * 2.8-3.3 kHz range of real sounders, and the sounds most likely to be
+ * mistaken for one (bird-like chirps, a whistling kettle, voiced speech),
+ * each over white or pink background noise at a sweep of levels and SNRs.
+ * Clips are generated from a seed, so every run and every build sees the
+ * same samples.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "audio_file.h"
+
+typedef enum {
+    CORPUS_T3_ALARM,        // Temporal-three pulses: the only positive kind
+    CORPUS_CHIRP,           // Bursts of short downward sweeps through the band
+    CORPUS_KETTLE,          // Whistle rising slowly from 2.0 to 3.6 kHz, with vibrato
+    CORPUS_SPEECH,          // Voiced syllables: glottal pulses through moving formants
+    CORPUS_NOISE,           // Background only
+    CORPUS_KIND_COUNT
+} corpus_kind_t;
+
+typedef enum {
+    CORPUS_WHITE,
+    CORPUS_PINK,
+} corpus_noise_t;
+
+typedef struct {
+    corpus_kind_t kind;
+    corpus_noise_t noise;
+    float freq_hz;          // Alarm tone (CORPUS_T3_ALARM only)
+    float level_db;         // Source level, dB of a full-scale sine (noise level for CORPUS_NOISE)
+    float snr_db;           // Source RMS over background RMS, full bandwidth
+    float onset_s;          // Source starts here; noise only before
+    float length_s;         // Whole clip
+    uint32_t seed;
+    char name[56];
+} corpus_case_t;
+
+/**
+ * @brief List the corpus; `quick` keeps a small subset that still has every
+ *        kind, both noise colours and the extreme levels
+ *
+ * @return number of cases written to `out` (up to max)
+ */
+int corpusCases(corpus_case_t *out, int max, bool quick);
+
+/**
+ * @brief Generate one case at `sample_rate` as left-justified int32
+ *        (free with audioFree)
+ */
+bool corpusRender(const corpus_case_t *c, uint32_t sample_rate, audio_clip_t *clip);
+
+const char *corpusKindName(corpus_kind_t kind);
@@ -0,0 +1,261 @@
+#include "esp_dsp.h"
+#include <math.h>
+#include <stdlib.h>
+
+// Twiddle table: [cos, -sin] pairs of exp(-j*2*pi*k/table_size)
+static float *w_table = NULL;
+static int w_table_size = 0;
+
+static int isPowerOfTwo(int n)
+{
+    return n > 0 && (n & (n - 1)) == 0;
+}
+
+esp_err_t dsps_fft2r_init_fc32(float *fft_table_buff, int table_size)
+{
+    (void)fft_table_buff;
+
+    if (!isPowerOfTwo(table_size) || table_size > CONFIG_DSP_MAX_FFT_SIZE)
+        return ESP_ERR_DSP_INVALID_LENGTH;
+
+    if (w_table != NULL && w_table_size >= table_size)
+        return ESP_OK;
+
+    float *table = realloc(w_table, sizeof(float) * table_size);
+    if (table == NULL)
+        return ESP_ERR_DSP_UNINITIALIZED;
+
+    for (int k = 0; k < table_size / 2; k++)
+    {
+        double e = 2.0 * M_PI * k / table_size;
+        table[2*k + 0] = (float)cos(e);
+        table[2*k + 1] = (float)-sin(e);
+    }
+
+    w_table = table;
+    w_table_size = table_size;
+    return ESP_OK;
+}
+
+void dsps_fft2r_deinit_fc32(void)
+{
+    free(w_table);
+    w_table = NULL;
+    w_table_size = 0;
+}
+
+// Radix-2 decimation in frequency: natural order in, bit-reversed order out
+esp_err_t dsps_fft2r_fc32(float *data, int N)
+{
+    if (w_table == NULL)
+        return ESP_ERR_DSP_UNINITIALIZED;
+    if (!isPowerOfTwo(N) || N > w_table_size)
+        return ESP_ERR_DSP_INVALID_LENGTH;
+
+    for (int len = N; len >= 2; len >>= 1)
+    {
+        int half = len / 2;
+        int stride = w_table_size / len;
+
+        for (int start = 0; start < N; start += len)
+        {
+            for (int k = 0; k < half; k++)
+            {
+                float *a = &data[2 * (start + k)];
+                float *b = &data[2 * (start + k + half)];
+                float w_re = w_table[2 * k * stride + 0];
+                float w_im = w_table[2 * k * stride + 1];
+
+                float d_re = a[0] - b[0];
+                float d_im = a[1] - b[1];
+                a[0] += b[0];
+                a[1] += b[1];
+                b[0] = d_re * w_re - d_im * w_im;
+                b[1] = d_re * w_im + d_im * w_re;
+            }
+        }
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t dsps_bit_rev_fc32(float *data, int N)
+{
+    if (!isPowerOfTwo(N))
+        return ESP_ERR_DSP_INVALID_LENGTH;
+
+    for (int i = 1, j = 0; i < N; i++)
+    {
+        int bit = N >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+
+        if (i < j)
+        {
+            float re = data[2*i], im = data[2*i + 1];
+            data[2*i]     = data[2*j];
+            data[2*i + 1] = data[2*j + 1];
+            data[2*j]     = re;
+            data[2*j + 1] = im;
+        }
+    }
+
+    return ESP_OK;
+}
+
+
+// Q15 twiddle table: [cos, -sin] pairs of exp(-j*2*pi*k/table_size)
+static int16_t *w_table_sc16 = NULL;
+static int w_table_sc16_size = 0;
+
+static int16_t toQ15(double v)
+{
+    long q = lround(v * 32768.0);
+    return (int16_t)(q > 32767 ? 32767 : (q < -32768 ? -32768 : q));
+}
+
+esp_err_t dsps_fft2r_init_sc16(int16_t *fft_table_buff, int table_size)
+{
+    (void)fft_table_buff;
+
+    if (!isPowerOfTwo(table_size) || table_size > CONFIG_DSP_MAX_FFT_SIZE)
+        return ESP_ERR_DSP_INVALID_LENGTH;
+
+    if (w_table_sc16 != NULL && w_table_sc16_size >= table_size)
+        return ESP_OK;
+
+    int16_t *table = realloc(w_table_sc16, sizeof(int16_t) * table_size);
+    if (table == NULL)
+        return ESP_ERR_DSP_UNINITIALIZED;
+
+    for (int k = 0; k < table_size / 2; k++)
+    {
+        double e = 2.0 * M_PI * k / table_size;
+        table[2*k + 0] = toQ15(cos(e));
+        table[2*k + 1] = toQ15(-sin(e));
+    }
+
+    w_table_sc16 = table;
+    w_table_sc16_size = table_size;
+    return ESP_OK;
+}
+
+void dsps_fft2r_deinit_sc16(void)
+{
+    free(w_table_sc16);
+    w_table_sc16 = NULL;
+    w_table_sc16_size = 0;
+}
+
+// Radix-2 DIF with a rounding >> 1 per stage, as the target's scaled sc16 FFT
+esp_err_t dsps_fft2r_sc16(int16_t *data, int N)
+{
+    if (w_table_sc16 == NULL)
+        return ESP_ERR_DSP_UNINITIALIZED;
+    if (!isPowerOfTwo(N) || N > w_table_sc16_size)
+        return ESP_ERR_DSP_INVALID_LENGTH;
+
+    for (int len = N; len >= 2; len >>= 1)
+    {
+        int half = len / 2;
+        int stride = w_table_sc16_size / len;
+
+        for (int start = 0; start < N; start += len)
+        {
+            for (int k = 0; k < half; k++)
+            {
+                int16_t *a = &data[2 * (start + k)];
+                int16_t *b = &data[2 * (start + k + half)];
+                int32_t w_re = w_table_sc16[2 * k * stride + 0];
+                int32_t w_im = w_table_sc16[2 * k * stride + 1];
+
+                int32_t d_re = (int32_t)a[0] - b[0];
+                int32_t d_im = (int32_t)a[1] - b[1];
+                int32_t s_re = (int32_t)a[0] + b[0];
+                int32_t s_im = (int32_t)a[1] + b[1];
+
+                a[0] = (int16_t)((s_re + 1) >> 1);
+                a[1] = (int16_t)((s_im + 1) >> 1);
+                b[0] = (int16_t)((d_re * w_re - d_im * w_im + (1 << 15)) >> 16);
+                b[1] = (int16_t)((d_re * w_im + d_im * w_re + (1 << 15)) >> 16);
+            }
+        }
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t dsps_bit_rev_sc16(int16_t *data, int N)
+{
+    if (!isPowerOfTwo(N))
+        return ESP_ERR_DSP_INVALID_LENGTH;
+
+    uint32_t *pairs = (uint32_t *)data;     // One complex Q15 value per word
+    for (int i = 1, j = 0; i < N; i++)
+    {
+        int bit = N >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+
+        if (i < j)
+        {
+            uint32_t t = pairs[i];
+            pairs[i] = pairs[j];
+            pairs[j] = t;
+        }
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t dsps_mul_s16(const int16_t *input1, const int16_t *input2, int16_t *output,
+                       int len, int step1, int step2, int step_out, int shift)
+{
+    for (int i = 0; i < len; i++)
+    {
+        int32_t acc = (int32_t)input1[i * step1] * input2[i * step2];
+        output[i * step_out] = (int16_t)(acc >> shift);
+    }
+    return ESP_OK;
+}
+
+esp_err_t dsps_dotprod_f32(const float *src1, const float *src2, float *dest, int len)
+{
+    float acc = 0.0f;
+    for (int i = 0; i < len; i++)
+        acc += src1[i] * src2[i];
+    *dest = acc;
+    return ESP_OK;
+}
+
+esp_err_t dsps_biquad_f32(const float *input, float *output, int len, float *coef, float *w)
+{
+    for (int i = 0; i < len; i++)
+    {
+        float d0 = input[i] - coef[3] * w[0] - coef[4] * w[1];
+        output[i] = coef[0] * d0 + coef[1] * w[0] + coef[2] * w[1];
+        w[1] = w[0];
+        w[0] = d0;
+    }
+    return ESP_OK;
+}
+
+esp_err_t dsps_biquad_gen_bpf0db_f32(float *coeffs, float f, float qFactor)
+{
+    if (qFactor <= 0.0001f)
+        qFactor = 0.0001f;
+
+    float w0 = 2.0f * (float)M_PI * f;
+    float c = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * qFactor);
+    float a0 = 1.0f + alpha;
+
+    coeffs[0] = alpha / a0;
+    coeffs[1] = 0.0f;
+    coeffs[2] = -alpha / a0;
+    coeffs[3] = -2.0f * c / a0;
+    coeffs[4] = (1.0f - alpha) / a0;
+    return ESP_OK;
+}
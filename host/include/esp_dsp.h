@@ -0,0 +1,42 @@
+#pragma once
+
+/*
+ * Host stand-in for the subset of esp-dsp used by the DSP core.
+ * Same in-place interleaved layout and bit-reversed output order as
+ * dsps_fft2r_fc32 on the target, so the core code is unchanged.
+ */
+
+#include <stdint.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK                          0
+#define ESP_ERR_DSP_BASE                0x70000
+#define ESP_ERR_DSP_INVALID_LENGTH      (ESP_ERR_DSP_BASE + 1)
+#define ESP_ERR_DSP_UNINITIALIZED       (ESP_ERR_DSP_BASE + 4)
+
+#define CONFIG_DSP_MAX_FFT_SIZE         4096
+
+esp_err_t dsps_fft2r_init_fc32(float *fft_table_buff, int table_size);
+void      dsps_fft2r_deinit_fc32(void);
+esp_err_t dsps_fft2r_fc32(float *data, int N);
+esp_err_t dsps_bit_rev_fc32(float *data, int N);
+
+// Q15 complex FFT; every stage scales by 1/2, so the output is DFT / N
+esp_err_t dsps_fft2r_init_sc16(int16_t *fft_table_buff, int table_size);
+void      dsps_fft2r_deinit_sc16(void);
+esp_err_t dsps_fft2r_sc16(int16_t *data, int N);
+esp_err_t dsps_bit_rev_sc16(int16_t *data, int N);
+
+// output[i] = (input1[i] * input2[i]) >> shift
+esp_err_t dsps_mul_s16(const int16_t *input1, const int16_t *input2, int16_t *output,
+                       int len, int step1, int step2, int step_out, int shift);
+
+// *dest = sum(src1[i] * src2[i])
+esp_err_t dsps_dotprod_f32(const float *src1, const float *src2, float *dest, int len);
+
+// Biquad, coef = { b0, b1, b2, a1, a2 } (a0 = 1), w = 2-float delay line (direct form II)
+esp_err_t dsps_biquad_f32(const float *input, float *output, int len, float *coef, float *w);
+
+// Band-pass with 0 dB peak gain; f is the centre over the sample rate (0..0.5)
+esp_err_t dsps_biquad_gen_bpf0db_f32(float *coeffs, float f, float qFactor);
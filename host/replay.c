@@ -0,0 +1,234 @@
+/*
+ * Streams a WAV or raw int32 capture through the DSP core frame by frame,
+ * exactly as vFFTProcessorTask and vDetectTask would (energy gate, gate
+ * audits, detection and cadence), and reports throughput, per-stage cost,
+ * gated and audited frames, and detection and cadence timestamps.
+ *
+ *   replay [--raw] [--rate HZ] [--channel N] [--window NAME] [--repeat N] [--audit] [--quiet] <file>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "audio_file.h"
+#include "dsp_core.h"
+#include "dsp_window.h"
+
+enum { STAGE_DECIMATE, STAGE_SPECTRUM, STAGE_ANALYZE, STAGE_COUNT };
+
+static const char *stage_names[STAGE_COUNT] = { "decimate", "gate+window+spectrum", "analyze" };
+
+static dsp_spectrum_t spectrum;
+
+static int64_t nowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "Usage: %s [options] <capture.wav|capture.raw>\n"
+        "  --raw          input is raw little-endian int32 mono\n"
+        "  --rate HZ      sample rate of raw input (default %d)\n"
+        "  --channel N    WAV channel to analyze (default 0)\n"
+        "  --window NAME  hamming, hann, blackman-harris or flat-top (default %s)\n"
+        "  --repeat N     replay the clip N times for timing (default 1)\n"
+        "  --audit        transform every gated frame and count gate misses (default every %d)\n"
+        "  --quiet        do not list individual detections\n",
+        prog, (int)I2S_SAMPLE_RATE_HZ, windowName(WINDOW_TYPE), GATE_AUDIT_EVERY);
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = NULL;
+    bool raw = false, quiet = false, audit = false;
+    int channel = 0, repeat = 1;
+    window_type_t window = WINDOW_TYPE;
+    uint32_t raw_rate = (uint32_t)I2S_SAMPLE_RATE_HZ;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--raw") == 0)
+            raw = true;
+        else if (strcmp(argv[i], "--quiet") == 0)
+            quiet = true;
+        else if (strcmp(argv[i], "--audit") == 0)
+            audit = true;
+        else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc)
+            raw_rate = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--channel") == 0 && i + 1 < argc)
+            channel = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc)
+        {
+            const char *name = argv[++i];
+            for (window = 0; window < WINDOW_COUNT; window++)
+                if (strcmp(name, windowName(window)) == 0)
+                    break;
+            if (window == WINDOW_COUNT)
+            {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+            repeat = atoi(argv[++i]);
+        else if (argv[i][0] == '-' || path != NULL)
+        {
+            usage(argv[0]);
+            return 2;
+        }
+        else
+            path = argv[i];
+    }
+
+    if (path == NULL || repeat < 1)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    audio_clip_t clip;
+    bool loaded = raw ? audioLoadRaw(path, raw_rate, &clip) : audioLoadWav(path, channel, &clip);
+    if (!loaded)
+        return 1;
+
+    if (clip.sample_rate != (uint32_t)I2S_SAMPLE_RATE_HZ)
+    {
+        fprintf(stderr, "warning: clip is %u Hz, detector is built for %d Hz; bin frequencies will be off\n",
+                (unsigned)clip.sample_rate, (int)I2S_SAMPLE_RATE_HZ);
+    }
+
+    // The window goes in through the detector config, as POST /config sets it
+    detector_config_t cfg;
+    detectorConfigDefaults(&cfg);
+    cfg.window = window;
+    if (!dspCoreInit() || dspCoreConfigure(&cfg) != DSP_CONFIG_OK)
+    {
+        fprintf(stderr, "Failed to initialize FFT\n");
+        audioFree(&clip);
+        return 1;
+    }
+    if (audit)
+        dspGateSetAudit(1);
+
+    size_t blocks = clip.count / SAMPLE_BUFFER_SIZE;
+    double hop_ms = 1000.0 * HOP_SIZE / SAMPLE_RATE;
+    int64_t stage_ns[STAGE_COUNT] = {0};
+    size_t analyses = 0, gated = 0, audited = 0, gate_misses = 0;
+    int detections = 0;
+    int patterns = 0;
+
+    printf("%s: %zu samples @ %u Hz, %zu blocks of %d, frame %d / hop %d at %d Hz (%d%% overlap)\n",
+           path, clip.count, (unsigned)clip.sample_rate, blocks, SAMPLE_BUFFER_SIZE,
+           FFT_SIZE, HOP_SIZE, (int)SAMPLE_RATE, FRAME_OVERLAP_PCT);
+    char threshold[48];
+    if (USE_NOISE_FLOOR)
+        snprintf(threshold, sizeof(threshold), "%.1f dB over noise floor", NOISE_FLOOR_SNR_DB);
+    else
+        snprintf(threshold, sizeof(threshold), "threshold %.1f dB", THRESHOLD_DB);
+
+    printf("band %d-%d Hz (bins %d-%d), %s, %s window, %s, %s\n",
+           Freq_START_HZ, Freq_END_HZ, BIN_START, BIN_END, threshold,
+           USE_LONG_WINDOW ? "long" : "short", windowName(window),
+           USE_FIXED_POINT ? "q15 real fft" : (USE_ZOOM_FFT ? "zoom fft" :
+           (USE_GOERTZEL ? "goertzel" : (USE_REAL_FFT ? "real fft" : "complex fft"))));
+
+    int64_t wall_start = nowNs();
+
+    for (int pass = 0; pass < repeat; pass++)
+    {
+        dspCoreReset();
+
+        // Feed capture-sized blocks, as vFFTProcessorTask receives them
+        for (size_t b = 0; b < blocks; b++)
+        {
+            const int32_t *block = clip.samples + b * SAMPLE_BUFFER_SIZE;
+            size_t position = b * SAMPLE_BUFFER_SIZE;
+            int left = SAMPLE_BUFFER_SIZE;
+
+            while (left > 0)
+            {
+                int64_t tp = nowNs();
+                int used = dspStreamPush(block, left);
+                stage_ns[STAGE_DECIMATE] += nowNs() - tp;
+                block += used;
+                left -= used;
+                position += used;
+
+                if (dspStreamFrame() == NULL)
+                    continue;
+
+                dsp_detection_t result;
+                int64_t t0 = nowNs();
+                dspComputeStreamSpectrum(&spectrum);
+                dspStreamAdvance();
+                int64_t t1 = nowNs();
+                dspAnalyzeSpectrum(&spectrum, &result);
+                int64_t t2 = nowNs();
+
+                stage_ns[STAGE_SPECTRUM] += t1 - t0;
+                stage_ns[STAGE_ANALYZE]  += t2 - t1;
+                analyses++;
+                if (pass != 0)
+                    continue;
+
+                gated += spectrum.gate != DSP_GATE_OPEN;
+                audited += spectrum.gate == DSP_GATE_AUDIT;
+                gate_misses += spectrum.gate == DSP_GATE_AUDIT && result.tone_on;
+
+                if (result.pattern != CADENCE_NONE)
+                {
+                    patterns++;
+                    if (!quiet)
+                        printf("  [%10.1f ms] %s cadence\n", 1000.0 * position / clip.sample_rate, cadenceName(result.pattern));
+                }
+
+                if (result.detected)
+                {
+                    detections++;
+                    if (!quiet)
+                    {
+                        // Timestamp at the last sample of the frame that confirmed detection
+                        printf("  [%10.1f ms] detection at %d Hz (%.1f dB)\n",
+                               1000.0 * position / clip.sample_rate, result.freq_hz, result.peak_db);
+                    }
+                }
+            }
+        }
+    }
+
+    int64_t wall_ns = nowNs() - wall_start;
+    size_t total_frames = analyses;
+
+    printf("detections: %d  cadence matches: %d\n", detections, patterns);
+    printf("gated: %zu of %zu frames  audited: %zu  gate misses: %zu\n",
+           gated, analyses / repeat, audited, gate_misses);
+    if (total_frames == 0)
+    {
+        printf("clip shorter than one frame, nothing to time\n");
+        audioFree(&clip);
+        return 0;
+    }
+
+    double wall_s = wall_ns / 1e9;
+    double fps = total_frames / wall_s;
+    double audio_s = (double)blocks * SAMPLE_BUFFER_SIZE * repeat / clip.sample_rate;
+    printf("frames: %zu  wall: %.3f s  frames/sec: %.1f  realtime: %.1fx  (hop budget %.2f ms)\n",
+           total_frames, wall_s, fps, audio_s / wall_s, hop_ms);
+
+    int64_t total_ns = 0;
+    printf("ns/frame:");
+    for (int s = 0; s < STAGE_COUNT; s++)
+    {
+        printf("  %s %lld", stage_names[s], (long long)(stage_ns[s] / (int64_t)total_frames));
+        total_ns += stage_ns[s];
+    }
+    printf("  total %lld\n", (long long)(total_ns / (int64_t)total_frames));
+
+    audioFree(&clip);
+    return 0;
+}
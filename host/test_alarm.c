@@ -0,0 +1,85 @@
+/*
+ * Alarm lifecycle: a continuous alarm is coalesced into start, periodic
+ * status and clear; pulsed alarms survive their pauses; statistics follow
+ * the loudest frame; a cadence recognized later is reported at once.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "dsp_alarm.h"
+#include "test_check.h"
+
+#define FRAME_MS    20      // Close to the real hop
+
+static int counts[ALARM_CLEAR + 1];
+static alarm_report_t last;
+
+// Feed `ms` of frames from *now: tone_on every frame when `tone`, a
+// confirmation every `confirm_every` frames (0 = never)
+static void run(int64_t *now, int ms, bool tone, int confirm_every, float peak_db, int freq_hz)
+{
+    for (int f = 0; f < ms / FRAME_MS; f++, *now += FRAME_MS)
+    {
+        dsp_detection_t d = {
+            .detected = confirm_every > 0 && f % confirm_every == confirm_every - 1,
+            .tone_on = tone,
+            .freq_hz = tone ? freq_hz : 0,
+            .peak_db = tone ? peak_db : -90.0f,
+            .pattern = CADENCE_NONE,
+        };
+        alarm_report_t r;
+        if (alarmUpdate(&d, *now, &r))
+        {
+            counts[r.phase]++;
+            last = r;
+        }
+    }
+}
+
+int main(void)
+{
+    int64_t now = 0;
+    alarm_report_t r;
+
+    // Continuous tone confirmed every 5 frames for 95 s: ~950 confirmations
+    alarmReset();
+    run(&now, 2000, false, 0, 0, 0);
+    CHECK(counts[ALARM_START] == 0, "silence raises nothing");
+    run(&now, 95000, true, 5, -30.0f, 3000);
+    CHECK(counts[ALARM_START] == 1 && last.confirmations > 900, "one start for the whole alarm");
+    CHECK(counts[ALARM_ONGOING] == 3, "status every ALARM_ONGOING_INTERVAL_S");
+    run(&now, (ALARM_CLEAR_HOLD_S - 1) * 1000, false, 0, 0, 0);
+    CHECK(counts[ALARM_CLEAR] == 0, "no clear within the hold time");
+    run(&now, 2000, false, 0, 0, 0);
+    CHECK(counts[ALARM_CLEAR] == 1 && last.phase == ALARM_CLEAR, "clear after the hold time");
+    CHECK(last.duration_ms >= 94000 && last.duration_ms <= 95000 && last.start_ms == 2000 + 4 * FRAME_MS,
+          "clear reports start and duration up to the last confirmation");
+
+    // Pulsed: 0.5 s on with a confirmation, 5 s pause (a T4 gap), for a minute
+    memset(counts, 0, sizeof(counts));
+    for (int i = 0; i < 11; i++)
+    {
+        run(&now, 500, true, 10, -35.0f, 3100);
+        run(&now, 5000, false, 0, 0, 0);
+    }
+    CHECK(counts[ALARM_START] == 1 && counts[ALARM_CLEAR] == 0, "pauses shorter than the hold keep one alarm");
+
+    // Loudest tone frame sets peak and dominant frequency, confirmed or not
+    run(&now, 200, true, 0, -12.0f, 3150);
+    run(&now, 500, true, 10, -35.0f, 3100);
+    run(&now, 12000, false, 0, 0, 0);
+    CHECK(counts[ALARM_CLEAR] == 1 && last.peak_db == -12.0f && last.freq_hz == 3150,
+          "peak and dominant frequency follow the loudest frame");
+
+    // A cadence recognized after the start is reported without waiting
+    dsp_detection_t d = { .detected = true, .tone_on = true, .freq_hz = 3000, .peak_db = -30.0f };
+    CHECK(alarmUpdate(&d, now, &r) && r.phase == ALARM_START && r.pattern == CADENCE_NONE, "new alarm starts");
+    d.detected = false;
+    d.tone_on = false;
+    d.pattern = CADENCE_T3;
+    CHECK(alarmUpdate(&d, now + FRAME_MS, &r) && r.phase == ALARM_ONGOING && r.pattern == CADENCE_T3,
+          "cadence reported as soon as it is recognized");
+    CHECK(!alarmUpdate(&d, now + 2 * FRAME_MS, &r), "same cadence again is not an event");
+
+    return failures ? 1 : 0;
+}
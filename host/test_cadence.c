@@ -0,0 +1,122 @@
+/*
+ * Cadence recognizer: T3 and T4 patterns through the full pipeline must be
+ * reported as such; a steady tone (kettle) and a wrong rhythm must not.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include "dsp_core.h"
+#include "test_check.h"
+
+#define SECONDS_T3      12
+#define SECONDS_T4      16
+#define LEAD_IN_MS      200     // Silence before the first pulse, so the noise floor starts below it
+
+// Input samples by which the decimator's FIR delays the analysis; the gates
+// are shifted by it so T4's 100 ms gaps keep the same alignment to the hops
+#if DECIMATION_FACTOR > 1
+    #define GROUP_DELAY ((DECIMATION_TAPS - 1) / 2)
+#else
+    #define GROUP_DELAY 0
+#endif
+
+// Below the absolute minimum level of either threshold mode
+#if USE_NOISE_FLOOR
+    #define QUIET_DB    (NOISE_FLOOR_MIN_DB - 10.0f)
+#else
+    #define QUIET_DB    (THRESHOLD_DB - 20.0f)
+#endif
+
+static int32_t block[SAMPLE_BUFFER_SIZE];
+
+// Cadence as a list of (on ms, off ms) steps repeated for the whole clip
+typedef struct {
+    int on_ms;
+    int off_ms;
+} step_t;
+
+// Feed a 3 kHz tone gated by `steps`; returns the first pattern reported and its time
+static cadence_pattern_t runCadence(const step_t *steps, int count, float amplitude, int seconds, float *at_ms)
+{
+    int cycle_ms = 0;
+    for (int s = 0; s < count; s++)
+        cycle_ms += steps[s].on_ms + steps[s].off_ms;
+
+    dspCoreReset();
+    long long n = 0;
+
+    for (int b = 0; b < seconds * I2S_SAMPLE_RATE_HZ / SAMPLE_BUFFER_SIZE; b++)
+    {
+        for (int i = 0; i < SAMPLE_BUFFER_SIZE; i++, n++)
+        {
+            long long ms = (n + GROUP_DELAY) * 1000 / (long long)I2S_SAMPLE_RATE_HZ - LEAD_IN_MS;
+            int t_ms = ms < 0 ? -1 : (int)(ms % cycle_ms);
+            bool on = false;
+            for (int s = 0, start = 0; s < count; s++)
+            {
+                if (t_ms >= start && t_ms < start + steps[s].on_ms)
+                    on = true;
+                start += steps[s].on_ms + steps[s].off_ms;
+            }
+            block[i] = on ? (int32_t)(amplitude * 2147483647.0 * sin(2.0 * M_PI * 3000.0 * n / I2S_SAMPLE_RATE_HZ)) : 0;
+        }
+
+        dsp_detection_t result;
+        if (dspProcessBlock(block, SAMPLE_BUFFER_SIZE, &result) && result.pattern != CADENCE_NONE)
+        {
+            *at_ms = 1000.0f * n / I2S_SAMPLE_RATE_HZ;
+            return result.pattern;
+        }
+    }
+    return CADENCE_NONE;
+}
+
+int main(void)
+{
+    CHECK(dspCoreInit(), "core init");
+
+    static const step_t t3[] = { { 500, 500 }, { 500, 500 }, { 500, 1500 } };
+    static const step_t t4[] = { { 100, 100 }, { 100, 100 }, { 100, 100 }, { 100, 5000 } };
+    static const step_t steady[] = { { 1000, 0 } };
+    static const step_t pulses_1s[] = { { 1000, 1000 } };
+    static const step_t t3_short[] = { { 500, 500 }, { 500, 1500 } };
+
+    float at = 0.0f;
+    cadence_pattern_t p = runCadence(t3, 3, 0.1f, SECONDS_T3, &at);
+    printf("  T3 -> %s at %.0f ms\n", cadenceName(p), at);
+    CHECK(p == CADENCE_T3, "T3 cadence is recognized");
+
+    p = runCadence(t3, 3, powf(10.0f, QUIET_DB / 20.0f), SECONDS_T3, &at);
+    printf("  T3 at %.0f dBFS -> %s\n", QUIET_DB, cadenceName(p));
+    CHECK(p == CADENCE_NONE, "T3 below threshold is not reported");
+
+    p = runCadence(t4, 4, 0.1f, SECONDS_T4, &at);
+    printf("  T4 -> %s at %.0f ms\n", cadenceName(p), at);
+    CHECK(p == CADENCE_T4, "T4 cadence is recognized");
+
+    p = runCadence(steady, 1, 0.1f, SECONDS_T3, &at);
+    CHECK(p == CADENCE_NONE, "steady tone has no cadence");
+
+    p = runCadence(pulses_1s, 1, 0.1f, SECONDS_T3, &at);
+    CHECK(p == CADENCE_NONE, "1 s on/off is not T3");
+
+    p = runCadence(t3_short, 2, 0.1f, SECONDS_T3, &at);
+    CHECK(p == CADENCE_NONE, "two-pulse groups are not T3");
+
+    // Recognizer on its own, one decision per hop
+    cadenceReset();
+    int hop_ms = (int)(1000 * HOP_SIZE / SAMPLE_RATE);
+    cadence_pattern_t last = CADENCE_NONE;
+    for (int cycle = 0; cycle < 3; cycle++)
+        for (int s = 0; s < 3; s++)
+        {
+            for (int t = 0; t < t3[s].on_ms; t += hop_ms)
+                cadenceUpdate(true);
+            for (int t = 0; t < t3[s].off_ms; t += hop_ms)
+                if (cadenceUpdate(false) != CADENCE_NONE)
+                    last = CADENCE_T3;
+        }
+    CHECK(last == CADENCE_T3, "ideal on/off sequence matches T3");
+
+    return failures ? 1 : 0;
+}
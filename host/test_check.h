@@ -0,0 +1,13 @@
+#pragma once
+
+/*
+ * Pass/fail reporting shared by the host tests: CHECK prints every check
+ * and counts the failures; main returns `failures ? 1 : 0`.
+ */
+
+#include <stdio.h>
+
+static int failures = 0;
+
+#define CHECK(cond, msg) \
+    do { if (!(cond)) { printf("FAIL: %s\n", msg); failures++; } else { printf("ok:   %s\n", msg); } } while (0)
@@ -0,0 +1,145 @@
+/*
+ * Anti-alias decimator: flat over the detection band, aliases of the band
+ * rejected, unity DC gain, and identical output whatever the block sizes
+ * and output limits the stream feeds it with. Band-shifting mode: the
+ * span around the centre comes out flat, mixed to the middle of the
+ * complex output.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "dsp_core.h"
+#include "dsp_decimator.h"
+#include "test_check.h"
+
+#define FACTOR      4
+#define TAPS        64
+#define RATE        48000.0f
+#define INPUTS      (FACTOR * 4000)
+
+static int32_t input[INPUTS];
+static int32_t whole[INPUTS / FACTOR];
+static int32_t pieces[INPUTS / FACTOR];
+
+static void makeTone(float freq_hz, double amplitude)
+{
+    for (int i = 0; i < INPUTS; i++)
+        input[i] = (int32_t)(amplitude * 2147483647.0 * sin(2.0 * M_PI * freq_hz * i / RATE));
+}
+
+// RMS in dBFS (full-scale sine = 0 dB) of the settled output
+static double levelDb(const int32_t *x, int count)
+{
+    double sum = 0.0;
+    for (int i = TAPS; i < count; i++)
+        sum += (double)x[i] * x[i];
+    return 10.0 * log10(2.0 * sum / (count - TAPS) / (2147483648.0 * 2147483648.0) + 1e-30);
+}
+
+int main(void)
+{
+    CHECK(!decimatorInit(FACTOR, 62, 6000.0f, RATE, WINDOW_BLACKMAN_HARRIS), "taps not a multiple of 4 rejected");
+    CHECK(!decimatorInit(FACTOR, TAPS, 30000.0f, RATE, WINDOW_BLACKMAN_HARRIS), "cutoff above Nyquist rejected");
+    CHECK(decimatorInit(FACTOR, TAPS, 6000.0f, RATE, WINDOW_BLACKMAN_HARRIS), "init");
+
+    // Designed response: flat band, band aliases (12 kHz +- band) deep in the stop band
+    float worstPass = 0.0f, worstStop = -200.0f;
+    for (float f = 2750.0f; f <= 3250.0f; f += 50.0f)
+    {
+        float pass = 20.0f * log10f(decimatorResponse(f));
+        float alias = 20.0f * log10f(decimatorResponse(RATE / FACTOR - f) + 1e-12f);
+        worstPass = fmaxf(worstPass, fabsf(pass));
+        worstStop = fmaxf(worstStop, alias);
+    }
+    printf("      band ripple %.3f dB, worst alias %.1f dB\n", worstPass, worstStop);
+    CHECK(worstPass < 0.1f, "flat over the detection band");
+    CHECK(worstStop < -80.0f, "aliases of the band rejected by 80 dB");
+    CHECK(fabsf(decimatorResponse(0.0f) - 1.0f) < 1e-4f, "unity gain at DC");
+
+    // Tone in the band passes at its level
+    int produced;
+    makeTone(3000.0f, 0.1);
+    decimatorReset();
+    int used = decimatorPush(input, INPUTS, whole, INPUTS / FACTOR, &produced);
+    double inBand = levelDb(whole, produced);
+    CHECK(used == INPUTS && produced == INPUTS / FACTOR, "every input consumed, one output per factor");
+    CHECK(fabs(inBand + 20.0) < 0.1, "3 kHz tone keeps its level");
+
+    // 9 kHz would fold onto 3 kHz at 12 kHz
+    makeTone(9000.0f, 0.1);
+    decimatorReset();
+    decimatorPush(input, INPUTS, whole, INPUTS / FACTOR, &produced);
+    printf("      9 kHz tone after decimation: %.1f dB\n", levelDb(whole, produced));
+    CHECK(levelDb(whole, produced) < -100.0, "9 kHz does not alias into the band");
+
+    // Odd block sizes and small output limits give the same stream
+    makeTone(3100.0f, 0.5);
+    decimatorReset();
+    decimatorPush(input, INPUTS, whole, INPUTS / FACTOR, &produced);
+    decimatorReset();
+    int in = 0, out = 0;
+    bool limited = true;
+    for (int step = 0; in < INPUTS; step++)
+    {
+        int block = 1 + (step * 37) % 333;
+        int room = 1 + step % 7;
+        if (block > INPUTS - in)
+            block = INPUTS - in;
+        if (room > INPUTS / FACTOR - out)
+            room = INPUTS / FACTOR - out;
+        int n;
+        in += decimatorPush(&input[in], block, &pieces[out], room, &n);
+        limited &= n <= room;
+        out += n;
+    }
+    CHECK(limited && out == INPUTS / FACTOR && memcmp(whole, pieces, sizeof(whole)) == 0,
+          "block sizes and output limits do not change the output");
+
+    // Full-scale square wave: the filter's overshoot saturates instead of
+    // wrapping, so the output changes sign once per edge and no more
+    for (int i = 0; i < INPUTS; i++)
+        input[i] = (i / 200) % 2 ? INT32_MAX : INT32_MIN;
+    decimatorReset();
+    decimatorPush(input, INPUTS, whole, INPUTS / FACTOR, &produced);
+    int crossings = 0;
+    for (int i = TAPS; i < produced; i++)
+        crossings += (whole[i] >= 0) != (whole[i - 1] >= 0);
+    CHECK(crossings == (INPUTS - TAPS * FACTOR) / 200, "overshoot saturates");
+
+    // Band-shifting (zoom) mode: 3 kHz +- 350 Hz flat, mirror and span aliases rejected
+    CHECK(!decimatorInitComplex(32, 384, 700.0f, RATE, WINDOW_BLACKMAN_HARRIS, 30000.0f), "centre above Nyquist rejected");
+    CHECK(decimatorInitComplex(32, 384, 700.0f, RATE, WINDOW_BLACKMAN_HARRIS, 3000.0f), "complex init");
+    worstPass = 0.0f;
+    worstStop = -200.0f;
+    for (float f = -350.0f; f <= 350.0f; f += 50.0f)
+    {
+        worstPass = fmaxf(worstPass, fabsf(20.0f * log10f(decimatorResponse(3000.0f + f))));
+        worstStop = fmaxf(worstStop, 20.0f * log10f(decimatorResponse(3000.0f + 1500.0f + f) + 1e-12f));
+        worstStop = fmaxf(worstStop, 20.0f * log10f(decimatorResponse(3000.0f - 1500.0f + f) + 1e-12f));
+        worstStop = fmaxf(worstStop, 20.0f * log10f(decimatorResponse(-3000.0f + f) + 1e-12f));
+    }
+    printf("      zoom span ripple %.3f dB, worst alias or mirror %.1f dB\n", worstPass, worstStop);
+    CHECK(worstPass < 0.05f, "flat over the zoom span");
+    CHECK(worstStop < -80.0f, "zoom aliases and the mirror image rejected by 80 dB");
+
+    // 3.1 kHz comes out as a complex tone at 100 Hz above the middle of the 1500 Hz output
+    makeTone(3100.0f, 0.1);
+    decimatorReset();
+    static int32_t iq[2 * (INPUTS / 32)];
+    decimatorPush(input, INPUTS, iq, INPUTS / 32, &produced);
+    double rotation = 0.0, power = 0.0;
+    for (int m = 16; m < produced - 1; m++)
+    {
+        double a = atan2(iq[2*m + 3], iq[2*m + 2]) - atan2(iq[2*m + 1], iq[2*m]);
+        rotation += a - 2.0 * M_PI * floor(a / (2.0 * M_PI));
+        power += ((double)iq[2*m] * iq[2*m] + (double)iq[2*m + 1] * iq[2*m + 1]) / (2147483648.0 * 2147483648.0);
+    }
+    double outHz = rotation / (produced - 17) / (2.0 * M_PI) * 1500.0;
+    double outDb = 10.0 * log10(power / (produced - 17));
+    printf("      3100 Hz in: %.1f Hz of 1500, %.2f dB\n", outHz, outDb);
+    CHECK(produced == INPUTS / 32 && fabs(outHz - 850.0) < 0.5, "zoom output is the band mixed to the middle");
+    CHECK(fabs(outDb + 26.02) < 0.05, "zoom output keeps half the amplitude (one side of the spectrum)");
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * Runtime detector configuration: validation and text parsing, the
+ * two-stage table swap, a band retune taking effect mid-stream, and
+ * per-bin state surviving a threshold-only change but not a band change.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "dsp_core.h"
+#include "dsp_config.h"
+#include "test_check.h"
+#include "test_stream.h"
+
+// Threshold and SNR alternate every block; the band stays
+static void retuneLevels(int b)
+{
+    detector_config_t cfg;
+    detectorConfigDefaults(&cfg);
+    cfg.threshold_db += (b % 2) ? 1.0f : 0.0f;
+    cfg.snr_db += (b % 2) ? 1.0f : 0.0f;
+    dspCoreConfigure(&cfg);
+}
+
+// The band start alternates every block; 3 kHz stays inside it
+static void retuneBand(int b)
+{
+    detector_config_t cfg;
+    detectorConfigDefaults(&cfg);
+    cfg.freq_start_hz -= (b % 2) ? 50 : 0;
+    dspCoreConfigure(&cfg);
+}
+
+// Moves the band from 3 kHz to 1 kHz during the lead-in; a new band
+// restarts its noise floor, so the tone must start after the change
+static void retuneMidStream(int b)
+{
+    detector_config_t cfg;
+    detectorConfigDefaults(&cfg);
+    if (b == LEAD_IN_SAMPLES / SAMPLE_BUFFER_SIZE / 2)
+    {
+        cfg.freq_start_hz = 900;
+        cfg.freq_end_hz = 1100;
+        CHECK(dspCoreConfigure(&cfg) == DSP_CONFIG_OK, "band retune accepted mid-stream");
+    }
+}
+
+int main(void)
+{
+    detector_config_t cfg, got;
+    char json[256];
+
+    // Validation
+    detectorConfigDefaults(&cfg);
+    CHECK(detectorConfigValid(&cfg), "config.h defaults are valid");
+    cfg.freq_end_hz = (int)(SAMPLE_RATE / 2);
+    CHECK(!detectorConfigValid(&cfg), "band reaching Nyquist is rejected");
+    detectorConfigDefaults(&cfg);
+    cfg.freq_end_hz = cfg.freq_start_hz + MAX_BAND_HZ + 100;
+    CHECK(!detectorConfigValid(&cfg), "band wider than MAX_BAND_HZ is rejected");
+    detectorConfigDefaults(&cfg);
+    cfg.threshold_db = NAN;
+    CHECK(!detectorConfigValid(&cfg), "NaN threshold is rejected");
+
+    // Text fields
+    detectorConfigDefaults(&cfg);
+    CHECK(detectorConfigSet(&cfg, "freq_start_hz", "900") && cfg.freq_start_hz == 900, "set band start");
+    CHECK(detectorConfigSet(&cfg, "window", windowName(WINDOW_HANN)) && cfg.window == WINDOW_HANN, "set window by name");
+    CHECK(detectorConfigSet(&cfg, "long_window", "1") && cfg.long_window, "set long window");
+    CHECK(!detectorConfigSet(&cfg, "snr_db", "12dB") && !detectorConfigSet(&cfg, "long_window", "2") &&
+          !detectorConfigSet(&cfg, "window", "square") && !detectorConfigSet(&cfg, "gain", "1"),
+          "malformed values and unknown keys are refused");
+    detectorConfigDefaults(&cfg);
+    detectorConfigFormat(&cfg, json, sizeof(json));
+    CHECK(strstr(json, "\"freq_start_hz\":2750") != NULL && json[0] == '{' && json[strlen(json) - 1] == '}',
+          "format writes a JSON object");
+
+    // Swap protocol: one change in flight until both stages picked it up
+    CHECK(dspCoreInit(), "core init");
+    detectorConfigDefaults(&cfg);
+    cfg.threshold_db = -200.0f;
+    CHECK(dspCoreConfigure(&cfg) == DSP_CONFIG_INVALID, "configure rejects an invalid config");
+    cfg.threshold_db = -45.0f;
+    CHECK(dspCoreConfigure(&cfg) == DSP_CONFIG_OK, "configure accepts a valid config");
+    dspCoreGetConfig(&got);
+    CHECK(got.threshold_db == -45.0f, "pending config is reported");
+    CHECK(dspCoreConfigure(&cfg) == DSP_CONFIG_BUSY, "second change is busy until a frame runs");
+    toneRun(0.0f, 0.1f, 1, NULL, NULL);
+    CHECK(dspCoreConfigure(&cfg) == DSP_CONFIG_OK, "next change accepted once applied");
+    toneRun(0.0f, 0.1f, 1, NULL, NULL);
+
+    // Retune the band mid-stream: a 1 kHz tone starting after the change is detected there
+    int freq = 0;
+    int secs = USE_LONG_WINDOW ? 12 : 6;
+    CHECK(toneRun(1000.0f, 0.1f, secs, retuneMidStream, &freq) > 0 && fabsf((float)freq - 1000.0f) <= FREQ_RESO,
+          "tone detected in the retuned band");
+    detectorConfigDefaults(&cfg);
+    dspCoreConfigure(&cfg);
+    CHECK(toneRun(1000.0f, 0.1f, secs, NULL, NULL) == 0, "default band restored");
+
+    // Per-bin state: kept across level changes, cleared by a band change
+    CHECK(toneRun(3000.0f, 0.1f, secs, retuneLevels, NULL) > 0, "threshold changes keep confirmation state");
+    CHECK(toneRun(3000.0f, 0.1f, secs, retuneBand, NULL) == 0, "band changes restart confirmation");
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,132 @@
+/*
+ * Host check of the detection core: an in-band tone must be confirmed,
+ * silence and an out-of-band tone must not.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include "dsp_core.h"
+#include "dsp_window.h"
+#include "test_check.h"
+#include "test_stream.h"
+
+#define TEST_SECONDS    6     // Long-window mode decides once per 4 s
+
+static int32_t frame[FFT_SIZE];
+static float fused[FFT_SIZE];
+static float staged[FFT_SIZE];
+
+// Confirmed detections of a sine of the given frequency and amplitude, each within one bin of it
+static int runTone(float freq_hz, float amplitude)
+{
+    int freq = (int)freq_hz;
+    int detections = toneRun(freq_hz, amplitude, TEST_SECONDS, NULL, &freq);
+    if (detections > 0)
+        CHECK(fabsf((float)freq - freq_hz) <= FREQ_RESO, "detected frequency within one bin");
+    return detections;
+}
+
+int main(void)
+{
+    CHECK(dspCoreInit(), "core init");
+
+    CHECK(runTone(3000.0f, 0.1f) > 0, "in-band tone at -20 dBFS is detected");
+    CHECK(runTone(3000.0f, 0.0f) == 0, "silence is not detected");
+    CHECK(runTone(1000.0f, 0.5f) == 0, "out-of-band tone is not detected");
+#if USE_LONG_WINDOW && LONG_WINDOW_SLIDING
+    CHECK(runTone(3000.0f, 0.1f) > 1, "sliding long window decides again after each step");
+#endif
+
+    // Spectrum and detection stages run separately (two tasks on target) match dspProcessFrame
+    static dsp_detection_t whole[64];
+    static dsp_spectrum_t spectrum;
+    bool stagesMatch = true;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        dspCoreReset();
+        for (int f = 0; f < 64; f++)
+        {
+            for (int i = 0; i < FFT_SIZE; i++)
+            {
+                long long n = (long long)f * HOP_SIZE + i;
+                frame[i] = (f / 8) % 2 ? (int32_t)(0.1 * 2147483647.0 * sin(2.0 * M_PI * 3000.0 * n / SAMPLE_RATE)) : 0;
+            }
+            dsp_detection_t r;
+            if (pass == 0)
+            {
+                dspProcessFrame(frame, &whole[f]);
+                continue;
+            }
+            dspComputeSpectrum(frame, &spectrum);
+            dspAnalyzeSpectrum(&spectrum, &r);
+            stagesMatch &= r.detected == whole[f].detected && r.tone_on == whole[f].tone_on &&
+                           r.freq_hz == whole[f].freq_hz && r.peak_db == whole[f].peak_db;
+        }
+    }
+    CHECK(stagesMatch, "separate spectrum and detection stages match the full pipeline");
+
+    // Fused normalize+window must match the separate stages exactly
+    for (int i = 0; i < FFT_SIZE; i++)
+        frame[i] = (int32_t)(i * 2654435761u);
+    windowApplyNormalized(frame, fused, FFT_SIZE);
+    normalizeBuffer(frame, staged, FFT_SIZE);
+    applyWindow(staged, FFT_SIZE);
+    bool same = true;
+    for (int i = 0; i < FFT_SIZE; i++)
+        same &= fused[i] == staged[i];
+    CHECK(same, "fused normalize+window matches separate stages");
+
+    // Every window keeps the in-band tone detectable at the same level
+    detector_config_t cfg;
+    detectorConfigDefaults(&cfg);
+    for (window_type_t w = 0; w < WINDOW_COUNT; w++)
+    {
+        char msg[64];
+        snprintf(msg, sizeof(msg), "%s window detects in-band tone", windowName(w));
+        cfg.window = w;
+        CHECK(dspCoreConfigure(&cfg) == DSP_CONFIG_OK && runTone(3000.0f, 0.1f) > 0, msg);
+    }
+    detectorConfigDefaults(&cfg);
+    dspCoreConfigure(&cfg);
+
+    // Sliding frame always holds the latest FFT_SIZE samples, one frame per hop.
+    // Decimated, a ramp comes out as every Nth input less the FIR's group delay.
+#if DECIMATION_FACTOR > 1
+    const double delay = (DECIMATION_TAPS - 1) / 2.0;
+#else
+    const double delay = 0.0;
+#endif
+    #define RAMP_LEN ((FFT_SIZE + 3 * HOP_SIZE) * DECIMATION_FACTOR)
+    static int32_t ramp[RAMP_LEN];
+    for (int i = 0; i < RAMP_LEN; i++)
+        ramp[i] = i;
+    dspCoreReset();
+    int pushed = 0, frames = 0;
+    bool latest = true;
+    while (pushed < RAMP_LEN)
+    {
+        int left = RAMP_LEN - pushed;
+        pushed += dspStreamPush(&ramp[pushed], left < 333 ? left : 333);
+        const int32_t *f = dspStreamFrame();
+        if (f != NULL)
+        {
+            // The first frame starts on the filter's silent history
+            latest &= fabs(f[FFT_SIZE - 1] - (pushed - 1 - delay)) <= 1.0;
+            if (frames > 0)
+                latest &= fabs(f[0] - (pushed - 1 - (FFT_SIZE - 1) * DECIMATION_FACTOR - delay)) <= 1.0;
+            dspStreamAdvance();
+            frames++;
+        }
+    }
+    CHECK(latest && frames == 4, "stream analyzes the latest FFT_SIZE samples every HOP_SIZE");
+    dspCoreReset();
+
+    mem_block_t blocks[16];
+    int count = dspCoreBuffers(blocks, 16);
+    bool aligned = count > 0;
+    for (int i = 0; i < count; i++)
+        aligned &= ((uintptr_t)blocks[i].addr % DSP_ALIGN) == 0 && blocks[i].size > 0;
+    CHECK(aligned, "DSP buffers are 16-byte aligned");
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,110 @@
+/*
+ * Energy gate: the band-pass measures a tone at its level in the band and
+ * rejects it outside, quiet frames skip the transform, the quietest tone
+ * detection accepts keeps the gate open even at the band edges, and gated
+ * frames leave every decision as if they had been transformed.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "dsp_core.h"
+#include "dsp_gate.h"
+#include "test_check.h"
+#include "test_stream.h"
+
+#define TEST_SECONDS    6
+#define MAX_FRAMES      (TEST_SECONDS * 48000 / HOP_SIZE + 1)   // Analysis rate is at most the capture rate
+
+#if USE_NOISE_FLOOR
+#define LOWEST_DB       (NOISE_FLOOR_MIN_DB + 3.0f)
+#else
+#define LOWEST_DB       (THRESHOLD_DB + 3.0f)
+#endif
+
+static dsp_detection_t frames[2][MAX_FRAMES];
+
+static void recordFrame(int frame, const dsp_spectrum_t *spectrum, const dsp_detection_t *detection, void *ctx)
+{
+    (void)spectrum;
+    if (frame < MAX_FRAMES)
+        ((dsp_detection_t *)ctx)[frame] = *detection;
+}
+
+// Tone after the lead-in, pulsed 500 ms on / 500 ms off if `pulsed`; per-frame results into `out`
+static stream_run_t run(float freq_hz, float level_db, bool pulsed, dsp_detection_t *out)
+{
+    test_signal_t signals[CAPTURE_CHANNELS];
+    for (int ch = 0; ch < CAPTURE_CHANNELS; ch++)
+        signals[ch] = (test_signal_t){ freq_hz, level_db, pulsed, 12345 };    // Every microphone hears the same
+    return streamRun(signals, TEST_SECONDS, out != NULL ? recordFrame : NULL, out);
+}
+
+// Band-pass alone: level of a steady tone at `freq_hz`, in dB
+static float gateDb(float freq_hz, float level_db)
+{
+    static int32_t tone[4 * FFT_SIZE];
+    for (int i = 0; i < 4 * FFT_SIZE; i++)
+        tone[i] = (int32_t)(pow(10.0, level_db / 20.0) * 2147483647.0 * sin(2.0 * M_PI * freq_hz * i / SAMPLE_RATE));
+
+    gateReset();
+    gateFeed(tone, 4 * FFT_SIZE);    // The last FFT_SIZE samples are long past the filter's settling
+    return 10.0f * log10f(gateLevel() + 1e-24f);
+}
+
+int main(void)
+{
+    CHECK(!gateInit(FFT_SIZE, 3 * FFT_SIZE / 7, false), "frame not a whole number of segments rejected");
+    CHECK(!gateInit(FFT_SIZE * (GATE_MAX_SEGMENTS + 1), FFT_SIZE, false), "too many segments rejected");
+
+#if !USE_ZOOM_FFT
+    CHECK(gateInit(FFT_SIZE, HOP_SIZE, false), "gate init");
+    gateSetBand(Freq_START_HZ, Freq_END_HZ, SAMPLE_RATE);
+    float center = gateDb(sqrtf((float)Freq_START_HZ * Freq_END_HZ), -20.0f);
+    float edge = fminf(gateDb(Freq_START_HZ, -20.0f), gateDb(Freq_END_HZ, -20.0f));
+    float outside = gateDb(1000.0f, -20.0f);
+    printf("      -20 dBFS tone: %.2f dB at the centre, %.2f dB at the worse edge, %.1f dB at 1 kHz\n",
+           center, edge, outside);
+    CHECK(fabsf(center + 20.0f) < 0.2f, "tone at the band centre reads its level");
+    CHECK(fabsf(edge + 23.0f) < 0.5f, "tone at the band edges reads 3 dB low");
+    CHECK(outside < -40.0f, "tone well outside the band is attenuated by 20 dB");
+#endif
+
+    // The core's own gate from here
+    CHECK(dspCoreInit(), "core init");
+
+    stream_run_t quiet = run(3000.0f, NO_TONE_DB, false, NULL);
+    printf("      quiet room: %d of %d frames gated\n", quiet.gated, quiet.frames);
+    CHECK(quiet.gated == quiet.frames, "quiet room never reaches the transform");
+
+    // The quietest tone detection accepts keeps the gate open, band edge or not
+    const float freqs[3] = { Freq_START_HZ + 10.0f, 3000.0f, Freq_END_HZ - 10.0f };
+    for (int f = 0; f < 3; f++)
+    {
+        char msg[96];
+        stream_run_t lowest = run(freqs[f], LOWEST_DB, false, NULL);
+        snprintf(msg, sizeof(msg), "%.0f dB tone at %.0f Hz keeps the gate open and is detected", LOWEST_DB, freqs[f]);
+        printf("      %.0f Hz: %d frames gated after the onset, %d detections\n",
+               freqs[f], lowest.gatedAfterOnset, lowest.detections);
+        CHECK(lowest.gatedAfterOnset == 0 && lowest.detections > 0, msg);
+    }
+
+    // Pulsed alarm with quiet gaps: every gated frame audited, then the gate as shipped
+    dspGateSetAudit(1);
+    stream_run_t audited = run(3000.0f, LOWEST_DB + 10.0f, true, frames[0]);
+    dspGateSetAudit(GATE_AUDIT_EVERY);
+    stream_run_t gated = run(3000.0f, LOWEST_DB + 10.0f, true, frames[1]);
+    bool same = audited.frames == gated.frames;
+    for (int i = 0; same && i < gated.frames && i < MAX_FRAMES; i++)
+    {
+        same = frames[0][i].detected == frames[1][i].detected && frames[0][i].tone_on == frames[1][i].tone_on &&
+               frames[0][i].freq_hz == frames[1][i].freq_hz && frames[0][i].pattern == frames[1][i].pattern;
+    }
+    printf("      pulsed alarm: %d of %d frames gated, %d detections, %d gate misses\n",
+           gated.gated, gated.frames, gated.detections, audited.misses);
+    CHECK(audited.misses == 0, "no audited gap frame held a tone");
+    CHECK(gated.gated > 0 && gated.detections > 0, "gaps are gated and the alarm is still detected");
+    CHECK(same, "gated frames leave every decision as if transformed");
+
+    return failures ? 1 : 0;
+}
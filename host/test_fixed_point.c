@@ -0,0 +1,140 @@
+/*
+ * Accuracy of the Q15 pipeline (block scaling, sc16 FFT, integer band
+ * power and threshold) against the float path, over tone level, with and
+ * without a loud out-of-band interferer.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include "dsp_core.h"
+#include "dsp_fixed.h"
+#include "dsp_window.h"
+#include "test_check.h"
+
+#define DB_TOLERANCE        0.5f    // max |fixed - float| peak level, tone alone
+#define DB_TOLERANCE_MASKED 1.0f    // same, next to a -6 dBFS interferer
+#define DECISION_MARGIN     0.25f   // levels this close to THRESHOLD_DB may go either way
+
+static int32_t frame[FFT_SIZE];
+static float work[FFT_SIZE];
+static int16_t q15[FFT_SIZE];
+static uint64_t power[MAX_BAND_BINS];
+
+static uint32_t lcg = 12345;
+
+// Tone plus -90 dBFS uniform noise, optionally with a 1 kHz interferer; the
+// sum must stay below full scale
+static void makeFrame(float freq_hz, float level_db, float interferer_db)
+{
+    double a = pow(10.0, level_db / 20.0);
+    double b = interferer_db > -200.0f ? pow(10.0, interferer_db / 20.0) : 0.0;
+
+    for (int n = 0; n < FFT_SIZE; n++)
+    {
+        lcg = lcg * 1664525u + 1013904223u;
+        double noise = ((int32_t)lcg / 2147483648.0) * 3.16e-5;
+        double x = a * sin(2.0 * M_PI * freq_hz * n / SAMPLE_RATE)
+                 + b * sin(2.0 * M_PI * 1000.0 * n / SAMPLE_RATE) + noise;
+        frame[n] = (int32_t)lrint(x * 2147483647.0 * 0.999);
+    }
+}
+
+// Peak band level as analyzeBins computes it
+static float floatPeak(int *bin)
+{
+    windowApplyNormalized(frame, work, FFT_SIZE);
+    computeRealFFT(work, FFT_SIZE);
+
+    float peak = -500.0f;
+    for (int i = BIN_START; i <= BIN_END; i++)
+    {
+        float mag = 2.0f * sqrtf(work[2*i] * work[2*i] + work[2*i + 1] * work[2*i + 1]);
+        float db = 20.0f * log10f(mag / windowSum() + 1e-12f);
+        if (db > peak)
+        {
+            peak = db;
+            *bin = i;
+        }
+    }
+    return peak;
+}
+
+static float fixedPeak(int *bin, bool *above)
+{
+    int shift = fixedWindowNormalized(frame, q15, FFT_SIZE);
+    fixedComputeRealFFT(q15, FFT_SIZE);
+    fixedBandPower(q15, FFT_SIZE, BIN_START, BIN_END, power);
+
+    uint64_t peak = 0;
+    for (int i = BIN_START; i <= BIN_END; i++)
+    {
+        if (power[i - BIN_START] > peak)
+        {
+            peak = power[i - BIN_START];
+            *bin = i;
+        }
+    }
+    *above = peak > fixedPowerThreshold(shift);
+    return fixedPowerToDb(peak, shift);
+}
+
+// Sweep tone level; returns the worst error over levels >= min_db
+static float sweep(float freq_hz, float interferer_db, float min_db, float max_db,
+                   bool *decisions_agree, bool *bins_agree)
+{
+    float worst = 0.0f;
+
+    printf("  tone %.0f Hz, interferer %s:\n", freq_hz, interferer_db > -200.0f ? "-6 dBFS" : "none");
+    for (float level = -80.0f; level <= max_db; level += 4.0f)
+    {
+        int fbin = 0, qbin = 0;
+        bool above = false;
+
+        makeFrame(freq_hz, level, interferer_db);
+        float f = floatPeak(&fbin);
+        float q = fixedPeak(&qbin, &above);
+        float err = fabsf(q - f);
+
+        printf("    %6.1f dBFS  float %7.2f dB  fixed %7.2f dB  err %.3f\n", level, f, q, err);
+        if (level >= min_db)
+        {
+            if (err > worst)
+                worst = err;
+            *bins_agree &= fbin == qbin;
+        }
+        if (fabsf(f - THRESHOLD_DB) > DECISION_MARGIN)
+            *decisions_agree &= above == (f > THRESHOLD_DB);
+    }
+    return worst;
+}
+
+int main(void)
+{
+    CHECK(dspCoreInit() && fixedInit(WINDOW_TYPE, FFT_SIZE, THRESHOLD_DB), "init");
+
+    bool decisions = true, bins = true;
+    float worst = sweep(3000.0f, -500.0f, -70.0f, 0.0f, &decisions, &bins);
+    worst = fmaxf(worst, sweep(2814.5f, -500.0f, -70.0f, 0.0f, &decisions, &bins));
+    printf("  worst error, tone alone (>= -70 dBFS): %.3f dB\n", worst);
+    CHECK(worst <= DB_TOLERANCE, "fixed-point peak level within 0.5 dB of float");
+
+    float masked = sweep(3000.0f, -6.0f, -50.0f, -8.0f, &decisions, &bins);
+    printf("  worst error, -6 dBFS interferer (tone >= -50 dBFS): %.3f dB\n", masked);
+    CHECK(masked <= DB_TOLERANCE_MASKED, "fixed-point peak level within 1 dB of float next to a loud interferer");
+
+    CHECK(bins, "fixed-point peak bin matches float");
+    CHECK(decisions, "integer threshold agrees with float threshold away from the boundary");
+
+    // Common-scale magnitude threshold matches the per-shift power threshold
+    bool consistent = true;
+    for (int s = 0; s <= 17; s++)
+    {
+        uint64_t p = fixedPowerThreshold(s);
+        uint64_t m = fixedMagnitude(p, s);
+        double rel = fabs((double)m - (double)fixedMagnitudeThreshold()) / (double)fixedMagnitudeThreshold();
+        consistent &= rel < 0.01 || p < 100;
+    }
+    CHECK(consistent, "magnitude threshold consistent with power threshold");
+
+    return failures ? 1 : 0;
+}
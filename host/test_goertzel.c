@@ -0,0 +1,145 @@
+/*
+ * Goertzel band engine against the real FFT of the same frame under the
+ * same (periodic) window, for every window type; streamed frames that
+ * reuse earlier hops against standalone ones; tone level on the FFT path's
+ * scale.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "dsp_core.h"
+#include "dsp_goertzel.h"
+#include "dsp_window.h"
+#include "test_check.h"
+
+#define REL_TOLERANCE   1e-4f   // max bin error relative to in-band peak
+#define STREAM_HOPS     24
+
+static int32_t signal[FFT_SIZE + STREAM_HOPS * HOP_SIZE];
+static float windowed[FFT_SIZE];
+static float fftOut[FFT_SIZE];
+static float gOut[FFT_SIZE];
+static float gRef[FFT_SIZE];
+
+static int64_t nowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static float binMag(const float *d, int k)
+{
+    return sqrtf(d[2*k] * d[2*k] + d[2*k + 1] * d[2*k + 1]);
+}
+
+// Max |a - b| (complex) over the band relative to the band peak of b
+static float bandError(const float *a, const float *b)
+{
+    float max_err = 0.0f, max_mag = 0.0f;
+    for (int k = BIN_START; k <= BIN_END; k++)
+    {
+        float err = hypotf(a[2*k] - b[2*k], a[2*k + 1] - b[2*k + 1]);
+        if (err > max_err) max_err = err;
+        if (binMag(b, k) > max_mag) max_mag = binMag(b, k);
+    }
+    return max_mag > 0.0f ? max_err / max_mag : max_err;
+}
+
+// Reference: periodic cosine-sum window in time, normalized like windowApply*, real FFT
+static void referenceSpectrum(const int32_t *frame, window_type_t type, float *out)
+{
+    float a[WINDOW_TERMS];
+    windowCosineTerms(type, a);
+    for (int n = 0; n < FFT_SIZE; n++)
+    {
+        double x = 2.0 * M_PI * n / FFT_SIZE;
+        double w = a[0] - a[1] * cos(x) + a[2] * cos(2.0 * x) - a[3] * cos(3.0 * x) + a[4] * cos(4.0 * x);
+        out[n] = (float)(frame[n] / 2147483648.0 * w);
+    }
+    computeRealFFT(out, FFT_SIZE);
+}
+
+int main(void)
+{
+    CHECK(dspCoreInit(), "core init");
+    CHECK(goertzelInit(BIN_START, BIN_END, FFT_SIZE, HOP_SIZE, WINDOW_HAMMING), "goertzel init over detection band");
+    CHECK(!goertzelInit(10, 10 + GOERTZEL_MAX_BINS, FFT_SIZE, HOP_SIZE, WINDOW_HAMMING), "oversized band rejected");
+    CHECK(!goertzelInit(2, 20, FFT_SIZE, HOP_SIZE, WINDOW_FLAT_TOP), "band too close to DC for the window rejected");
+    CHECK(!goertzelInit(BIN_START, BIN_END, FFT_SIZE, FFT_SIZE / (GOERTZEL_MAX_SEGMENTS * 2), WINDOW_HAMMING),
+          "too many hops per frame rejected");
+
+    // 3.1 kHz tone plus white noise, long enough to slide over
+    srand(42);
+    for (int i = 0; i < (int)(sizeof(signal) / sizeof(signal[0])); i++)
+    {
+        double v = 0.05 * sin(2.0 * M_PI * 3100.0 * i / SAMPLE_RATE) + 0.01 * ((double)rand() / RAND_MAX - 0.5);
+        signal[i] = (int32_t)(v * 2147483647.0);
+    }
+
+    // Standalone frames: every window matches the FFT under the same window
+    float worst = 0.0f;
+    for (int type = 0; type < WINDOW_COUNT; type++)
+    {
+        CHECK(goertzelInit(BIN_START, BIN_END, FFT_SIZE, HOP_SIZE, type), windowName(type));
+        referenceSpectrum(signal, type, fftOut);
+        goertzelFrame(signal, gOut);
+        worst = fmaxf(worst, bandError(gOut, fftOut));
+    }
+    printf("      whole-frame max rel err %.3g\n", worst);
+    CHECK(worst <= REL_TOLERANCE, "goertzel bins match FFT bins for every window");
+
+    // Streamed frames reuse earlier hops, including across frames never analyzed
+    goertzelInit(BIN_START, BIN_END, FFT_SIZE, HOP_SIZE, WINDOW_HAMMING);
+    goertzelReset();
+    worst = 0.0f;
+    for (int h = 0; h < STREAM_HOPS; h++)
+    {
+        const int32_t *frame = &signal[h * HOP_SIZE];
+        if (h % 7 != 3)
+        {
+            goertzelStreamFrame(0, frame, gOut);
+            goertzelFrame(frame, gRef);
+            worst = fmaxf(worst, bandError(gOut, gRef));
+        }
+        goertzelAdvance();
+    }
+    printf("      streamed vs standalone max rel err %.3g\n", worst);
+    CHECK(worst <= 1e-6f, "streamed frames match standalone frames");
+
+    // Level on the detector's scale: a bin-centred tone of amplitude A peaks at A * windowSum / 2
+    for (int n = 0; n < FFT_SIZE; n++)
+        signal[n] = (int32_t)(0.25 * 2147483647.0 * sin(2.0 * M_PI * 256 * n / FFT_SIZE));
+    goertzelInit(250, 262, FFT_SIZE, HOP_SIZE, WINDOW_HAMMING);
+    goertzelFrame(signal, gOut);
+    float expect = 0.25f * goertzelWindowSum(WINDOW_HAMMING, FFT_SIZE) / 2.0f;
+    CHECK(fabsf(binMag(gOut, 256) / expect - 1.0f) < 1e-3f, "bin-centred tone reads its amplitude");
+
+    // Relative cost, informational only
+    const int reps = 200;
+    goertzelInit(BIN_START, BIN_END, FFT_SIZE, HOP_SIZE, WINDOW_HAMMING);
+    int64_t t0 = nowNs();
+    for (int r = 0; r < reps; r++)
+        goertzelFrame(signal, gOut);
+    int64_t t1 = nowNs();
+    for (int r = 0; r < reps; r++)
+    {
+        goertzelStreamFrame(0, signal, gOut);
+        goertzelAdvance();
+    }
+    int64_t t2 = nowNs();
+    for (int r = 0; r < reps; r++)
+    {
+        windowApplyNormalized(signal, windowed, FFT_SIZE);
+        computeRealFFT(windowed, FFT_SIZE);
+    }
+    int64_t t3 = nowNs();
+    printf("      ns/frame: goertzel %d bins %lld standalone, %lld streamed; window + real fft %lld\n",
+           BIN_END - BIN_START + 1, (long long)((t1 - t0) / reps), (long long)((t2 - t1) / reps),
+           (long long)((t3 - t2) / reps));
+
+    return failures ? 1 : 0;
+}
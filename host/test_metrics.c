@@ -0,0 +1,81 @@
+/*
+ * Metrics: bucket placement, Prometheus text output, and consistent
+ * histogram snapshots while the single writer keeps observing.
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "metrics.h"
+#include "test_check.h"
+
+#define OBSERVATIONS    2000000
+
+static char text[8192];
+static int writerDone = 0;
+
+static void *writer(void *arg)
+{
+    (void)arg;
+    for (int i = 0; i < OBSERVATIONS; i++)
+        metricsObserve(METRIC_ANALYSIS, 300);
+    __atomic_store_n(&writerDone, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+int main(void)
+{
+    metrics_histogram_t h;
+
+    // Bucket bounds are inclusive; negative durations count as 0
+    metricsObserve(METRIC_FFT, 100);
+    metricsObserve(METRIC_FFT, 101);
+    metricsObserve(METRIC_FFT, -5);
+    metricsObserve(METRIC_FFT, 5000000);
+    metricsGetHistogram(METRIC_FFT, &h);
+    CHECK(h.count == 4 && h.buckets[0] == 2 && h.buckets[1] == 1 && h.buckets[METRICS_HIST_BUCKETS - 1] == 1,
+          "durations land in their buckets");
+    CHECK(h.sum_us == 100 + 101 + 0 + 5000000, "sum of observed durations");
+
+    metricsCount(METRIC_ALARM_EVENTS_DROPPED);
+    metricsCount(METRIC_ALARM_EVENTS_DROPPED);
+    metricsPeak(METRIC_SPECTRUM_QUEUE_PEAK, 3);
+    metricsPeak(METRIC_SPECTRUM_QUEUE_PEAK, 2);
+    CHECK(metricsGetCounter(METRIC_ALARM_EVENTS_DROPPED) == 2, "counter counts");
+    CHECK(metricsGetPeak(METRIC_SPECTRUM_QUEUE_PEAK) == 3, "peak keeps the maximum");
+
+    // Prometheus text
+    size_t length = metricsFormat(text, sizeof(text));
+    CHECK(length > 0 && length == strlen(text), "format fits and reports its length");
+    CHECK(strstr(text, "# TYPE " METRICS_PREFIX "fft_seconds histogram\n") != NULL &&
+          strstr(text, METRICS_PREFIX "fft_seconds_bucket{le=\"0.0001\"} 2\n") != NULL &&
+          strstr(text, METRICS_PREFIX "fft_seconds_bucket{le=\"0.00025\"} 3\n") != NULL &&
+          strstr(text, METRICS_PREFIX "fft_seconds_bucket{le=\"+Inf\"} 4\n") != NULL &&
+          strstr(text, METRICS_PREFIX "fft_seconds_count 4\n") != NULL,
+          "histogram buckets are cumulative with +Inf equal to the count");
+    CHECK(strstr(text, METRICS_PREFIX "alarm_events_dropped_total 2\n") != NULL &&
+          strstr(text, METRICS_PREFIX "queue_high_water{queue=\"spectrum\"} 3\n") != NULL,
+          "counters and queue peaks are written");
+    CHECK(metricsFormat(text, 64) == 0, "too small a buffer is reported");
+
+    // Snapshots taken while the writer runs are consistent
+    pthread_t thread;
+    pthread_create(&thread, NULL, writer, NULL);
+    bool consistent = true;
+    int snapshots = 0;
+    while (!__atomic_load_n(&writerDone, __ATOMIC_ACQUIRE))
+    {
+        metricsGetHistogram(METRIC_ANALYSIS, &h);
+        uint32_t total = 0;
+        for (int b = 0; b < METRICS_HIST_BUCKETS; b++)
+            total += h.buckets[b];
+        consistent &= total == h.count && h.sum_us == 300ull * h.count;
+        snapshots++;
+    }
+    pthread_join(thread, NULL);
+    printf("      %d snapshots during %d observations\n", snapshots, OBSERVATIONS);
+    CHECK(consistent, "snapshots during concurrent observes are consistent");
+
+    return failures ? 1 : 0;
+}
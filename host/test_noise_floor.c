@@ -0,0 +1,167 @@
+/*
+ * Adaptive noise floor: a loud room must not trigger, an alarm above it
+ * must; a quiet room must detect below the old fixed threshold; a steady
+ * tone is absorbed, a pulsed alarm is not. Also checks the floor against
+ * the true mean noise level (the minimum-statistics bias correction).
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include "dsp_core.h"
+#include "dsp_noise_floor.h"
+#include "dsp_window.h"
+#include "test_check.h"
+
+static int32_t block[SAMPLE_BUFFER_SIZE];
+static float work[DSP_WORK_BUFFER_LEN];
+
+#define BLOCKS_PER_S    ((int)(I2S_SAMPLE_RATE_HZ / SAMPLE_BUFFER_SIZE))
+#define ALARM_SECONDS   (USE_LONG_WINDOW ? 9 : 4)   // Long-window mode needs a whole 4 s window of alarm
+
+static uint32_t lcg = 1;
+static long long n = 0;
+
+// Gaussian-ish noise (sum of 4 uniforms) at noise_db RMS plus a 3 kHz tone;
+// period_ms > 0 gates the tone 50% on/off
+static void makeBlock(float noise_db, float tone_db, int period_ms)
+{
+    double sigma = pow(10.0, noise_db / 20.0);
+    double a = tone_db > -200.0f ? pow(10.0, tone_db / 20.0) : 0.0;
+
+    for (int i = 0; i < SAMPLE_BUFFER_SIZE; i++, n++)
+    {
+        double u = 0.0;
+        for (int k = 0; k < 4; k++)
+        {
+            lcg = lcg * 1664525u + 1013904223u;
+            u += (lcg / 4294967296.0) - 0.5;
+        }
+        double noise = u * sigma * sqrt(3.0);   // Var of 4 uniforms is 1/3
+
+        bool on = period_ms <= 0 || (n * 1000 / (long long)I2S_SAMPLE_RATE_HZ) % period_ms < period_ms / 2;
+        double x = noise + (on ? a * sin(2.0 * M_PI * 3000.0 * n / I2S_SAMPLE_RATE_HZ) : 0.0);
+        block[i] = (int32_t)lrint(fmax(-1.0, fmin(0.999, x)) * 2147483647.0);
+    }
+}
+
+// Run `seconds`; returns confirmations and the fraction of frames with tone_on in the last `tail_s`
+static int run(float noise_db, float tone_db, int period_ms, int seconds, int tail_s, float *on_fraction)
+{
+    int confirmations = 0, on = 0, frames = 0;
+
+    for (int b = 0; b < seconds * BLOCKS_PER_S; b++)
+    {
+        makeBlock(noise_db, tone_db, period_ms);
+
+        const int32_t *p = block;
+        int left = SAMPLE_BUFFER_SIZE;
+        while (left > 0)
+        {
+            int used = dspStreamPush(p, left);
+            p += used;
+            left -= used;
+            if (dspStreamFrame() == NULL)
+                continue;
+
+            dsp_detection_t result;
+            if (dspProcessFrame(dspStreamFrame(), &result) && result.detected)
+                confirmations++;
+            dspStreamAdvance();
+
+            if (b >= (seconds - tail_s) * BLOCKS_PER_S)
+            {
+                frames++;
+                on += result.tone_on;
+            }
+        }
+    }
+
+    if (on_fraction != NULL)
+        *on_fraction = frames ? (float)on / frames : 0.0f;
+    return confirmations;
+}
+
+int main(void)
+{
+#if !USE_NOISE_FLOOR
+    printf("skipped: USE_NOISE_FLOOR is 0\n");
+    return 0;
+#endif
+
+    CHECK(dspCoreInit(), "core init");
+
+    // Floor vs the mean band level of the same noise
+    dspCoreReset();
+    run(-20.0f, -500.0f, 0, 12, 0, NULL);
+    double mean = 0.0, floor_sum = 0.0;
+    int frames = 0;
+    while (frames < 200)
+    {
+        // Frames from the stream, decimated as the detector sees them
+        makeBlock(-20.0f, -500.0f, 0);
+        const int32_t *p = block;
+        int left = SAMPLE_BUFFER_SIZE;
+        while (left > 0)
+        {
+            int used = dspStreamPush(p, left);
+            p += used;
+            left -= used;
+
+            const int32_t *frame = dspStreamFrame();
+            if (frame == NULL)
+                continue;
+
+            windowApplyNormalized(frame, work, FFT_SIZE);
+            computeFFT(work, FFT_SIZE);
+            for (int i = BIN_START; i <= BIN_END; i++)
+            {
+                float mag = 2.0f * sqrtf(work[2*i] * work[2*i] + work[2*i + 1] * work[2*i + 1]) / windowSum();
+                mean += mag * mag;
+            }
+            dspStreamAdvance();
+            frames++;
+        }
+    }
+    for (int i = 0; i <= BIN_END - BIN_START; i++)
+        floor_sum += noiseFloorPower(i);
+    mean /= (double)frames * (BIN_END - BIN_START + 1);
+    double floor_mean = floor_sum / (BIN_END - BIN_START + 1);
+    double bias_db = 10.0 * log10(mean / floor_mean);
+    printf("  mean noise %.1f dB, tracked floor %.1f dB (%.1f dB apart)\n",
+           10.0 * log10(mean), 10.0 * log10(floor_mean), bias_db);
+    CHECK(fabs(bias_db) < 3.0, "tracked floor within 3 dB of the mean noise level");
+
+    float on = 0.0f;
+    int c;
+
+    dspCoreReset();
+    c = run(-12.0f, -500.0f, 0, 20, 10, &on);
+    printf("  loud room (-12 dBFS noise): %d confirmations, tone_on %.1f%% of frames\n", c, 100.0f * on);
+    CHECK(c == 0, "loud room alone is not detected");
+
+    dspCoreReset();
+    run(-12.0f, -500.0f, 0, 10, 0, NULL);
+    c = run(-12.0f, -15.0f, 1000, ALARM_SECONDS, 4, &on);
+    printf("  alarm in loud room: %d confirmations\n", c);
+    CHECK(c > 0, "alarm above the loud room's floor is detected");
+
+    dspCoreReset();
+    run(-90.0f, -500.0f, 0, 10, 0, NULL);
+    c = run(-90.0f, -55.0f, 1000, ALARM_SECONDS, 4, &on);
+    printf("  -55 dBFS alarm in quiet room: %d confirmations\n", c);
+    CHECK(c > 0, "quiet alarm below the old fixed threshold is detected in a quiet room");
+
+    dspCoreReset();
+    run(-60.0f, -500.0f, 0, 4, 0, NULL);
+    run(-60.0f, -20.0f, 0, (int)(2 * NOISE_FLOOR_WINDOW_S), 2, &on);
+    printf("  steady tone after %d s: tone_on %.1f%% of frames\n", (int)(2 * NOISE_FLOOR_WINDOW_S), 100.0f * on);
+    CHECK(on == 0.0f, "steady tone is absorbed into the floor");
+
+    dspCoreReset();
+    run(-60.0f, -500.0f, 0, 4, 0, NULL);
+    run(-60.0f, -20.0f, 1000, (int)(2 * NOISE_FLOOR_WINDOW_S), 4, &on);
+    printf("  pulsed tone after %d s: tone_on %.1f%% of frames\n", (int)(2 * NOISE_FLOOR_WINDOW_S), 100.0f * on);
+    CHECK(on > 0.4f, "pulsed alarm stays above the floor");
+
+    return failures ? 1 : 0;
+}
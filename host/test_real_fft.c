@@ -0,0 +1,90 @@
+/*
+ * Tolerance check of the real-input FFT (N/2 complex FFT + split) against
+ * the full complex FFT it replaces, on bins 0..N/2-1.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "dsp_core.h"
+#include "esp_dsp.h"
+#include "test_check.h"
+
+#define REL_TOLERANCE   1e-5f   // max |X_real - X_cplx| relative to spectrum peak
+
+static float realBuf[REAL_FFT_BUFFER_LEN];
+static float cplxBuf[COMPLEX_FFT_BUFFER_LEN];
+
+static void compare(const char *name, int length)
+{
+    float max_err = 0.0f, max_mag = 0.0f;
+
+    for (int i = 0; i < length; i++)
+        cplxBuf[i] = realBuf[i];
+
+    computeRealFFT(realBuf, length);
+    computeComplexFFT(cplxBuf, length);
+
+    for (int k = 0; k < length / 2; k++)
+    {
+        float dre = realBuf[2*k] - cplxBuf[2*k];
+        float dim = realBuf[2*k + 1] - cplxBuf[2*k + 1];
+        float err = sqrtf(dre*dre + dim*dim);
+        float mag = sqrtf(cplxBuf[2*k]*cplxBuf[2*k] + cplxBuf[2*k + 1]*cplxBuf[2*k + 1]);
+        if (err > max_err) max_err = err;
+        if (mag > max_mag) max_mag = mag;
+    }
+
+    char msg[64];
+    float rel = max_mag > 0.0f ? max_err / max_mag : max_err;
+    printf("      %-28s N=%-5d max rel err %.3g\n", name, length, rel);
+    snprintf(msg, sizeof(msg), "real FFT matches complex FFT: %s, N=%d", name, length);
+    CHECK(rel <= REL_TOLERANCE, msg);
+}
+
+int main(void)
+{
+    // Complex path needs full-size tables; real path uses the same table with a stride
+    bool ready = dspCoreInit() && dsps_fft2r_init_fc32(NULL, FFT_SIZE) == ESP_OK;
+    CHECK(ready, "core and complex FFT init");
+    if (!ready)
+        return 1;
+
+    for (int length = FFT_SIZE; length >= 64; length /= 4)
+    {
+        for (int i = 0; i < length; i++)
+            realBuf[i] = 0.1f * sinf(2.0f * M_PI * 3000.0f * i / SAMPLE_RATE) + 0.25f;
+        compare("tone + DC", length);
+
+        srand(1234);
+        for (int i = 0; i < length; i++)
+            realBuf[i] = (float)rand() / RAND_MAX - 0.5f;
+        compare("white noise", length);
+
+        for (int i = 0; i < length; i++)
+            realBuf[i] = (i == length / 3) ? 1.0f : 0.0f;
+        compare("impulse", length);
+    }
+
+    // End-to-end: both paths must give the same in-band peak after windowing
+    for (int i = 0; i < FFT_SIZE; i++)
+        realBuf[i] = 0.05f * sinf(2.0f * M_PI * 3100.0f * i / SAMPLE_RATE);
+    applyWindow(realBuf, FFT_SIZE);
+    for (int i = 0; i < FFT_SIZE; i++)
+        cplxBuf[i] = realBuf[i];
+    computeRealFFT(realBuf, FFT_SIZE);
+    computeComplexFFT(cplxBuf, FFT_SIZE);
+
+    dsp_detection_t r_real, r_cplx;
+    dspCoreReset();
+    analyzeBins(realBuf, BIN_START, BIN_END, THRESHOLD_DB, &r_real);
+    dspCoreReset();
+    analyzeBins(cplxBuf, BIN_START, BIN_END, THRESHOLD_DB, &r_cplx);
+
+    printf("      analyzeBins peak %d Hz %.4f dB vs %d Hz %.4f dB\n",
+           r_real.freq_hz, r_real.peak_db, r_cplx.freq_hz, r_cplx.peak_db);
+    CHECK(r_real.freq_hz == r_cplx.freq_hz && fabsf(r_real.peak_db - r_cplx.peak_db) < 1e-3f,
+          "real and complex paths give the same in-band peak");
+
+    return failures ? 1 : 0;
+}
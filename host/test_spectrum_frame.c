@@ -0,0 +1,76 @@
+/*
+ * Live spectrum frames: quantization and both encodings round-trip within
+ * half a step, and the band levels of an in-band tone peak at its bin at
+ * the tone's level.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include "dsp_core.h"
+#include "dsp_spectrum_frame.h"
+#include "test_check.h"
+
+static float level[MAX_BAND_BINS];
+static float decoded[MAX_BAND_BINS];
+static uint8_t frame[SPECTRUM_FRAME_HEADER + MAX_BAND_BINS];
+static int32_t samples[FFT_SIZE];
+
+int main(void)
+{
+    // Quantization
+    CHECK(spectrumQuantize(0.0f) == 255 && spectrumQuantize(12.0f) == 255, "0 dB and above map to 255");
+    CHECK(spectrumQuantize(-200.0f) == 0 && spectrumQuantize(NAN) == 0, "below the floor and NaN map to 0");
+    CHECK(spectrumQuantize(-40.0f) == 175, "-40 dB maps to 175");
+
+    // Round trip, absolute and delta, over a spectrum with steep edges
+    int count = MAX_BAND_BINS;
+    for (int i = 0; i < count; i++)
+        level[i] = -90.0f + 60.0f * expf(-0.05f * (i - count / 2) * (i - count / 2)) + 0.37f * (i % 3);
+
+    for (int delta = 0; delta <= 1; delta++)
+    {
+        int startBin = -1;
+        uint16_t seq = 0;
+        size_t length = spectrumFrameEncode(level, count, 120, FREQ_RESO, 513, delta, frame, sizeof(frame));
+        int n = spectrumFrameDecode(frame, length, decoded, MAX_BAND_BINS, &startBin, &seq);
+
+        float worst = 0.0f;
+        for (int i = 0; i < n; i++)
+            worst = fmaxf(worst, fabsf(decoded[i] - level[i]));
+
+        char msg[80];
+        snprintf(msg, sizeof(msg), "%s frame round-trips within half a step (%.3f dB)",
+                 delta ? "delta" : "absolute", worst);
+        CHECK(length == SPECTRUM_FRAME_HEADER + (size_t)count && n == count && startBin == 120 && seq == 513 &&
+              worst <= SPECTRUM_DB_STEP / 2 + 1e-4f, msg);
+    }
+    CHECK(spectrumFrameEncode(level, count, 0, FREQ_RESO, 0, false, frame, SPECTRUM_FRAME_HEADER + count - 1) == 0,
+          "frame larger than the buffer is refused");
+    CHECK(spectrumFrameDecode(frame, SPECTRUM_FRAME_HEADER - 1, decoded, MAX_BAND_BINS, NULL, NULL) < 0,
+          "truncated frame is rejected");
+
+    // Band levels of a -20 dBFS tone at 3 kHz
+    CHECK(dspCoreInit(), "core init");
+    for (int i = 0; i < FFT_SIZE; i++)
+        samples[i] = (int32_t)(0.1 * 2147483647.0 * sin(2.0 * M_PI * 3000.0 * i / SAMPLE_RATE));
+
+    static dsp_spectrum_t spectrum;
+    dsp_detection_t result;
+    dspComputeSpectrum(samples, &spectrum);
+    dspAnalyzeSpectrum(&spectrum, &result);
+
+    int startBin;
+    int bins = dspSpectrumLevels(&spectrum, level, &startBin);
+    int peak = 0;
+    for (int i = 1; i < bins; i++)
+    {
+        if (level[i] > level[peak])
+            peak = i;
+    }
+    printf("      peak bin %d at %.2f dB\n", startBin + peak, level[peak]);
+    CHECK(startBin == BIN_START && bins == BIN_END - BIN_START + 1, "levels cover the configured band");
+    CHECK(fabsf((startBin + peak) * FREQ_RESO - 3000.0f) <= FREQ_RESO, "level peak at the tone bin");
+    CHECK(fabsf(level[peak] + 20.0f) < 2.0f, "peak level close to -20 dBFS");
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+/*
+ * Streamed test signals shared by the host tests, a tone after a quiet
+ * lead-in fed block by block: with white noise on every microphone through
+ * the stream spectrum and detection as vFFTProcessorTask and vDetectTask
+ * do (streamRun), or clean through dspProcessBlock (toneRun).
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "dsp_core.h"
+
+// Quiet first (silence or noise only): a tone present from the start
+// would become the noise floor
+#define LEAD_IN_SAMPLES 16384
+#define NOISE_AMPLITUDE 1e-5  // About -100 dBFS of white noise under every signal
+#define NO_TONE_DB      -300.0f
+
+// One microphone's signal
+typedef struct {
+    float freq_hz;
+    float level_db;     // Tone level after the lead-in; NO_TONE_DB for noise only
+    bool pulsed;        // Tone 500 ms on / 500 ms off
+    uint32_t noise;     // Noise generator state, seeds the microphone's noise
+} test_signal_t;
+
+typedef struct {
+    int frames;
+    int gated;          // Closed or audited
+    int gatedAfterOnset;
+    int misses;         // Audited with a tone on
+    int detections;
+} stream_run_t;
+
+// Called before capture block `b` is generated
+typedef void (*block_hook_t)(int b);
+
+// Called after each analyzed frame, `frame` counting from 0
+typedef void (*stream_frame_fn)(int frame, const dsp_spectrum_t *spectrum, const dsp_detection_t *detection,
+                                void *ctx);
+
+static inline double testNoise(uint32_t *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return ((double)*state / 4294967296.0 - 0.5) * 2.0 * NOISE_AMPLITUDE;
+}
+
+static inline int32_t testSample(test_signal_t *s, long long n)
+{
+    double x = testNoise(&s->noise);
+    bool on = n >= LEAD_IN_SAMPLES && (!s->pulsed || (n - LEAD_IN_SAMPLES) / (long long)(I2S_SAMPLE_RATE_HZ / 2) % 2 == 0);
+    if (on && s->level_db > -200.0f)
+        x += pow(10.0, s->level_db / 20.0) * sin(2.0 * M_PI * s->freq_hz * n / I2S_SAMPLE_RATE_HZ);
+    return (int32_t)(x * 2147483647.0);
+}
+
+// Stream `seconds` of one signal per capture channel from a reset core;
+// `onFrame` (may be NULL) sees every frame's spectrum and detection
+static inline stream_run_t streamRun(test_signal_t signals[CAPTURE_CHANNELS], int seconds,
+                                     stream_frame_fn onFrame, void *ctx)
+{
+    static int32_t block[CAPTURE_CHANNELS][SAMPLE_BUFFER_SIZE];
+    static dsp_spectrum_t spectrum;
+    stream_run_t r = {0};
+    long long n = 0;
+
+    dspCoreReset();
+    for (int b = 0; b < seconds * I2S_SAMPLE_RATE_HZ / SAMPLE_BUFFER_SIZE; b++)
+    {
+        const int32_t *samples[CAPTURE_CHANNELS];
+        for (int ch = 0; ch < CAPTURE_CHANNELS; ch++)
+        {
+            for (int i = 0; i < SAMPLE_BUFFER_SIZE; i++)
+                block[ch][i] = testSample(&signals[ch], n + i);
+            samples[ch] = block[ch];
+        }
+
+        int left = SAMPLE_BUFFER_SIZE;
+        while (left > 0)
+        {
+            int used = dspStreamPushChannels(samples, left);
+            for (int ch = 0; ch < CAPTURE_CHANNELS; ch++)
+                samples[ch] += used;
+            left -= used;
+            if (dspStreamFrame() == NULL)
+                continue;
+
+            dsp_detection_t detection;
+            dspComputeStreamSpectrum(&spectrum);
+            r.detections += dspAnalyzeSpectrum(&spectrum, &detection);
+            dspStreamAdvance();
+
+            // First sample of the frame, at the capture rate
+            long long first = n + (SAMPLE_BUFFER_SIZE - left) - (long long)FFT_SIZE * ANALYSIS_DECIMATION;
+            bool gated = spectrum.gate != DSP_GATE_OPEN;
+            r.gated += gated;
+            r.gatedAfterOnset += gated && first > LEAD_IN_SAMPLES + 1000;
+            r.misses += spectrum.gate == DSP_GATE_AUDIT && detection.tone_on;
+            if (onFrame != NULL)
+                onFrame(r.frames, &spectrum, &detection, ctx);
+            r.frames++;
+        }
+        n += SAMPLE_BUFFER_SIZE;
+    }
+    return r;
+}
+
+// Confirmed detections of a sine of `amplitude` (full scale 1) after a
+// silent lead-in, over `seconds` from a reset core; `hook` (may be NULL)
+// runs before each block, `freq_detected` (may be NULL) gets the frequency
+// of the last detection
+static inline int toneRun(float freq_hz, float amplitude, int seconds, block_hook_t hook, int *freq_detected)
+{
+    static int32_t block[SAMPLE_BUFFER_SIZE];
+    int detections = 0;
+    long long n = 0;
+
+    dspCoreReset();
+    for (int b = 0; b < seconds * I2S_SAMPLE_RATE_HZ / SAMPLE_BUFFER_SIZE; b++)
+    {
+        if (hook != NULL)
+            hook(b);
+
+        for (int i = 0; i < SAMPLE_BUFFER_SIZE; i++, n++)
+            block[i] = n < LEAD_IN_SAMPLES ? 0 :
+                       (int32_t)(amplitude * 2147483647.0 * sin(2.0 * M_PI * freq_hz * n / I2S_SAMPLE_RATE_HZ));
+
+        dsp_detection_t result;
+        if (dspProcessBlock(block, SAMPLE_BUFFER_SIZE, &result) && result.detected)
+        {
+            detections++;
+            if (freq_detected != NULL)
+                *freq_detected = result.freq_hz;
+        }
+    }
+    return detections;
+}
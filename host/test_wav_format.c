@@ -0,0 +1,77 @@
+/*
+ * WAV capture format: header fields, 16-bit rounding and saturation, and a
+ * round trip through the replay tool's WAV loader, mono and stereo.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "wav_format.h"
+#include "audio_file.h"
+#include "test_check.h"
+
+#define SAMPLES     1000
+
+static int32_t samples[SAMPLES];
+static uint8_t data[SAMPLES * 4];
+
+// Write header + packed samples (`channels` interleaved), then load `channel` back
+static bool roundTrip(int bits, int channels, int channel, audio_clip_t *clip)
+{
+    const char *path = "test_wav_format.wav";
+    uint8_t header[WAV_HEADER_SIZE];
+    int bytes = wavPackSamples(samples, SAMPLES, bits, data);
+
+    wavHeader(header, 48000, bits, channels, (uint32_t)bytes);
+    FILE *f = fopen(path, "wb");
+    if (f == NULL)
+        return false;
+    fwrite(header, 1, sizeof(header), f);
+    fwrite(data, 1, bytes, f);
+    fclose(f);
+
+    bool ok = audioLoadWav(path, channel, clip);
+    remove(path);
+    return ok;
+}
+
+int main(void)
+{
+    for (int i = 0; i < SAMPLES; i++)
+        samples[i] = (int32_t)((i * 2654435761u) ^ (i << 7));
+    samples[0] = INT32_MAX;
+    samples[1] = INT32_MIN;
+    samples[2] = 0x00017FFF;    // Rounds down to 1
+    samples[3] = 0x00018000;    // Rounds up to 2
+
+    uint8_t packed[8];
+    wavPackSamples(samples, 4, 16, packed);
+    CHECK(packed[0] == 0xFF && packed[1] == 0x7F && packed[2] == 0x00 && packed[3] == 0x80,
+          "16-bit output saturates at both ends");
+    CHECK(packed[4] == 1 && packed[5] == 0 && packed[6] == 2 && packed[7] == 0, "16-bit output rounds to nearest");
+
+    audio_clip_t clip;
+    CHECK(roundTrip(32, 1, 0, &clip), "32-bit file loads");
+    CHECK(clip.count == SAMPLES && clip.sample_rate == 48000 &&
+          memcmp(clip.samples, samples, sizeof(samples)) == 0, "32-bit samples are exact");
+    audioFree(&clip);
+
+    CHECK(roundTrip(16, 1, 0, &clip), "16-bit file loads");
+    bool close = clip.count == SAMPLES;
+    for (size_t i = 4; close && i < SAMPLES; i++)
+    {
+        int64_t err = (int64_t)clip.samples[i] - samples[i];
+        close = err >= -0x8000 && err <= 0x8000;
+    }
+    CHECK(close, "16-bit samples within half an LSB");
+    audioFree(&clip);
+
+    // Stereo capture: interleaved [left, right] frames
+    CHECK(roundTrip(32, 2, 1, &clip), "stereo file loads");
+    bool right = clip.count == SAMPLES / 2;
+    for (size_t i = 0; right && i < SAMPLES / 2; i++)
+        right = clip.samples[i] == samples[2*i + 1];
+    CHECK(right, "stereo file's second channel is the odd samples");
+    audioFree(&clip);
+
+    return failures ? 1 : 0;
+}
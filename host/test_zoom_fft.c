@@ -0,0 +1,153 @@
+/*
+ * Zoom FFT build (USE_ZOOM_FFT): two tones 50 Hz apart get separate peaks,
+ * levels and detected frequencies are in the same dB and Hz as the full
+ * FFT, and what would alias onto the band is rejected.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "dsp_core.h"
+#include "test_check.h"
+#include "test_stream.h"
+
+static int32_t block[SAMPLE_BUFFER_SIZE];
+static float level[MAX_BAND_BINS];
+
+// Sum of sines of the given frequencies and amplitudes at capture sample n
+static int32_t toneSample(const float *freq_hz, const float *amplitude, int tones, long long n)
+{
+    double x = 0.0;
+    for (int t = 0; t < tones; t++)
+        x += amplitude[t] * sin(2.0 * M_PI * freq_hz[t] * n / I2S_SAMPLE_RATE_HZ);
+    return (int32_t)(x * 2147483647.0);
+}
+
+// Stream `seconds` of the tones and leave the band levels of the last frame in `level`
+static int spectrumOf(const float *freq_hz, const float *amplitude, int tones, float seconds, int *startBin)
+{
+    static dsp_spectrum_t spectrum;
+    long long n = 0;
+    int count = 0;
+
+    dspCoreReset();
+    for (int b = 0; b < (int)(seconds * I2S_SAMPLE_RATE_HZ) / SAMPLE_BUFFER_SIZE; b++)
+    {
+        for (int i = 0; i < SAMPLE_BUFFER_SIZE; i++, n++)
+            block[i] = toneSample(freq_hz, amplitude, tones, n);
+
+        const int32_t *samples = block;
+        int left = SAMPLE_BUFFER_SIZE;
+        while (left > 0)
+        {
+            int used = dspStreamPush(samples, left);
+            samples += used;
+            left -= used;
+
+            const int32_t *frame = dspStreamFrame();
+            if (frame == NULL)
+                continue;
+            dspComputeSpectrum(frame, &spectrum);
+            dspAnalyzeSpectrum(&spectrum, NULL);
+            count = dspSpectrumLevels(&spectrum, level, startBin);
+            dspStreamAdvance();
+        }
+    }
+    return count;
+}
+
+// Highest level within +-halfWidth bins of freq_hz
+static float peakNear(float freq_hz, int halfWidth, int startBin, int count, int *peakBin)
+{
+    int center = (int)(freq_hz / FREQ_RESO + 0.5f);
+    float peak = -500.0f;
+    for (int k = center - halfWidth; k <= center + halfWidth; k++)
+    {
+        if (k >= startBin && k < startBin + count && level[k - startBin] > peak)
+        {
+            peak = level[k - startBin];
+            *peakBin = k;
+        }
+    }
+    return peak;
+}
+
+// Count confirmed detections for a sine of the given frequency and amplitude
+static int runTone(float freq_hz, float amplitude, int *freqOut)
+{
+    int detections = 0;
+    long long n = 0;
+
+    dspCoreReset();
+    for (int b = 0; b < 6 * I2S_SAMPLE_RATE_HZ / SAMPLE_BUFFER_SIZE; b++)
+    {
+        for (int i = 0; i < SAMPLE_BUFFER_SIZE; i++, n++)
+            block[i] = n < LEAD_IN_SAMPLES ? 0 : toneSample(&freq_hz, &amplitude, 1, n);
+
+        dsp_detection_t result;
+        if (dspProcessBlock(block, SAMPLE_BUFFER_SIZE, &result))
+        {
+            detections++;
+            *freqOut = result.freq_hz;
+        }
+    }
+    return detections;
+}
+
+int main(void)
+{
+    CHECK(dspCoreInit(), "core init");
+    printf("      %d-point complex FFT at %.0f Hz: %.2f Hz bins %d..%d\n",
+           FFT_SIZE, (double)SAMPLE_RATE, FREQ_RESO, SPECTRUM_BASE_BIN, SPECTRUM_BASE_BIN + FFT_SIZE - 1);
+    CHECK(FREQ_RESO < 6.0f, "bins finer than 6 Hz");
+
+    // Alarm at 3.1 kHz next to machinery at 3.05 kHz, 6 dB louder
+    int startBin, alarmBin = 0, machineBin = 0, dipBin = 0;
+    const float freqs[2] = { 3100.0f, 3050.0f };
+    const float amps[2] = { 0.05f, 0.1f };
+    int count = spectrumOf(freqs, amps, 2, 0.5f, &startBin);
+    float alarm = peakNear(3100.0f, 2, startBin, count, &alarmBin);
+    float machine = peakNear(3050.0f, 2, startBin, count, &machineBin);
+    float dip = 0.0f;
+    for (int k = machineBin + 1; k < alarmBin; k++)
+    {
+        if (level[k - startBin] < dip)
+        {
+            dip = level[k - startBin];
+            dipBin = k;
+        }
+    }
+    printf("      3050 Hz %.1f dB at %.1f Hz, 3100 Hz %.1f dB at %.1f Hz, %.1f dB between at %.1f Hz\n",
+           machine, machineBin * FREQ_RESO, alarm, alarmBin * FREQ_RESO, dip, dipBin * FREQ_RESO);
+    CHECK(fabsf(alarmBin * FREQ_RESO - 3100.0f) <= FREQ_RESO && fabsf(machineBin * FREQ_RESO - 3050.0f) <= FREQ_RESO,
+          "each tone peaks in its own bin");
+    CHECK(dip < alarm - 20.0f, "tones 50 Hz apart are separated by a 20 dB dip");
+    CHECK(fabsf(alarm + 26.0f) < 2.0f && fabsf(machine + 20.0f) < 2.0f, "levels in dBFS as the full FFT");
+
+    // 4.5 kHz is one zoom rate above the centre: it would land on 3 kHz
+    const float alias = 4500.0f, full = 0.5f;
+    count = spectrumOf(&alias, &full, 1, 0.5f, &startBin);
+    float worst = -500.0f;
+    for (int i = 0; i < count; i++)
+        worst = fmaxf(worst, level[i]);
+    printf("      -6 dBFS at 4500 Hz: band peak %.1f dB\n", worst);
+    CHECK(worst < -90.0f, "tone one zoom rate away does not alias into the band");
+
+    int freq = 0;
+    CHECK(runTone(3100.0f, 0.1f, &freq) > 0 && abs(freq - 3100) <= (int)FREQ_RESO + 1,
+          "in-band tone is detected at its frequency");
+    CHECK(runTone(3100.0f, 0.0f, &freq) == 0, "silence is not detected");
+
+    // The band has to stay inside the zoom span
+    detector_config_t cfg;
+    detectorConfigDefaults(&cfg);
+    cfg.freq_start_hz = BAND_MIN_HZ - 10;
+    CHECK(!detectorConfigValid(&cfg), "band below the zoom span rejected");
+    cfg.freq_start_hz = 3000;
+    cfg.freq_end_hz = BAND_MAX_HZ + 10;
+    CHECK(!detectorConfigValid(&cfg), "band above the zoom span rejected");
+    cfg.freq_end_hz = 3200;
+    CHECK(detectorConfigValid(&cfg), "band within the zoom span accepted");
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,168 @@
+#include "alarm_journal.h"
+#include "config.h"
+#include "mem_plan.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <math.h>
+
+// TAG for logging
+static const char *TAG = "AlarmJournal";
+
+static journal_t journal;
+static SemaphoreHandle_t journalLock = NULL;    // NULL: journaling off
+static TaskHandle_t xJournalTaskHandle = NULL;
+
+// Static task and mutex storage (see mem_plan.h)
+static StackType_t journalStack[ALARM_JOURNAL_TASK_STACK];
+static StaticTask_t journalTaskBuffer;
+static StaticSemaphore_t journalLockBuffer;
+
+
+static bool partitionRead(void *ctx, uint32_t offset, void *data, size_t length)
+{
+    return esp_partition_read(ctx, offset, data, length) == ESP_OK;
+}
+
+static bool partitionWrite(void *ctx, uint32_t offset, const void *data, size_t length)
+{
+    return esp_partition_write(ctx, offset, data, length) == ESP_OK;
+}
+
+// A sector erase (~45 ms, hundreds worst case) turns the cache off. Only the
+// IRAM-safe capture ISR runs meanwhile, filling the internal-RAM ring, and
+// the DSP task catches up afterwards. An erase that outlasts the ring
+// (CAPTURE_RING_SLOTS blocks) drops blocks, which shows as a sequence gap.
+static bool partitionErase(void *ctx, uint32_t offset, size_t length)
+{
+    return esp_partition_erase_range(ctx, offset, length) == ESP_OK;
+}
+
+
+// Writes a batch when one fills, and whatever is buffered every interval
+static void vAlarmJournalTask(void *pvParameters)
+{
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(JOURNAL_FLUSH_INTERVAL_S * 1000));
+
+        xSemaphoreTake(journalLock, portMAX_DELAY);
+        int count = journal.pending_count;
+        bool ok = count == 0 || journalFlush(&journal);
+        xSemaphoreGive(journalLock);
+
+        if (!ok)
+            ESP_LOGW(TAG, "Flush of %d records failed, retrying later", count);
+    }
+}
+
+
+void vAlarmJournalStart(void)
+{
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ALARM_JOURNAL_SUBTYPE,
+                                                           ALARM_JOURNAL_PARTITION);
+    if (part == NULL)
+    {
+        ESP_LOGW(TAG, "No '%s' partition, alarm events are not journaled", ALARM_JOURNAL_PARTITION);
+        return;
+    }
+
+    journal_flash_t flash = {
+        .read = partitionRead,
+        .write = partitionWrite,
+        .erase = partitionErase,
+        .ctx = (void *)part,
+        .size = part->size,
+        .sector_size = part->erase_size,
+    };
+    if (!journalMount(&journal, &flash))
+    {
+        ESP_LOGE(TAG, "Failed to mount the journal");
+        return;
+    }
+    ESP_LOGI(TAG, "Boot %u, records %lu..%lu", journal.boot,
+             (unsigned long)journalFirstSeq(&journal), (unsigned long)(journal.next_seq - 1));
+
+    journalLock = xSemaphoreCreateMutexStatic(&journalLockBuffer);
+    xJournalTaskHandle = xTaskCreateStaticPinnedToCore(
+        vAlarmJournalTask,              // Task function
+        ALARM_JOURNAL_TASK_NAME,        // Name
+        ALARM_JOURNAL_TASK_STACK,       // Stack size
+        NULL,                           // Parameters
+        ALARM_JOURNAL_TASK_PRIORITY,    // Priority
+        journalStack,                   // Stack
+        &journalTaskBuffer,             // Task control block
+        NOTIFY_TASK_CORE                // Core
+    );
+
+    vMemPlanAdd("journal", "journal state", &journal, sizeof(journal));
+    vMemPlanAdd("journal", "task stack", journalStack, sizeof(journalStack));
+}
+
+
+void vAlarmJournalRecord(const web_event_t *event)
+{
+    if (journalLock == NULL)
+        return;
+
+    static const uint8_t types[] = {
+        [EVENT_ALARM_START]   = JOURNAL_ALARM_START,
+        [EVENT_ALARM_ONGOING] = JOURNAL_ALARM_ONGOING,
+        [EVENT_ALARM_CLEAR]   = JOURNAL_ALARM_CLEAR,
+    };
+    float peak = event->peak_db < INT8_MIN + 1 ? INT8_MIN + 1 : event->peak_db > 0.0f ? 0.0f : event->peak_db;
+
+    journal_record_t record = {
+        .time_ms = (uint32_t)event->timestamp_ms,
+        .type = types[event->type],
+        .pattern = (uint8_t)event->pattern,
+        .freq_hz = (uint16_t)event->bin,
+        .peak_db = (int8_t)lrintf(peak),
+    };
+
+    xSemaphoreTake(journalLock, portMAX_DELAY);
+    bool full = journalAppend(&journal, &record);
+    xSemaphoreGive(journalLock);
+
+    if (full && xJournalTaskHandle != NULL)
+        xTaskNotifyGive(xJournalTaskHandle);
+}
+
+
+int xAlarmJournalRead(uint32_t after_seq, journal_record_t *out, int max)
+{
+    if (journalLock == NULL)
+        return -1;
+
+    xSemaphoreTake(journalLock, portMAX_DELAY);
+    int count = journalRead(&journal, after_seq, out, max);
+    xSemaphoreGive(journalLock);
+    return count;
+}
+
+
+uint32_t uxAlarmJournalSeqBefore(uint16_t boot, uint32_t time_ms)
+{
+    if (journalLock == NULL)
+        return 0;
+
+    xSemaphoreTake(journalLock, portMAX_DELAY);
+    uint32_t seq = journalSeqBefore(&journal, boot, time_ms);
+    xSemaphoreGive(journalLock);
+    return seq;
+}
+
+
+void vAlarmJournalInfo(uint32_t *first_seq, uint16_t *boot)
+{
+    *first_seq = 0;
+    *boot = 0;
+    if (journalLock == NULL)
+        return;
+
+    xSemaphoreTake(journalLock, portMAX_DELAY);
+    *first_seq = journalFirstSeq(&journal);
+    *boot = journal.boot;
+    xSemaphoreGive(journalLock);
+}
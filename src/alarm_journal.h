@@ -0,0 +1,48 @@
+#pragma once
+
+/*
+ * Alarm audit trail: web events appended to the event journal in the
+ * "journal" data partition (see partitions.csv). Appends only touch RAM;
+ * the journal task writes a batch when it fills or every
+ * JOURNAL_FLUSH_INTERVAL_S, so flash erases never run in the alarm path.
+ */
+
+#include <stdint.h>
+#include "event_journal.h"
+#include "web_server.h"
+
+#define ALARM_JOURNAL_PARTITION     "journal"
+#define ALARM_JOURNAL_SUBTYPE       0x40        // Custom data subtype in partitions.csv
+
+// Flush task config (core: NOTIFY_TASK_CORE, below the spectrum stream)
+#define ALARM_JOURNAL_TASK_NAME     "AlarmJournal"
+#define ALARM_JOURNAL_TASK_STACK    3072
+#define ALARM_JOURNAL_TASK_PRIORITY (NOTIFY_TASK_PRIORITY - 2)
+
+/**
+ * @brief Mount the journal partition (writes this boot's record) and start
+ *        the flush task. Without the partition, journaling stays off.
+ */
+void vAlarmJournalStart(void);
+
+/**
+ * @brief Append one event; never blocks on flash
+ */
+void vAlarmJournalRecord(const web_event_t *event);
+
+/**
+ * @brief Records with seq > after_seq, oldest first
+ *
+ * @return number of records written to `out`, -1 if journaling is off
+ */
+int xAlarmJournalRead(uint32_t after_seq, journal_record_t *out, int max);
+
+/**
+ * @brief Cursor for records of `boot` from `time_ms` on (see journalSeqBefore)
+ */
+uint32_t uxAlarmJournalSeqBefore(uint16_t boot, uint32_t time_ms);
+
+/**
+ * @brief Oldest stored seq and the current boot number
+ */
+void vAlarmJournalInfo(uint32_t *first_seq, uint16_t *boot);
@@ -0,0 +1,18 @@
+#pragma once
+
+// Audio format shared by the I2S capture path and the DSP core.
+// Kept free of ESP-IDF headers so the DSP core also builds on the host.
+
+#define I2S_SAMPLE_RATE_HZ    48000.0f   // Match your mic specs
+
+// Microphones on the I2S bus: 1 = one INMP441 (L/R to GND, left slot), 2 = a
+// pair sharing the data line (L/R to GND on one, to VDD on the other). Capture
+// blocks then hold interleaved [left, right] frames; the DSP task splits them
+// and fuses the two band spectra per bin, so detection runs once per unit.
+#ifndef CAPTURE_CHANNELS
+#define CAPTURE_CHANNELS      1
+#endif
+
+// Capture block handed to the DSP task. Should not exceed the analysis hop,
+// otherwise overlapping frames arrive in bursts rather than every hop.
+#define SAMPLE_BUFFER_SIZE    1024     // Number of samples per capture block (per channel)
@@ -0,0 +1,247 @@
+#include "audio_recorder.h"
+#include "wav_format.h"
+#include "mem_plan.h"
+#include "config.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// TAG for logging
+static const char *TAG = "Capture";
+
+// Time without a block before the capture gives up (capture stopped)
+#define BLOCK_TIMEOUT_MS    1000
+#define BLOCK_POLL_MS       10
+
+PSRAM_BSS static audio_block_t recorderBlocks[RECORDER_RING_SLOTS];
+static spsc_ring_t recorderRing;
+
+// Recording state: armed by the handler, fed by the DSP task
+static bool armed = false;              // Producer copies blocks while set
+static bool feeding = false;            // Producer is inside vAudioRecorderFeed
+static bool busy = false;               // A recording is set up or streaming
+static bool started = false;            // Producer side: first block seen
+static uint32_t endSeq = 0;             // Producer side: first block not recorded
+static uint32_t wantBlocks = 0;
+
+// The request being streamed, handed from the httpd task to the capture task
+static httpd_req_t *captureReq = NULL;
+static int captureBits = 16;
+
+// Static task storage and output buffer (see mem_plan.h)
+static StackType_t captureStack[CAPTURE_TASK_STACK];
+static StaticTask_t captureTaskBuffer;
+static TaskHandle_t xCaptureTaskHandle = NULL;
+static uint8_t packed[CAPTURE_BLOCK_VALUES * sizeof(int32_t)];
+static const int32_t silence[CAPTURE_BLOCK_VALUES];
+
+
+// Copy one block into the ring while armed
+static void feedArmed(const audio_block_t *block)
+{
+    // The recording spans wantBlocks capture blocks from the first one seen
+    if (!started)
+    {
+        started = true;
+        endSeq = block->seq + wantBlocks;
+    }
+    if ((int32_t)(block->seq - endSeq) >= 0)
+    {
+        __atomic_store_n(&armed, false, __ATOMIC_RELEASE);
+        return;
+    }
+
+    // Full ring: the block is skipped and streamed as silence
+    audio_block_t *slot = spscRingReserve(&recorderRing);
+    if (slot != NULL)
+    {
+        memcpy(slot, block, sizeof(*slot));
+        spscRingCommit(&recorderRing);
+    }
+}
+
+void vAudioRecorderFeed(const audio_block_t *block)
+{
+    // feeding is raised before armed is read, and the capture task clears
+    // armed before it reads feeding: once it sees feeding clear after
+    // disarming, no copy is in progress and none will start
+    __atomic_store_n(&feeding, true, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&armed, __ATOMIC_SEQ_CST))
+        feedArmed(block);
+    __atomic_store_n(&feeding, false, __ATOMIC_RELEASE);
+}
+
+
+// Next recorded block, waiting up to BLOCK_TIMEOUT_MS; NULL at once when
+// the producer has finished and the ring is empty
+static const audio_block_t *nextBlock(bool *finished)
+{
+    for (int waited = 0; waited < BLOCK_TIMEOUT_MS; waited += BLOCK_POLL_MS)
+    {
+        bool done = !__atomic_load_n(&armed, __ATOMIC_ACQUIRE);
+        const audio_block_t *block = spscRingPeek(&recorderRing);
+        if (block != NULL || done)
+        {
+            *finished = done;
+            return block;
+        }
+        vTaskDelay(pdMS_TO_TICKS(BLOCK_POLL_MS));
+    }
+    *finished = false;
+    return NULL;
+}
+
+static esp_err_t sendSamples(httpd_req_t *req, const int32_t *samples)
+{
+    int bytes = wavPackSamples(samples, CAPTURE_BLOCK_VALUES, captureBits, packed);
+    return httpd_resp_send_chunk(req, (const char *)packed, bytes);
+}
+
+// Stream wantBlocks blocks, oldest first, filling gaps in seq with silence
+static esp_err_t streamRecording(httpd_req_t *req)
+{
+    uint8_t header[WAV_HEADER_SIZE];
+    uint32_t dataBytes = wantBlocks * CAPTURE_BLOCK_VALUES * (captureBits / 8);
+    wavHeader(header, (uint32_t)I2S_SAMPLE_RATE_HZ, captureBits, CAPTURE_CHANNELS, dataBytes);
+
+    esp_err_t ret = httpd_resp_send_chunk(req, (const char *)header, sizeof(header));
+    uint32_t sent = 0, gaps = 0, expected = 0;
+
+    while (ret == ESP_OK && sent < wantBlocks)
+    {
+        bool finished;
+        const audio_block_t *block = nextBlock(&finished);
+        if (block == NULL && finished)
+        {
+            // The last blocks were lost
+            for (; ret == ESP_OK && sent < wantBlocks; sent++, gaps++)
+                ret = sendSamples(req, silence);
+            break;
+        }
+        if (block == NULL)
+        {
+            ESP_LOGW(TAG, "No audio for %d ms, capture cut at %lu blocks", BLOCK_TIMEOUT_MS, (unsigned long)sent);
+            ret = ESP_FAIL;
+            break;
+        }
+
+        if (sent == 0)
+            expected = block->seq;
+        for (; ret == ESP_OK && expected != block->seq && sent < wantBlocks; expected++, sent++, gaps++)
+            ret = sendSamples(req, silence);
+
+        if (ret == ESP_OK && sent < wantBlocks)
+        {
+            ret = sendSamples(req, block->samples);
+            expected++;
+            sent++;
+        }
+        spscRingRelease(&recorderRing);
+    }
+
+    if (ret == ESP_OK)
+        ret = httpd_resp_send_chunk(req, NULL, 0);
+    if (gaps > 0)
+        ESP_LOGW(TAG, "%lu of %lu blocks lost, sent as silence", (unsigned long)gaps, (unsigned long)wantBlocks);
+    return ret;
+}
+
+
+static void vAudioCaptureTask(void *pvParameters)
+{
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        httpd_req_t *req = captureReq;
+        esp_err_t ret = streamRecording(req);
+        ESP_LOGI(TAG, "Capture of %lu blocks %s", (unsigned long)wantBlocks, ret == ESP_OK ? "sent" : "failed");
+
+        // Stop the producer, wait out a copy in progress, and empty the ring
+        __atomic_store_n(&armed, false, __ATOMIC_SEQ_CST);
+        httpd_req_async_handler_complete(req);
+        while (__atomic_load_n(&feeding, __ATOMIC_SEQ_CST))
+            vTaskDelay(1);
+        while (spscRingPeek(&recorderRing) != NULL)
+            spscRingRelease(&recorderRing);
+
+        __atomic_store_n(&busy, false, __ATOMIC_RELEASE);
+    }
+}
+
+
+esp_err_t capture_get_handler(httpd_req_t *req)
+{
+    char params[48] = "";
+    char value[8];
+    int seconds = 5, bits = 16;
+
+    size_t query_len = httpd_req_get_url_query_len(req);
+    if (query_len > 0 && query_len < sizeof(params))
+        httpd_req_get_url_query_str(req, params, sizeof(params));
+    if (httpd_query_key_value(params, "seconds", value, sizeof(value)) == ESP_OK)
+        seconds = atoi(value);
+    if (httpd_query_key_value(params, "bits", value, sizeof(value)) == ESP_OK)
+        bits = atoi(value);
+
+    if (query_len >= sizeof(params) || seconds < 1 || seconds > CAPTURE_MAX_SECONDS || (bits != 16 && bits != 32))
+    {
+        char msg[64];
+        snprintf(msg, sizeof(msg), "Use ?seconds=1..%d&bits=16|32", CAPTURE_MAX_SECONDS);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, msg);
+        return ESP_OK;
+    }
+
+    bool idle = false;
+    if (xCaptureTaskHandle == NULL || !__atomic_compare_exchange_n(&busy, &idle, true, false,
+                                                                    __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+    {
+        httpd_resp_set_status(req, "409 Conflict");
+        httpd_resp_send(req, "Capture already running", HTTPD_RESP_USE_STRLEN);
+        return ESP_OK;
+    }
+
+    httpd_req_t *async = NULL;
+    if (httpd_req_async_handler_begin(req, &async) != ESP_OK)
+    {
+        __atomic_store_n(&busy, false, __ATOMIC_RELEASE);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Cannot start capture");
+        return ESP_OK;
+    }
+
+    httpd_resp_set_type(async, "audio/wav");
+    httpd_resp_set_hdr(async, "Content-Disposition", "attachment; filename=\"capture.wav\"");
+
+    // The producer is idle and the ring empty: set up, then arm
+    wantBlocks = ((uint32_t)seconds * (uint32_t)I2S_SAMPLE_RATE_HZ + SAMPLE_BUFFER_SIZE - 1) / SAMPLE_BUFFER_SIZE;
+    captureBits = bits;
+    captureReq = async;
+    started = false;
+    __atomic_store_n(&armed, true, __ATOMIC_RELEASE);
+
+    ESP_LOGI(TAG, "Recording %d s at %d bits", seconds, bits);
+    xTaskNotifyGive(xCaptureTaskHandle);
+    return ESP_OK;
+}
+
+
+void vAudioRecorderStart(void)
+{
+    spscRingInit(&recorderRing, recorderBlocks, sizeof(audio_block_t), RECORDER_RING_SLOTS);
+
+    xCaptureTaskHandle = xTaskCreateStaticPinnedToCore(
+        vAudioCaptureTask,          // Task function
+        CAPTURE_TASK_NAME,          // Name
+        CAPTURE_TASK_STACK,         // Stack size
+        NULL,                       // Parameters
+        CAPTURE_TASK_PRIORITY,      // Priority
+        captureStack,               // Stack
+        &captureTaskBuffer,         // Task control block
+        NOTIFY_TASK_CORE            // Core
+    );
+
+    vMemPlanAdd("capture", "recorder ring", recorderBlocks, sizeof(recorderBlocks));
+    vMemPlanAdd("capture", "recorder task stack", captureStack, sizeof(captureStack));
+    vMemPlanAdd("capture", "wav chunk buffer", packed, sizeof(packed));
+}
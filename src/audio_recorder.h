@@ -0,0 +1,38 @@
+#pragma once
+
+/*
+ * On-demand raw capture over GET /capture?seconds=N&bits=16|32. The DSP
+ * task copies each capture block into a PSRAM ring while a recording is
+ * armed (one memcpy per block, nothing when idle); the capture task streams
+ * the ring as a chunked WAV file on an async request, so httpd keeps
+ * serving meanwhile. Blocks lost on the way (capture drops, or the client
+ * falling more than the ring behind) are sent as silence, so the file
+ * keeps its timing. One recording at a time. Stereo captures
+ * (CAPTURE_CHANNELS 2) are stereo files.
+ */
+
+#include "esp_http_server.h"
+#include "i2s_config.h"
+
+// PSRAM ring between the DSP task and the capture task (power of 2, ~2.7 s)
+#define RECORDER_RING_SLOTS     128
+
+// Capture task config (core: NOTIFY_TASK_CORE, lowest of the web tasks)
+#define CAPTURE_TASK_NAME       "AudioCapture"
+#define CAPTURE_TASK_STACK      3072
+#define CAPTURE_TASK_PRIORITY   1
+
+/**
+ * @brief Set up the ring and start the capture task
+ */
+void vAudioRecorderStart(void);
+
+/**
+ * @brief Offer one capture block (DSP task, in capture order)
+ */
+void vAudioRecorderFeed(const audio_block_t *block);
+
+/**
+ * @brief HTTP handler for GET /capture
+ */
+esp_err_t capture_get_handler(httpd_req_t *req);
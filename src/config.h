@@ -14,16 +14,146 @@
 /* -----------------------------
  * FFT / Audio Processing
  * ----------------------------- */
+// Band, threshold, SNR, window and long/short window are boot defaults: a
+// configuration stored through POST /config replaces them without a rebuild.
+// The engine switches may also be given with -D (the host benchmark builds each).
+
 // Use long-window FFT (4-second) or short-window FFT
 #define USE_LONG_WINDOW   0   // 1 = long-window, 0 = short-window
 
+// Long-window decisions: once per 4 s block, or every 0.5 s on the latest 4 s
+#ifndef LONG_WINDOW_SLIDING
+#define LONG_WINDOW_SLIDING 0 // 1 = sliding (8 steps per window), 0 = tumbling
+#endif
+
+// Analysis rate: an anti-alias FIR low-passes the capture and keeps every
+// Nth sample before framing, so the FFT spans 0..rate/2/N only. FFT_SIZE
+// shrinks by the same factor: bin spacing (11.7 Hz) and frame length (85 ms)
+// stay as at the capture rate. The band must stay below the new Nyquist.
+#define DECIMATION_FACTOR     4     // 1 = off, 2, 4 (48 kHz -> 12 kHz) or 8
+#define DECIMATION_TAPS       64    // Anti-alias FIR length, multiple of 4 (up to 128)
+#define DECIMATION_CUTOFF_HZ  6000  // -6 dB point; aliases of the band (rate/N - band) must land above it in the stop band
+#define DECIMATION_WINDOW     WINDOW_BLACKMAN_HARRIS  // FIR design window (any WINDOW_TYPE value)
+
+// Overlap between consecutive analysis frames; the FFT runs every hop of
+// FFT_SIZE * (100 - FRAME_OVERLAP_PCT) / 100 samples on the latest FFT_SIZE samples
+#define FRAME_OVERLAP_PCT 75  // 0 = disjoint frames, 50 or 75 (%)
+
+// FFT algorithm for the real-valued microphone signal
+#define USE_REAL_FFT      1   // 1 = N/2 complex FFT + split (half the work), 0 = full complex FFT
+
+// Spectrum engine: full FFT, or a Goertzel filter bank over the detection band
+// only. The bank filters each hop once and windows per bin, so with overlapping
+// frames it costs one hop of filtering per frame: about the FFT's cost for the
+// 44-bin default band, less for narrower bands, more for wider ones.
+#ifndef USE_GOERTZEL
+#define USE_GOERTZEL      0   // 1 = Goertzel bank (BIN_START..BIN_END), 0 = FFT
+#endif
+
+// Zoom FFT: mix the capture down around ZOOM_CENTER_HZ, low-pass and decimate
+// it straight to a complex stream of I2S rate / ZOOM_DECIMATION, and transform
+// only that span: 1500 Hz / 256 = 5.9 Hz bins, as fine as an 8192-point FFT
+// at the capture rate, for a 256-point complex FFT. Neighbouring tones 50 Hz
+// apart get separate peaks. Frames are longer by the same factor (171 ms), so
+// confirmation takes longer and T4's 100 ms pulses are shorter than a frame.
+// Replaces DECIMATION_*; not with USE_GOERTZEL or USE_FIXED_POINT.
+#ifndef USE_ZOOM_FFT
+#define USE_ZOOM_FFT      0   // 1 = zoom FFT over ZOOM_CENTER_HZ +- ZOOM_SPAN_HZ / 2, 0 = whole spectrum
+#endif
+#define ZOOM_CENTER_HZ    3000  // Middle of the zoom spectrum; the band must lie within ZOOM_SPAN_HZ of it
+#define ZOOM_SPAN_HZ      700   // Flat part of the zoom filter (0.03 dB), the widest band it can analyze
+#define ZOOM_DECIMATION   32    // 48 kHz -> 1500 Hz complex
+#define ZOOM_FFT_SIZE     256   // Complex points, power of 2; 512 halves the bins again (341 ms frames)
+#define ZOOM_TAPS         384   // Band-shifting FIR length, multiple of 4 (up to 384)
+#define ZOOM_CUTOFF_HZ    700   // -6 dB point from the centre; span aliases (rate - span / 2) land 86 dB down
+
+// Arithmetic for the detection pipeline. Fixed point block-scales each frame
+// into Q15, runs the S3's sc16 FFT and thresholds band power as integers;
+// frame and window buffers are half the size of the float path's.
+#ifndef USE_FIXED_POINT
+#define USE_FIXED_POINT   0   // 1 = Q15 (always real FFT, not with USE_GOERTZEL), 0 = float
+#endif
+
+// Analysis window: WINDOW_HAMMING, WINDOW_HANN, WINDOW_BLACKMAN_HARRIS, WINDOW_FLAT_TOP
+#define WINDOW_TYPE       WINDOW_HAMMING
+
 // Frequency range for fire alarm detection (in Hz)
 #define Freq_START_HZ    2750  // Start frequency in Hz
 #define Freq_END_HZ      3250  // End frequency in Hz
+#define MAX_BAND_HZ      1000  // Widest band the runtime configuration may select; sizes the per-bin state
 
 // Threshold for detection in decibels
 #define THRESHOLD_DB     -40.0f  // dB threshold for detection
 
+// Adaptive threshold: track each band bin's noise floor and detect a bin that
+// rises NOISE_FLOOR_SNR_DB above it; THRESHOLD_DB is then not used
+#ifndef USE_NOISE_FLOOR
+#define USE_NOISE_FLOOR        1      // 1 = SNR above tracked floor, 0 = fixed THRESHOLD_DB
+#endif
+#define NOISE_FLOOR_SNR_DB     15.0f  // Required rise above the floor
+#define NOISE_FLOOR_MIN_DB     -70.0f // Never detect below this level, however quiet the room
+#define NOISE_FLOOR_WINDOW_S   8.0f   // Floor is the quietest level seen over this long
+
+// Energy gate: a band-pass biquad and the frame's mean power decide, before
+// the transform, whether a frame can hold anything detection would accept.
+// Frames GATE_MARGIN_DB below the lowest detectable level (NOISE_FLOOR_MIN_DB,
+// or THRESHOLD_DB) skip the spectrum stage and count as silence. Every
+// GATE_AUDIT_EVERY-th such frame is transformed anyway; a tone found in one
+// is a gate miss (/metrics gate_misses_total).
+#ifndef USE_ENERGY_GATE
+#define USE_ENERGY_GATE        1      // 1 = skip the FFT on quiet frames, 0 = transform every frame
+#endif
+#define GATE_MARGIN_DB         10.0f  // Gate opens this far below the detection level; a band-edge tone reads 3 dB low
+#define GATE_AUDIT_EVERY       64     // Transform every Nth gated frame to check the gate (0 = never)
+
+// Alarm cadence templates in ms: { on, off between pulses, pulses per group, pause after group }
+#define CADENCE_T3_TEMPLATE     { 500, 500, 3, 1500 }   // Smoke / fire (temporal-three)
+#define CADENCE_T4_TEMPLATE     { 100, 100, 4, 5000 }   // CO (temporal-four); needs gaps longer than one frame
+#define CADENCE_TOLERANCE_MS    100   // Allowed timing error, plus 10% of each duration
+#define CADENCE_CONFIRM_CYCLES  2     // Consecutive groups before the pattern is reported
+
+// Alarm events: one at the start, a status while it lasts, one when it clears
+#define ALARM_ONGOING_INTERVAL_S 30   // Status period while an alarm lasts
+#define ALARM_CLEAR_HOLD_S       10   // Quiet time before an alarm clears; longer than any cadence pause
+
+/* -----------------------------
+ * Task Placement
+ * ----------------------------- */
+// Core (0, 1 or tskNO_AFFINITY) and FreeRTOS priority of each pipeline stage.
+// Wi-Fi and lwIP are pinned to core 0 in sdkconfig and the HTTP server and
+// other network-side tasks run on NOTIFY_TASK_CORE, so audio defaults to core 1.
+#define CAPTURE_CORE            1     // Core that services the I2S DMA interrupt
+#define DSP_TASK_CORE           1     // Window + FFT, once per hop
+#define DSP_TASK_PRIORITY       5
+#define DETECT_TASK_CORE        1     // Threshold / noise floor, confirmation, cadence
+#define DETECT_TASK_PRIORITY    6     // Short; runs as soon as a spectrum is queued
+#define NOTIFY_TASK_CORE        0     // Formats and sends alarms next to the network stack
+#define NOTIFY_TASK_PRIORITY    3
+
+// Log per-stage run time (runs, mean, max, CPU share) every N seconds; 0 = off
+#define STAGE_REPORT_INTERVAL_S 10
+
+/* -----------------------------
+ * Live Spectrum Stream
+ * ----------------------------- */
+// Band spectrum over the /spectrum WebSocket; each client picks its rate
+// (?rate=Hz) and range (?from=Hz&to=Hz) up to these limits
+#define SPECTRUM_DEFAULT_RATE_HZ 5
+#define SPECTRUM_MAX_RATE_HZ     20    // Analysis runs at ~47 frames/s
+
+/* -----------------------------
+ * Event Journal
+ * ----------------------------- */
+// Alarm events are buffered in RAM and written to the journal partition in
+// batches; a reset loses at most this much of the trail
+#define JOURNAL_FLUSH_INTERVAL_S 10
+
+/* -----------------------------
+ * Audio Capture
+ * ----------------------------- */
+// GET /capture?seconds=N&bits=16|32 streams raw audio as WAV while it records
+#define CAPTURE_MAX_SECONDS      300
+
 /*************************************************************
  *                      END OF CONFIG                         *
  *************************************************************/
@@ -0,0 +1,88 @@
+#include "config_store.h"
+#include "esp_log.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+#include <stdint.h>
+
+// TAG for logging
+static const char *TAG = "ConfigStore";
+
+typedef struct {
+    uint16_t version;
+    uint16_t size;
+    detector_config_t config;
+} stored_config_t;
+
+
+// NVS may be opened before Wi-Fi initializes it; a second init is a no-op
+static esp_err_t initFlash(void)
+{
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    return ret;
+}
+
+
+esp_err_t xConfigStoreLoad(detector_config_t *cfg)
+{
+    esp_err_t ret = initFlash();
+    if (ret != ESP_OK)
+        return ret;
+
+    nvs_handle_t handle;
+    ret = nvs_open(CONFIG_STORE_NAMESPACE, NVS_READONLY, &handle);
+    if (ret != ESP_OK)
+        return ret == ESP_ERR_NVS_NOT_FOUND ? ESP_ERR_NOT_FOUND : ret;
+
+    stored_config_t stored;
+    size_t length = sizeof(stored);
+    ret = nvs_get_blob(handle, CONFIG_STORE_KEY, &stored, &length);
+    nvs_close(handle);
+
+    if (ret == ESP_ERR_NVS_NOT_FOUND)
+        return ESP_ERR_NOT_FOUND;
+    if (ret != ESP_OK && ret != ESP_ERR_NVS_INVALID_LENGTH)
+        return ret;
+
+    if (ret == ESP_ERR_NVS_INVALID_LENGTH || length != sizeof(stored) ||
+        stored.version != CONFIG_STORE_VERSION || stored.size != sizeof(stored.config) ||
+        !detectorConfigValid(&stored.config))
+    {
+        ESP_LOGW(TAG, "Ignoring stored config (version %u)", ret == ESP_OK ? stored.version : 0);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    *cfg = stored.config;
+    return ESP_OK;
+}
+
+
+esp_err_t xConfigStoreSave(const detector_config_t *cfg)
+{
+    esp_err_t ret = initFlash();
+    if (ret != ESP_OK)
+        return ret;
+
+    nvs_handle_t handle;
+    ret = nvs_open(CONFIG_STORE_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK)
+        return ret;
+
+    stored_config_t stored = {
+        .version = CONFIG_STORE_VERSION,
+        .size = sizeof(stored.config),
+        .config = *cfg,
+    };
+    ret = nvs_set_blob(handle, CONFIG_STORE_KEY, &stored, sizeof(stored));
+    if (ret == ESP_OK)
+        ret = nvs_commit(handle);
+    nvs_close(handle);
+
+    if (ret != ESP_OK)
+        ESP_LOGE(TAG, "Failed to store config: %s", esp_err_to_name(ret));
+    return ret;
+}
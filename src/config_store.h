@@ -0,0 +1,27 @@
+#pragma once
+
+/*
+ * Detector configuration persisted in NVS, so a change made through
+ * POST /config survives a reboot. The blob carries a version; one written
+ * by a different layout is ignored and the config.h defaults stay.
+ */
+
+#include "esp_err.h"
+#include "dsp_config.h"
+
+#define CONFIG_STORE_NAMESPACE  "detector"
+#define CONFIG_STORE_KEY        "config"
+#define CONFIG_STORE_VERSION    1
+
+/**
+ * @brief Read the stored configuration into `cfg`
+ *
+ * @return ESP_ERR_NOT_FOUND if none is stored or it has another version or
+ *         fails detectorConfigValid (cfg unchanged)
+ */
+esp_err_t xConfigStoreLoad(detector_config_t *cfg);
+
+/**
+ * @brief Store `cfg` (already validated) and commit
+ */
+esp_err_t xConfigStoreSave(const detector_config_t *cfg);
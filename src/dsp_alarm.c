@@ -0,0 +1,92 @@
+#include "dsp_alarm.h"
+#include "config.h"
+
+static const char *phaseNames[] = {
+    [ALARM_START]   = "start",
+    [ALARM_ONGOING] = "ongoing",
+    [ALARM_CLEAR]   = "clear",
+};
+
+static struct {
+    bool active;
+    int64_t last_ms;            // Latest confirmation
+    int64_t next_status_ms;     // When the next ALARM_ONGOING is due
+    alarm_report_t stats;
+} alarm;
+
+
+void alarmReset(void)
+{
+    alarm.active = false;
+}
+
+
+static bool report(alarm_phase_t phase, alarm_report_t *out)
+{
+    alarm.stats.phase = phase;
+    alarm.stats.duration_ms = alarm.last_ms - alarm.stats.start_ms;
+    *out = alarm.stats;
+    return true;
+}
+
+
+bool alarmUpdate(const dsp_detection_t *detection, int64_t now_ms, alarm_report_t *out)
+{
+    bool confirmed = detection->detected || detection->pattern != CADENCE_NONE;
+
+    if (!alarm.active)
+    {
+        if (!confirmed)
+            return false;
+
+        alarm.active = true;
+        alarm.last_ms = now_ms;
+        alarm.next_status_ms = now_ms + ALARM_ONGOING_INTERVAL_S * 1000LL;
+        alarm.stats.start_ms = now_ms;
+        alarm.stats.freq_hz = detection->freq_hz;
+        alarm.stats.peak_db = detection->peak_db;
+        alarm.stats.pattern = detection->pattern;
+        alarm.stats.confirmations = 1;
+        return report(ALARM_START, out);
+    }
+
+    // Any frame with the tone on counts for the level, confirmed or not
+    if (detection->tone_on && detection->peak_db > alarm.stats.peak_db)
+    {
+        alarm.stats.peak_db = detection->peak_db;
+        alarm.stats.freq_hz = detection->freq_hz;
+    }
+
+    bool newPattern = false;
+    if (confirmed)
+    {
+        alarm.last_ms = now_ms;
+        alarm.stats.confirmations++;
+        if (detection->pattern != CADENCE_NONE && detection->pattern != alarm.stats.pattern)
+        {
+            alarm.stats.pattern = detection->pattern;
+            newPattern = true;
+        }
+    }
+
+    // Hysteresis: longer than any cadence pause, so a pulsed alarm stays one alarm
+    if (now_ms - alarm.last_ms >= ALARM_CLEAR_HOLD_S * 1000LL)
+    {
+        alarm.active = false;
+        return report(ALARM_CLEAR, out);
+    }
+
+    if (newPattern || now_ms >= alarm.next_status_ms)
+    {
+        alarm.next_status_ms = now_ms + ALARM_ONGOING_INTERVAL_S * 1000LL;
+        return report(ALARM_ONGOING, out);
+    }
+
+    return false;
+}
+
+
+const char *alarmPhaseName(alarm_phase_t phase)
+{
+    return (unsigned)phase <= ALARM_CLEAR ? phaseNames[phase] : "unknown";
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+/*
+ * Alarm lifecycle over per-frame detections. The first confirmation starts
+ * an alarm; further confirmations only update its statistics. While it
+ * lasts, a status is reported every ALARM_ONGOING_INTERVAL_S (and at once
+ * when a cadence is first recognized); it clears once nothing confirmed for
+ * ALARM_CLEAR_HOLD_S. A continuous tone thus yields a handful of events
+ * instead of one per confirmation.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "dsp_core.h"
+
+typedef enum {
+    ALARM_START,
+    ALARM_ONGOING,
+    ALARM_CLEAR,
+} alarm_phase_t;
+
+// State of the current alarm when an event is reported
+typedef struct {
+    alarm_phase_t phase;
+    int64_t start_ms;           // Time of the first confirmation
+    int64_t duration_ms;        // First to latest confirmation
+    int freq_hz;                // Dominant frequency: that of the loudest tone frame
+    float peak_db;              // Loudest tone frame so far
+    cadence_pattern_t pattern;  // Latest recognized cadence, or CADENCE_NONE
+    uint32_t confirmations;     // Confirmed frames so far
+} alarm_report_t;
+
+/**
+ * @brief Forget any active alarm
+ */
+void alarmReset(void);
+
+/**
+ * @brief Feed the detection of the next frame, in frame order
+ *
+ * @param now_ms frame time in ms (any monotonic origin)
+ * @return true if an event is due; `report` is only written then
+ */
+bool alarmUpdate(const dsp_detection_t *detection, int64_t now_ms, alarm_report_t *report);
+
+const char *alarmPhaseName(alarm_phase_t phase);
@@ -0,0 +1,175 @@
+#include "dsp_cadence.h"
+#include "config.h"
+#include <math.h>
+#include <string.h>
+
+static const cadence_template_t templates[CADENCE_COUNT] = {
+    [CADENCE_T3] = CADENCE_T3_TEMPLATE,
+    [CADENCE_T4] = CADENCE_T4_TEMPLATE,
+};
+
+static const char *cadenceNames[CADENCE_COUNT] = {
+    [CADENCE_NONE] = "none",
+    [CADENCE_T3]   = "T3",
+    [CADENCE_T4]   = "T4",
+};
+
+// Accepted run lengths in hops, built by cadenceInit
+typedef struct {
+    uint16_t on_min, on_max;
+    uint16_t off_min, off_max;
+    uint16_t pause_min, pause_max;
+} cadence_limits_t;
+
+// Progress through one template
+typedef struct {
+    uint8_t pulses;         // Valid pulses in the current group
+    uint8_t cycles;         // Consecutive complete groups
+} cadence_state_t;
+
+static cadence_limits_t limits[CADENCE_COUNT];
+static cadence_state_t state[CADENCE_COUNT];
+static bool lastOn = false;
+static uint32_t runHops = 0;
+
+
+static uint16_t hopsFloor(float ms, float hop_ms)
+{
+    return ms <= hop_ms ? 1 : (uint16_t)floorf(ms / hop_ms);
+}
+
+static uint16_t hopsCeil(float ms, float hop_ms)
+{
+    return (uint16_t)ceilf(ms / hop_ms);
+}
+
+
+void cadenceInit(float hop_ms, float frame_ms)
+{
+    for (int p = CADENCE_NONE + 1; p < CADENCE_COUNT; p++)
+    {
+        const cadence_template_t *t = &templates[p];
+        cadence_limits_t *l = &limits[p];
+        float tol_on    = CADENCE_TOLERANCE_MS + t->on_ms / 10.0f;
+        float tol_off   = CADENCE_TOLERANCE_MS + t->off_ms / 10.0f;
+        float tol_pause = CADENCE_TOLERANCE_MS + t->pause_ms / 10.0f;
+
+        // Pulses read long and gaps short by up to one frame
+        l->on_min    = hopsFloor(t->on_ms - tol_on, hop_ms);
+        l->on_max    = hopsCeil(t->on_ms + frame_ms + tol_on, hop_ms);
+        l->off_min   = hopsFloor(t->off_ms - frame_ms - tol_off, hop_ms);
+        l->off_max   = hopsCeil(t->off_ms + tol_off, hop_ms);
+        l->pause_min = hopsFloor(t->pause_ms - frame_ms - tol_pause, hop_ms);
+        l->pause_max = hopsCeil(t->pause_ms + tol_pause, hop_ms);
+
+        // A pause must never be mistaken for an in-group gap
+        if (l->pause_min <= l->off_max)
+            l->pause_min = l->off_max + 1;
+    }
+
+    cadenceReset();
+}
+
+void cadenceReset(void)
+{
+    memset(state, 0, sizeof(state));
+    lastOn = false;
+    runHops = UINT16_MAX;   // Start as if after a long silence
+}
+
+
+// A pulse of runHops just ended
+static void endPulse(int p)
+{
+    const cadence_limits_t *l = &limits[p];
+    cadence_state_t *s = &state[p];
+
+    if (runHops < l->on_min || runHops > l->on_max)
+    {
+        s->pulses = 0;
+        s->cycles = 0;
+    }
+    else if (s->pulses < templates[p].pulses)
+    {
+        s->pulses++;
+    }
+}
+
+// A gap of runHops just ended (gaps reaching pause_min were handled while running)
+static void endGap(int p)
+{
+    const cadence_limits_t *l = &limits[p];
+    cadence_state_t *s = &state[p];
+
+    if (s->pulses == 0)
+        return;
+
+    bool in_group = s->pulses < templates[p].pulses && runHops >= l->off_min && runHops <= l->off_max;
+    if (!in_group)
+    {
+        s->pulses = 0;
+        s->cycles = 0;
+    }
+}
+
+// Still silent after runHops: close a full group at pause_min, give up past pause_max
+static cadence_pattern_t holdGap(int p)
+{
+    const cadence_limits_t *l = &limits[p];
+    cadence_state_t *s = &state[p];
+
+    if (runHops == l->pause_min && s->pulses == templates[p].pulses)
+    {
+        s->pulses = 0;
+        if (s->cycles < UINT8_MAX)
+            s->cycles++;
+        if (s->cycles >= CADENCE_CONFIRM_CYCLES)
+            return (cadence_pattern_t)p;
+    }
+    else if (runHops == l->pause_max + 1u)
+    {
+        s->pulses = 0;
+        s->cycles = 0;
+    }
+    return CADENCE_NONE;
+}
+
+
+cadence_pattern_t cadenceUpdate(bool on)
+{
+    cadence_pattern_t matched = CADENCE_NONE;
+
+    if (on != lastOn)
+    {
+        for (int p = CADENCE_NONE + 1; p < CADENCE_COUNT; p++)
+        {
+            if (lastOn)
+                endPulse(p);
+            else
+                endGap(p);
+        }
+        lastOn = on;
+        runHops = 0;
+    }
+
+    if (runHops < UINT32_MAX)
+        runHops++;
+
+    if (!on)
+    {
+        for (int p = CADENCE_NONE + 1; p < CADENCE_COUNT; p++)
+        {
+            cadence_pattern_t m = holdGap(p);
+            if (matched == CADENCE_NONE)
+                matched = m;
+        }
+    }
+
+    return matched;
+}
+
+
+const char *cadenceName(cadence_pattern_t pattern)
+{
+    return (unsigned)pattern < CADENCE_COUNT ? cadenceNames[pattern] : "unknown";
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+/*
+ * Alarm cadence recognizer. Consumes one on/off decision per analysis hop
+ * (in-band level above threshold) and matches the run lengths against
+ * temporal templates such as T3 (smoke) and T4 (CO). State is a run counter
+ * plus two bytes per template, independent of pattern length.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    CADENCE_NONE,
+    CADENCE_T3,             // Smoke / fire: 3 x (0.5 s on, 0.5 s off), 1.5 s pause
+    CADENCE_T4,             // Carbon monoxide: 4 x (0.1 s on, 0.1 s off), 5 s pause
+    CADENCE_COUNT
+} cadence_pattern_t;
+
+// One template, in milliseconds
+typedef struct {
+    uint16_t on_ms;         // Pulse length
+    uint16_t off_ms;        // Gap between pulses of a group
+    uint8_t  pulses;        // Pulses per group
+    uint16_t pause_ms;      // Gap after the last pulse of a group
+} cadence_template_t;
+
+/**
+ * @brief Convert the templates (CADENCE_*_TEMPLATE in config.h) to hop counts
+ *
+ * An analysis frame of frame_ms stretches every pulse and shortens every gap
+ * by up to its length, depending on level; the accepted ranges allow for it.
+ */
+void cadenceInit(float hop_ms, float frame_ms);
+
+/**
+ * @brief Forget all runs and partial matches
+ */
+void cadenceReset(void);
+
+/**
+ * @brief Feed the decision for the next hop
+ *
+ * @return the pattern whose group completed on this hop, after
+ *         CADENCE_CONFIRM_CYCLES consecutive groups; CADENCE_NONE otherwise
+ */
+cadence_pattern_t cadenceUpdate(bool on);
+
+const char *cadenceName(cadence_pattern_t pattern);
@@ -0,0 +1,130 @@
+#include "dsp_config.h"
+#include "dsp_core.h"
+#include "dsp_goertzel.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Limits for uploaded values
+#define THRESHOLD_DB_MIN    -140.0f
+#define THRESHOLD_DB_MAX    0.0f
+#define SNR_DB_MIN          0.0f
+#define SNR_DB_MAX          60.0f
+
+const char *const detectorConfigKeys[] = {
+    "freq_start_hz", "freq_end_hz", "threshold_db", "snr_db", "window", "long_window", NULL
+};
+
+
+void detectorConfigDefaults(detector_config_t *cfg)
+{
+    cfg->freq_start_hz = Freq_START_HZ;
+    cfg->freq_end_hz   = Freq_END_HZ;
+    cfg->threshold_db  = THRESHOLD_DB;
+    cfg->snr_db        = NOISE_FLOOR_SNR_DB;
+    cfg->window        = WINDOW_TYPE;
+    cfg->long_window   = USE_LONG_WINDOW;
+}
+
+
+void detectorConfigBins(const detector_config_t *cfg, int *startBin, int *endBin)
+{
+    *startBin = (int)((cfg->freq_start_hz * FFT_SIZE) / SAMPLE_RATE);
+    *endBin   = (int)((cfg->freq_end_hz   * FFT_SIZE) / SAMPLE_RATE);
+}
+
+
+bool detectorConfigValid(const detector_config_t *cfg)
+{
+    if (cfg->freq_start_hz <= BAND_MIN_HZ || cfg->freq_end_hz <= cfg->freq_start_hz ||
+        cfg->freq_end_hz >= BAND_MAX_HZ)
+        return false;
+
+    int startBin, endBin;
+    detectorConfigBins(cfg, &startBin, &endBin);
+    if (endBin - startBin + 1 > MAX_BAND_BINS)
+        return false;
+#if USE_GOERTZEL
+    // The bank also filters the window's neighbouring bins either side
+    if (endBin - startBin + 1 > GOERTZEL_MAX_BINS || startBin < WINDOW_TERMS - 1 ||
+        endBin + WINDOW_TERMS - 1 >= FFT_SIZE / 2)
+        return false;
+#endif
+
+    // Also rejects NaN
+    if (!(cfg->threshold_db >= THRESHOLD_DB_MIN && cfg->threshold_db <= THRESHOLD_DB_MAX))
+        return false;
+    if (!(cfg->snr_db >= SNR_DB_MIN && cfg->snr_db <= SNR_DB_MAX))
+        return false;
+
+    return (unsigned)cfg->window < WINDOW_COUNT;
+}
+
+
+static bool parseInt(const char *text, int *out)
+{
+    char *end;
+    long v = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || v < -1000000 || v > 1000000)
+        return false;
+    *out = (int)v;
+    return true;
+}
+
+static bool parseFloat(const char *text, float *out)
+{
+    char *end;
+    float v = strtof(text, &end);
+    if (end == text || *end != '\0' || !isfinite(v))
+        return false;
+    *out = v;
+    return true;
+}
+
+
+bool detectorConfigSet(detector_config_t *cfg, const char *key, const char *value)
+{
+    if (strcmp(key, "freq_start_hz") == 0)
+        return parseInt(value, &cfg->freq_start_hz);
+    if (strcmp(key, "freq_end_hz") == 0)
+        return parseInt(value, &cfg->freq_end_hz);
+    if (strcmp(key, "threshold_db") == 0)
+        return parseFloat(value, &cfg->threshold_db);
+    if (strcmp(key, "snr_db") == 0)
+        return parseFloat(value, &cfg->snr_db);
+
+    if (strcmp(key, "window") == 0)
+    {
+        for (window_type_t w = 0; w < WINDOW_COUNT; w++)
+        {
+            if (strcmp(value, windowName(w)) == 0)
+            {
+                cfg->window = w;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    if (strcmp(key, "long_window") == 0)
+    {
+        int on;
+        if (!parseInt(value, &on) || (on != 0 && on != 1))
+            return false;
+        cfg->long_window = on;
+        return true;
+    }
+
+    return false;
+}
+
+
+int detectorConfigFormat(const detector_config_t *cfg, char *buf, size_t size)
+{
+    return snprintf(buf, size,
+                    "{\"freq_start_hz\":%d,\"freq_end_hz\":%d,\"threshold_db\":%.1f,"
+                    "\"snr_db\":%.1f,\"window\":\"%s\",\"long_window\":%d}",
+                    cfg->freq_start_hz, cfg->freq_end_hz, cfg->threshold_db,
+                    cfg->snr_db, windowName(cfg->window), cfg->long_window ? 1 : 0);
+}
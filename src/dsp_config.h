@@ -0,0 +1,54 @@
+#pragma once
+
+/*
+ * Detector settings that can change at runtime. The values in config.h are
+ * the defaults; a stored or uploaded configuration replaces them without a
+ * rebuild. dspCoreConfigure derives the tables from one of these.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "dsp_window.h"
+
+typedef struct {
+    int   freq_start_hz;    // Detection band
+    int   freq_end_hz;
+    float threshold_db;     // Fixed threshold (USE_NOISE_FLOOR 0)
+    float snr_db;           // Required rise above the noise floor (USE_NOISE_FLOOR 1)
+    window_type_t window;
+    bool  long_window;      // 4 s averaged decisions instead of per-hop confirmation
+} detector_config_t;
+
+/**
+ * @brief Fill `cfg` with the config.h defaults
+ */
+void detectorConfigDefaults(detector_config_t *cfg);
+
+/**
+ * @brief Check ranges: the band must lie below Nyquist (within the zoom span
+ *        with USE_ZOOM_FFT) and fit MAX_BAND_BINS
+ */
+bool detectorConfigValid(const detector_config_t *cfg);
+
+/**
+ * @brief First and last FFT bin of the band
+ */
+void detectorConfigBins(const detector_config_t *cfg, int *startBin, int *endBin);
+
+/**
+ * @brief Set one field by name from text ("freq_start_hz", "freq_end_hz",
+ *        "threshold_db", "snr_db", "window" by name, "long_window" 0/1)
+ *
+ * @return false for an unknown key or unparsable value (cfg unchanged)
+ */
+bool detectorConfigSet(detector_config_t *cfg, const char *key, const char *value);
+
+// Names accepted by detectorConfigSet, NULL-terminated
+extern const char *const detectorConfigKeys[];
+
+/**
+ * @brief Write `cfg` as a JSON object
+ *
+ * @return length as snprintf
+ */
+int detectorConfigFormat(const detector_config_t *cfg, char *buf, size_t size);
@@ -0,0 +1,1307 @@
+#include "dsp_core.h"
+#include "dsp_config.h"
+#include "dsp_window.h"
+#include "dsp_goertzel.h"
+#include "dsp_fixed.h"
+#include "dsp_noise_floor.h"
+#include "dsp_decimator.h"
+#include "dsp_gate.h"
+#include "mem_plan.h"
+#include "esp_dsp.h"
+#include <math.h>
+#include <string.h>
+
+
+#if USE_FIXED_POINT
+static int16_t qReal[FFT_SIZE] DSP_ALIGNED;  // Q15 samples in, packed sc16 spectrum out
+#else
+static float vReal[DSP_WORK_BUFFER_LEN] DSP_ALIGNED;  // Samples in, interleaved [Real, Imag, ...] bins out
+#endif
+
+_Static_assert(HOP_SIZE > 0 && HOP_SIZE <= FFT_SIZE, "FRAME_OVERLAP_PCT must be in 0..99");
+_Static_assert(CAPTURE_CHANNELS == 1 || CAPTURE_CHANNELS == 2, "CAPTURE_CHANNELS must be 1 (mono) or 2 (stereo)");
+
+#if USE_FIXED_POINT && USE_GOERTZEL
+    #error "USE_FIXED_POINT and USE_GOERTZEL cannot be combined"
+#endif
+#if USE_ZOOM_FFT && (USE_FIXED_POINT || USE_GOERTZEL)
+    #error "USE_ZOOM_FFT runs its own complex float FFT: not with USE_FIXED_POINT or USE_GOERTZEL"
+#endif
+
+// The capture goes through the FIR decimator, plain or band-shifting (zoom)
+#define USE_DECIMATOR               (USE_ZOOM_FFT || DECIMATION_FACTOR > 1)
+
+_Static_assert(Freq_END_HZ - Freq_START_HZ <= MAX_BAND_HZ, "default band is wider than MAX_BAND_HZ");
+_Static_assert((FFT_SIZE & (FFT_SIZE - 1)) == 0 && FFT_SIZE >= 256, "DECIMATION_FACTOR must leave a power-of-2 FFT_SIZE");
+_Static_assert(Freq_START_HZ > BAND_MIN_HZ && Freq_END_HZ < BAND_MAX_HZ,
+               "default band must lie below the decimated Nyquist, or within ZOOM_SPAN_HZ in zoom mode");
+#if USE_ZOOM_FFT
+_Static_assert(ZOOM_SPAN_HZ < SAMPLE_RATE, "ZOOM_SPAN_HZ must fit the zoom output rate");
+#endif
+#if USE_GOERTZEL
+_Static_assert(FFT_SIZE % HOP_SIZE == 0 && FFT_SIZE / HOP_SIZE <= GOERTZEL_MAX_SEGMENTS,
+               "the Goertzel bank needs FFT_SIZE to be a whole number of hops, up to GOERTZEL_MAX_SEGMENTS");
+#endif
+#if USE_ENERGY_GATE
+_Static_assert(FFT_SIZE % HOP_SIZE == 0 && FFT_SIZE / HOP_SIZE <= GATE_MAX_SEGMENTS,
+               "the energy gate needs FFT_SIZE to be a whole number of hops, up to GATE_MAX_SEGMENTS");
+#endif
+
+#define DETECT_COUNT                5      // Short window: consecutive detections to trigger alarm
+#define LONG_DETECT_COUNT           1      // Long window: consecutive window decisions
+
+// Confirmation counted in hops: the first frame fully covered by the tone plus
+// enough hops to span the same audio as DETECT_COUNT disjoint full-spectrum
+// frames. Zoom frames are longer, but confirmation takes no longer.
+#define DETECT_SPAN                 ((DETECT_COUNT - 1) * (CAPTURE_FRAME_SIZE / ANALYSIS_DECIMATION))
+#define DETECT_HOPS                 ((DETECT_SPAN + HOP_SIZE - 1) / HOP_SIZE + 1)
+
+#define LONG_WINDOW_SECONDS         4.0f   // 4 seconds
+#define LONG_WINDOW_FRAMES          ((int)ceil(LONG_WINDOW_SECONDS * SAMPLE_RATE / HOP_SIZE))
+
+// The window is kept as per-bin sums over LONG_WINDOW_BLOCKS blocks. Tumbling
+// mode decides once per window; sliding mode decides after every block on the
+// latest LONG_WINDOW_BLOCKS blocks, recycling the oldest one.
+#if LONG_WINDOW_SLIDING
+    #define LONG_WINDOW_BLOCKS       8
+#else
+    #define LONG_WINDOW_BLOCKS       1
+#endif
+#define LONG_BLOCK_FRAMES           ((LONG_WINDOW_FRAMES + LONG_WINDOW_BLOCKS - 1) / LONG_WINDOW_BLOCKS)
+#define LONG_WINDOW_TOTAL_FRAMES    (LONG_BLOCK_FRAMES * LONG_WINDOW_BLOCKS)
+
+// Sliding analysis frame per capture channel: newest samples at the end,
+// shifted by HOP_SIZE per analysis. Channels are pushed in step.
+static int32_t frameHistory[CAPTURE_CHANNELS][FRAME_LEN] DSP_ALIGNED;
+static int historyFill = 0;
+
+#if USE_ENERGY_GATE
+static int gateAuditEvery = GATE_AUDIT_EVERY;
+static int gatedSinceAudit = 0;
+#endif
+
+
+// Detection-stage values derived from a detector_config_t
+typedef struct {
+    int   bin_start;
+    int   bin_end;
+    bool  long_window;
+    float threshold_db;
+    float window_sum;
+    float level_scale;          // |X|^2 to band level (full scale = 1)
+    float threshold_power;      // threshold_db as |X|^2, so bins are compared without log10f
+    float snr_ratio;            // snr_db as a power ratio
+} detect_params_t;
+
+// Everything derived from one configuration. There are two sets: the live
+// one and the next, which dspCoreConfigure builds off the hot path. The
+// spectrum stage switches at a frame boundary and tags each spectrum with
+// its set; the detection stage follows when the first such spectrum arrives.
+struct dsp_tables {
+    detector_config_t config;
+    detect_params_t detect;
+    float gate_level;           // Band level (full scale = 1) under which a frame is not transformed
+#if USE_FIXED_POINT
+    fixed_tables_t fixed;       // Q15 window (spectrum stage) and thresholds (detection)
+#else
+    float window[FFT_SIZE] DSP_ALIGNED;
+#endif
+};
+
+static dsp_tables_t tableSets[2] DSP_ALIGNED;
+static dsp_tables_t *spectrumTables = &tableSets[0];        // Spectrum stage
+static dsp_tables_t *pendingTables = NULL;                  // Built, not yet picked up
+static const dsp_tables_t *failedTables = NULL;             // Pending set the spectrum stage could not apply
+static uint32_t configFailures = 0;
+static const dsp_tables_t *detectTables = &tableSets[0];    // Detection stage
+
+// Long-window accumulator: history, touched once per bin per frame, so in PSRAM
+PSRAM_BSS static float blockPower[LONG_WINDOW_BLOCKS][MAX_BAND_BINS];            // |X|^2 sums
+#if USE_FIXED_POINT
+PSRAM_BSS static uint64_t blockMagnitude[LONG_WINDOW_BLOCKS][MAX_BAND_BINS];     // fixedMagnitude() sums, common scale
+#endif
+static int blockFrames = 0;         // Frames in the block being filled
+static int blockIndex = 0;          // Block being filled
+static int blocksFilled = 0;        // Completed blocks, up to LONG_WINDOW_BLOCKS
+
+static int detectionCounter = 0;
+static int lastToneHz = 0;
+
+#if USE_NOISE_FLOOR
+static float bandLevel[MAX_BAND_BINS] DSP_ALIGNED;  // Band power of the frame (or window) being evaluated, full scale = 1
+static float minLevel;                  // NOISE_FLOOR_MIN_DB as power
+
+#define NOISE_FLOOR_SUBWINDOW_FRAMES \
+    ((int)ceil(NOISE_FLOOR_WINDOW_S * SAMPLE_RATE / HOP_SIZE / NOISE_FLOOR_SUBWINDOWS))
+#endif
+
+static bool analyzeBand(const float *band, const detect_params_t *p, dsp_detection_t *result);
+static bool analyzeSilence(const detect_params_t *p, float level_db, dsp_detection_t *result);
+#if USE_FIXED_POINT
+static bool analyzeBandFixed(const uint64_t *power, int shift, const detect_params_t *p,
+                             dsp_detection_t *result);
+#endif
+
+// Split twiddles e^(-j*2*pi*k/N), k = 0..N/4, for the real FFT post-processing
+static float realTwiddle[2 * (FFT_SIZE / 4 + 1)] DSP_ALIGNED;
+
+static void initRealTwiddle(void)
+{
+    for (int k = 0; k <= FFT_SIZE / 4; k++)
+    {
+        float e = (2.0f * M_PI * k) / FFT_SIZE;
+        realTwiddle[2*k + 0] = cosf(e);
+        realTwiddle[2*k + 1] = -sinf(e);
+    }
+}
+
+
+// Clear the per-bin decision state: confirmation counter and long-window sums
+static void resetDecisions(void)
+{
+    detectionCounter = 0;
+    memset(blockPower, 0, sizeof(blockPower));
+#if USE_FIXED_POINT
+    memset(blockMagnitude, 0, sizeof(blockMagnitude));
+#endif
+    blockFrames = 0;
+    blockIndex = 0;
+    blocksFilled = 0;
+}
+
+
+// Derive everything for `cfg` (already validated) into `t`
+static bool buildTables(dsp_tables_t *t, const detector_config_t *cfg)
+{
+    detect_params_t *p = &t->detect;
+
+    detectorConfigBins(cfg, &p->bin_start, &p->bin_end);
+#if USE_FIXED_POINT
+    if (!fixedBuildTables(&t->fixed, cfg->window, FFT_SIZE, cfg->threshold_db))
+        return false;
+    p->window_sum = t->fixed.window_sum;
+#else
+    if (!windowBuild(cfg->window, t->window, FFT_SIZE, &p->window_sum))
+        return false;
+#endif
+#if USE_GOERTZEL
+    // The bank applies the periodic form of the window, per bin
+    p->window_sum = goertzelWindowSum(cfg->window, FFT_SIZE);
+#endif
+
+    // A tone of amplitude A peaks at |X| = A * windowSum / 2
+    p->long_window     = cfg->long_window;
+    p->threshold_db    = cfg->threshold_db;
+    p->level_scale     = 4.0f / (p->window_sum * p->window_sum);
+    p->threshold_power = powf(10.0f, cfg->threshold_db / 10.0f) / p->level_scale;
+    p->snr_ratio       = powf(10.0f, cfg->snr_db / 10.0f);
+
+    // Below the lowest level either decision mode can accept, by a margin
+#if USE_NOISE_FLOOR
+    t->gate_level = powf(10.0f, (NOISE_FLOOR_MIN_DB - GATE_MARGIN_DB) / 10.0f);
+#else
+    t->gate_level = powf(10.0f, (cfg->threshold_db - GATE_MARGIN_DB) / 10.0f);
+#endif
+
+    t->config = *cfg;
+    return true;
+}
+
+// Spectrum stage switches to `t` (between frames)
+static bool useSpectrumTables(dsp_tables_t *t)
+{
+#if USE_FIXED_POINT
+    fixedUseWindow(&t->fixed);
+#endif
+#if USE_GOERTZEL
+    // A few dozen coefficients; cheaper than keeping a second filter bank.
+    // The hop sums kept so far belong to the old band and are dropped.
+    if (!goertzelInit(t->detect.bin_start, t->detect.bin_end, FFT_SIZE, HOP_SIZE, t->config.window))
+        return false;
+#endif
+#if USE_ENERGY_GATE && !USE_ZOOM_FFT
+    gateSetBand(t->config.freq_start_hz, t->config.freq_end_hz, SAMPLE_RATE);
+#endif
+    __atomic_store_n(&spectrumTables, t, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Detection stage switches to `t`. Per-bin state only survives if the band
+// and decision mode are unchanged; a new threshold or window keeps it.
+static void useDetectTables(const dsp_tables_t *t, bool force)
+{
+    const detect_params_t *old = &detectTables->detect;
+    bool bandChanged = force || t->detect.bin_start != old->bin_start ||
+                       t->detect.bin_end != old->bin_end || t->detect.long_window != old->long_window;
+
+#if USE_FIXED_POINT
+    fixedUseThreshold(&t->fixed);
+#endif
+    // Releases the previous set to dspCoreConfigure
+    __atomic_store_n(&detectTables, t, __ATOMIC_RELEASE);
+
+    if (!bandChanged)
+        return;
+
+    resetDecisions();
+#if USE_NOISE_FLOOR
+    noiseFloorInit(t->detect.bin_end - t->detect.bin_start + 1, NOISE_FLOOR_SUBWINDOW_FRAMES);
+#endif
+}
+
+
+bool dspCoreInit(void)
+{
+    // Initialize FFT (once). The real FFT only needs tables for N/2 points.
+#if USE_REAL_FFT && !USE_ZOOM_FFT
+    if (dsps_fft2r_init_fc32(NULL, FFT_SIZE / 2) != ESP_OK)
+        return false;
+#else
+    if (dsps_fft2r_init_fc32(NULL, FFT_SIZE) != ESP_OK)
+        return false;
+#endif
+
+    initRealTwiddle();
+
+#if USE_ZOOM_FFT
+    // Centred on a whole bin, so the zoom bins line up with k * FREQ_RESO
+    if (!decimatorInitComplex(ZOOM_DECIMATION, ZOOM_TAPS, ZOOM_CUTOFF_HZ, I2S_SAMPLE_RATE_HZ,
+                              DECIMATION_WINDOW, (SPECTRUM_BASE_BIN + FFT_SIZE / 2) * FREQ_RESO))
+        return false;
+#elif DECIMATION_FACTOR > 1
+    if (!decimatorInit(DECIMATION_FACTOR, DECIMATION_TAPS, DECIMATION_CUTOFF_HZ, I2S_SAMPLE_RATE_HZ,
+                       DECIMATION_WINDOW))
+        return false;
+#endif
+
+#if USE_ENERGY_GATE
+    if (!gateInit(FFT_SIZE, HOP_SIZE, USE_ZOOM_FFT))
+        return false;
+#endif
+
+    cadenceInit(1000.0f * HOP_SIZE / SAMPLE_RATE, 1000.0f * FFT_SIZE / SAMPLE_RATE);
+
+#if USE_NOISE_FLOOR
+    minLevel = powf(10.0f, NOISE_FLOOR_MIN_DB / 10.0f);
+#endif
+
+    // Module window table for the standalone stages (applyWindow, replay)
+    if (!windowInit(WINDOW_TYPE, FFT_SIZE))
+        return false;
+
+#if USE_FIXED_POINT
+    if (!fixedInit(WINDOW_TYPE, FFT_SIZE, THRESHOLD_DB))
+        return false;
+#endif
+
+    // Live tables from the config.h defaults
+    detector_config_t defaults;
+    detectorConfigDefaults(&defaults);
+    if (!detectorConfigValid(&defaults) || !buildTables(&tableSets[0], &defaults))
+        return false;
+
+    __atomic_store_n(&pendingTables, NULL, __ATOMIC_RELEASE);
+    if (!useSpectrumTables(&tableSets[0]))
+        return false;
+    useDetectTables(&tableSets[0], true);
+
+    dspCoreReset();
+    return true;
+}
+
+
+dsp_config_status_t dspCoreConfigure(const detector_config_t *cfg)
+{
+    if (!detectorConfigValid(cfg))
+        return DSP_CONFIG_INVALID;
+
+    // The previous change has not reached both stages yet. The spectrum stage
+    // publishes a set before clearing pending, so once pending reads NULL the
+    // live set below is the one it uses.
+    if (__atomic_load_n(&pendingTables, __ATOMIC_ACQUIRE) != NULL)
+        return DSP_CONFIG_BUSY;
+
+    dsp_tables_t *live = __atomic_load_n(&spectrumTables, __ATOMIC_ACQUIRE);
+    dsp_tables_t *spare = live == &tableSets[0] ? &tableSets[1] : &tableSets[0];
+    if (__atomic_load_n(&detectTables, __ATOMIC_ACQUIRE) == spare)
+        return DSP_CONFIG_BUSY;
+
+    if (!buildTables(spare, cfg))
+        return DSP_CONFIG_INVALID;
+
+    __atomic_store_n(&pendingTables, spare, __ATOMIC_RELEASE);
+    return DSP_CONFIG_OK;
+}
+
+void dspCoreGetConfig(detector_config_t *cfg)
+{
+    const dsp_tables_t *t = __atomic_load_n(&pendingTables, __ATOMIC_ACQUIRE);
+    if (t == NULL)
+        t = __atomic_load_n(&spectrumTables, __ATOMIC_ACQUIRE);
+    *cfg = t->config;
+}
+
+uint32_t dspCoreConfigFailures(void)
+{
+    return __atomic_load_n(&configFailures, __ATOMIC_RELAXED);
+}
+
+int dspCoreBuffers(mem_block_t *out, int max)
+{
+    const mem_block_t blocks[] = {
+#if USE_FIXED_POINT
+        { "fft work (q15)",     qReal,          sizeof(qReal) },
+        { "long window sums",   blockMagnitude, sizeof(blockMagnitude) },
+#else
+        { "fft work",           vReal,          sizeof(vReal) },
+        { "real fft twiddles",  realTwiddle,    sizeof(realTwiddle) },
+#endif
+        { "frame history",      frameHistory,   sizeof(frameHistory) },
+        { "window/config sets", tableSets,      sizeof(tableSets) },
+        { "long window power",  blockPower,     sizeof(blockPower) },
+#if USE_NOISE_FLOOR
+        { "band level",         bandLevel,      sizeof(bandLevel) },
+#endif
+    };
+
+    int count = 0;
+    for (int i = 0; i < (int)(sizeof(blocks) / sizeof(blocks[0])) && count < max; i++)
+        out[count++] = blocks[i];
+#if USE_DECIMATOR
+    count += decimatorBuffers(&out[count], max - count);
+#endif
+#if USE_GOERTZEL
+    count += goertzelBuffers(&out[count], max - count);
+#endif
+    return count;
+}
+
+void dspCoreReset(void)
+{
+    dspStreamReset();
+    cadenceReset();
+#if USE_NOISE_FLOOR
+    noiseFloorReset();
+#endif
+    resetDecisions();
+}
+
+
+// Tables for the spectrum stage's next frame
+static const dsp_tables_t *spectrumStageTables(void)
+{
+    // A new configuration takes effect at a frame boundary. Pending is cleared
+    // only after the set is live; one that fails stays pending (it is what
+    // dspCoreGetConfig reports and what was stored) and is retried every frame.
+    dsp_tables_t *next = __atomic_load_n(&pendingTables, __ATOMIC_ACQUIRE);
+    if (next != NULL)
+    {
+        if (useSpectrumTables(next))
+        {
+            failedTables = NULL;
+            __atomic_store_n(&pendingTables, NULL, __ATOMIC_RELEASE);
+        }
+        else if (failedTables != next)
+        {
+            failedTables = next;
+            __atomic_fetch_add(&configFailures, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    return spectrumTables;
+}
+
+#if !USE_FIXED_POINT
+// Window and transform `samples` into vReal, band bins at least. A stream
+// frame (`channel` >= 0) lets the Goertzel bank reuse its earlier hops.
+static void bandBins(const dsp_tables_t *t, const int32_t *samples, int channel)
+{
+#if USE_GOERTZEL
+    (void)t;
+    if (channel >= 0)
+        goertzelStreamFrame(channel, samples, vReal);
+    else
+        goertzelFrame(samples, vReal);
+#else
+    (void)channel;
+    // Normalize samples to float and apply window in one pass
+#if USE_ZOOM_FFT
+    windowApplyTableComplex(t->window, samples, vReal, FFT_SIZE);
+#else
+    windowApplyTable(t->window, samples, vReal, FFT_SIZE);
+#endif
+    computeSpectrum(vReal, FFT_SIZE);
+#endif
+}
+#endif
+
+// Window, transform, keep the band bins; `channel` as for bandBins (-1: standalone frame)
+static void transformFrame(const dsp_tables_t *t, const int32_t *samples, int channel, dsp_spectrum_t *spectrum)
+{
+    int startBin = t->detect.bin_start;
+    int endBin = t->detect.bin_end;
+
+#if USE_FIXED_POINT
+    (void)channel;
+    // Block-scale into Q15 and window, sc16 FFT, integer band power
+    spectrum->shift = fixedWindowNormalized(samples, qReal, FFT_SIZE);
+    fixedComputeRealFFT(qReal, FFT_SIZE);
+    fixedBandPower(qReal, FFT_SIZE, startBin, endBin, spectrum->power);
+#else
+    bandBins(t, samples, channel);
+    memcpy(spectrum->bins, &vReal[2 * (startBin - SPECTRUM_BASE_BIN)], 2 * (endBin - startBin + 1) * sizeof(float));
+#endif
+    spectrum->tables = t;
+    spectrum->gate = DSP_GATE_OPEN;
+    spectrum->gate_db = 0.0f;
+}
+
+
+#if CAPTURE_CHANNELS > 1
+// Transform another channel's frame and fuse it into `spectrum`: each band
+// bin keeps the louder channel, so a tone reaching either microphone is
+// seen at its level and the noise floor is that of the louder one
+static void fuseFrame(const dsp_tables_t *t, const int32_t *samples, int channel, dsp_spectrum_t *spectrum)
+{
+    int startBin = t->detect.bin_start;
+    int bins = t->detect.bin_end - startBin + 1;
+
+#if USE_FIXED_POINT
+    static uint64_t channelPower[MAX_BAND_BINS];
+    int shift = fixedWindowNormalized(samples, qReal, FFT_SIZE);
+    fixedComputeRealFFT(qReal, FFT_SIZE);
+    fixedBandPower(qReal, FFT_SIZE, startBin, t->detect.bin_end, channelPower);
+
+    // Power of a frame with block shift s is scaled by 2^-2s: compare at the larger shift
+    int common = shift > spectrum->shift ? shift : spectrum->shift;
+    for (int i = 0; i < bins; i++)
+    {
+        uint64_t mine = spectrum->power[i] >> (2 * (common - spectrum->shift));
+        uint64_t other = channelPower[i] >> (2 * (common - shift));
+        spectrum->power[i] = other > mine ? other : mine;
+    }
+    spectrum->shift = common;
+#else
+    bandBins(t, samples, channel);
+
+    const float *band = &vReal[2 * (startBin - SPECTRUM_BASE_BIN)];
+    for (int i = 0; i < bins; i++)
+    {
+        float *bin = &spectrum->bins[2*i];
+        if (band[2*i] * band[2*i] + band[2*i + 1] * band[2*i + 1] > bin[0] * bin[0] + bin[1] * bin[1])
+        {
+            bin[0] = band[2*i];
+            bin[1] = band[2*i + 1];
+        }
+    }
+#endif
+}
+#endif
+
+
+// Spectrum of the stream's frame, fused over the capture channels
+static void transformStream(const dsp_tables_t *t, dsp_spectrum_t *spectrum)
+{
+    transformFrame(t, frameHistory[0], 0, spectrum);
+#if CAPTURE_CHANNELS > 1
+    for (int ch = 1; ch < CAPTURE_CHANNELS; ch++)
+        fuseFrame(t, frameHistory[ch], ch, spectrum);
+#endif
+}
+
+
+// Spectrum stage: window, transform, keep the band bins
+void dspComputeSpectrum(const int32_t *samples, dsp_spectrum_t *spectrum)
+{
+    transformFrame(spectrumStageTables(), samples, -1, spectrum);
+}
+
+
+bool dspComputeStreamSpectrum(dsp_spectrum_t *spectrum)
+{
+    const dsp_tables_t *t = spectrumStageTables();
+
+#if USE_ENERGY_GATE
+    float level = gateLevel();
+    dsp_gate_t gate = DSP_GATE_OPEN;
+    if (level < t->gate_level)
+    {
+        if (gateAuditEvery <= 0 || ++gatedSinceAudit < gateAuditEvery)
+        {
+            spectrum->tables = t;
+            spectrum->gate = DSP_GATE_CLOSED;
+            spectrum->gate_db = 10.0f * log10f(level + 1e-24f);
+            return false;
+        }
+        gatedSinceAudit = 0;
+        gate = DSP_GATE_AUDIT;
+    }
+
+    transformStream(t, spectrum);
+    spectrum->gate = gate;
+    spectrum->gate_db = 10.0f * log10f(level + 1e-24f);
+#else
+    transformStream(t, spectrum);
+#endif
+    return true;
+}
+
+
+void dspGateSetAudit(int every)
+{
+#if USE_ENERGY_GATE
+    gateAuditEvery = every;
+    gatedSinceAudit = 0;
+#else
+    (void)every;
+#endif
+}
+
+
+// Detection stage: threshold or noise floor, confirmation and cadence
+bool dspAnalyzeSpectrum(const dsp_spectrum_t *spectrum, dsp_detection_t *result)
+{
+    dsp_detection_t detection;
+    bool confirmed;
+
+    const dsp_tables_t *t = spectrum->tables;
+    if (t != detectTables)
+        useDetectTables(t, false);
+
+    if (spectrum->gate == DSP_GATE_CLOSED)
+        confirmed = analyzeSilence(&t->detect, spectrum->gate_db, &detection);
+    else
+#if USE_FIXED_POINT
+        confirmed = analyzeBandFixed(spectrum->power, spectrum->shift, &t->detect, &detection);
+#else
+        confirmed = analyzeBand(spectrum->bins, &t->detect, &detection);
+#endif
+
+    // Per-frame on/off into the cadence templates. Matches land in a gap, so
+    // they report the frequency of the last pulse.
+    if (detection.tone_on)
+        lastToneHz = detection.freq_hz;
+
+    detection.pattern = cadenceUpdate(detection.tone_on);
+    if (detection.pattern != CADENCE_NONE && !detection.tone_on)
+        detection.freq_hz = lastToneHz;
+
+    if (result != NULL)
+        *result = detection;
+
+    return confirmed || detection.pattern != CADENCE_NONE;
+}
+
+
+int dspSpectrumLevels(const dsp_spectrum_t *spectrum, float *level_db, int *startBin)
+{
+    const detect_params_t *p = &spectrum->tables->detect;
+    int count = p->bin_end - p->bin_start + 1;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (spectrum->gate == DSP_GATE_CLOSED)
+        {
+            level_db[i] = spectrum->gate_db - 10.0f * log10f((float)count);
+            continue;
+        }
+#if USE_FIXED_POINT
+        level_db[i] = fixedPowerToDb(spectrum->power[i], spectrum->shift);
+#else
+        float re = spectrum->bins[2*i];
+        float im = spectrum->bins[2*i + 1];
+        level_db[i] = 10.0f * log10f((re*re + im*im) * p->level_scale + 1e-24f);
+#endif
+    }
+
+    *startBin = p->bin_start;
+    return count;
+}
+
+
+// Full pipeline for one frame
+bool dspProcessFrame(const int32_t *samples, dsp_detection_t *result)
+{
+    static dsp_spectrum_t spectrum;
+
+    dspComputeSpectrum(samples, &spectrum);
+    return dspAnalyzeSpectrum(&spectrum, result);
+}
+
+
+int dspStreamPush(const int32_t *samples, int count)
+{
+    const int32_t *channels[CAPTURE_CHANNELS];
+    for (int ch = 0; ch < CAPTURE_CHANNELS; ch++)
+        channels[ch] = samples;
+    return dspStreamPushChannels(channels, count);
+}
+
+int dspStreamPushChannels(const int32_t *const *channels, int count)
+{
+    int space = FFT_SIZE - historyFill;
+    int used = 0, produced = 0;
+
+    // Every channel takes the same count: the decimator's consumption
+    // depends only on how many samples it was given
+    for (int ch = 0; ch < CAPTURE_CHANNELS; ch++)
+    {
+        int32_t *dest = &frameHistory[ch][historyFill * SAMPLE_WORDS];
+
+#if USE_DECIMATOR
+        // Capture rate in, analysis rate (or complex zoom band) into the frame
+        used = decimatorPushChannel(ch, channels[ch], count, dest, space, &produced);
+#else
+        used = count < space ? count : space;
+        produced = used;
+        memcpy(dest, channels[ch], used * sizeof(int32_t));
+#endif
+
+#if USE_ENERGY_GATE
+        gateFeedChannel(ch, dest, produced);
+#endif
+    }
+
+    historyFill += produced;
+    return used;
+}
+
+const int32_t *dspStreamFrame(void)
+{
+    return historyFill == FFT_SIZE ? frameHistory[0] : NULL;
+}
+
+void dspStreamAdvance(void)
+{
+    for (int ch = 0; ch < CAPTURE_CHANNELS; ch++)
+    {
+        memmove(frameHistory[ch], &frameHistory[ch][HOP_SIZE * SAMPLE_WORDS],
+                (FFT_SIZE - HOP_SIZE) * SAMPLE_WORDS * sizeof(int32_t));
+    }
+    historyFill = FFT_SIZE - HOP_SIZE;
+#if USE_GOERTZEL
+    goertzelAdvance();
+#endif
+}
+
+
+void dspStreamReset(void)
+{
+    historyFill = 0;
+#if USE_DECIMATOR
+    decimatorReset();
+#endif
+#if USE_ENERGY_GATE
+    gateReset();
+    gatedSinceAudit = 0;
+#endif
+#if USE_GOERTZEL
+    goertzelReset();
+#endif
+}
+
+
+// Overlapping analysis over an arbitrary-size capture block
+bool dspProcessBlock(const int32_t *samples, int count, dsp_detection_t *result)
+{
+    bool confirmed = false;
+    dsp_detection_t detection = {0};
+    cadence_pattern_t pattern = CADENCE_NONE;
+
+    while (count > 0)
+    {
+        int used = dspStreamPush(samples, count);
+        samples += used;
+        count -= used;
+
+        if (dspStreamFrame() == NULL)
+            continue;
+
+        static dsp_spectrum_t spectrum;
+        dspComputeStreamSpectrum(&spectrum);
+        if (dspAnalyzeSpectrum(&spectrum, &detection))
+        {
+            confirmed = true;
+            if (detection.pattern != CADENCE_NONE)
+                pattern = detection.pattern;
+            if (result != NULL)
+                *result = detection;
+        }
+        dspStreamAdvance();
+    }
+
+    if (!confirmed && result != NULL)
+        *result = detection;
+    if (result != NULL && pattern != CADENCE_NONE)
+        result->pattern = pattern;
+
+    return confirmed;
+}
+
+
+// Normalize 32-bit samples to float [-1.0, 1.0]
+int normalizeBuffer(const int32_t *buffer, float *real, int length)
+{
+    const float scale = 1.0f / 2147483648.0f;   // 2³¹
+    // const float scale = 1.0f / 16777216.0f;   // 2²⁴
+    // const float scale = 1.0f / 8388608.0f;   // 2²³
+    int out = 0;
+    for (int i = 0; i < length; i ++)
+    {
+        // int32_t sample24 = buffer[i] >> 8;  // Convert 32-bit to 24-bit
+        int32_t sample24 = buffer[i];  // Use full 32-bit
+        real[out++] = (float)sample24 * scale;
+    }
+
+    return out;
+}
+
+
+// Apply the precomputed window (WINDOW_TYPE) to normalized samples
+void applyWindow(float *data, int length)
+{
+    windowApply(data, length);
+}
+
+
+// Band spectrum of `length` windowed samples, interleaved in `data`. The
+// zoom FFT takes [I, Q] samples and leaves bins SPECTRUM_BASE_BIN onwards.
+// The Goertzel bank works on raw samples in hops (transformFrame), so an
+// already windowed frame goes through the FFT in that build too.
+void computeSpectrum(float *data, int length)
+{
+#if USE_ZOOM_FFT
+    computeZoomFFT(data, length);
+#else
+    computeFFT(data, length);
+#endif
+}
+
+
+// FFT of `length` real samples; leaves bins 0..length/2-1 interleaved in `data`
+void computeFFT(float *data, int length)
+{
+#if USE_REAL_FFT
+    computeRealFFT(data, length);
+#else
+    computeComplexFFT(data, length);
+#endif
+}
+
+
+// Real FFT: pack even/odd samples as one N/2-point complex signal, run the
+// complex FFT, then split into the N-point spectrum. `data` holds length floats;
+// bin N/2 (Nyquist) is dropped and DC imag is left at 0.
+void computeRealFFT(float *data, int length)
+{
+    int half = length / 2;
+    int step = FFT_SIZE / length;   // twiddle stride for shorter transforms
+
+    dsps_fft2r_fc32(data, half);     // FFT of z[k] = x[2k] + j*x[2k+1]
+    dsps_bit_rev_fc32(data, half);   // Bit-reversal
+
+    // DC: X[0] = Re Z[0] + Im Z[0]
+    data[0] = data[0] + data[1];
+    data[1] = 0.0f;
+
+    // X[k] = Fe + W^k * Fo,  X[N/2-k] = conj(Fe - W^k * Fo)
+    // Fe = (Z[k] + conj Z[N/2-k]) / 2,  Fo = -j * (Z[k] - conj Z[N/2-k]) / 2
+    for (int k = 1; k <= half / 2; k++)
+    {
+        float *a = &data[2*k];
+        float *b = &data[2*(half - k)];
+
+        float fe_re = 0.5f * (a[0] + b[0]);
+        float fe_im = 0.5f * (a[1] - b[1]);
+        float fo_re = 0.5f * (a[1] + b[1]);
+        float fo_im = 0.5f * (b[0] - a[0]);
+
+        float w_re = realTwiddle[2 * k * step + 0];
+        float w_im = realTwiddle[2 * k * step + 1];
+        float t_re = w_re * fo_re - w_im * fo_im;
+        float t_im = w_re * fo_im + w_im * fo_re;
+
+        a[0] = fe_re + t_re;
+        a[1] = fe_im + t_im;
+        b[0] = fe_re - t_re;
+        b[1] = t_im - fe_im;
+    }
+}
+
+
+// Complex FFT of `length` real samples; `data` must hold 2*length floats
+void computeComplexFFT(float *data, int length)
+{
+    // Convert real → complex (interleaved)
+    for (int i = length - 1; i >= 0; i--)
+    {
+        data[2*i + 0] = data[i];
+        data[2*i + 1] = 0.0f;
+    }
+
+    dsps_fft2r_fc32(data, length);       // FFT
+    dsps_bit_rev_fc32(data, length);     // Bit-reversal
+}
+
+
+// Zoom FFT of `length` complex baseband samples. The band's centre is at
+// half the sample rate, so bin k is SPECTRUM_BASE_BIN + k with no reordering.
+void computeZoomFFT(float *data, int length)
+{
+    dsps_fft2r_fc32(data, length);
+    dsps_bit_rev_fc32(data, length);
+}
+
+
+// Long window: LONG_DETECT_COUNT consecutive window decisions
+static bool confirmWindow(bool detected)
+{
+    if (detected)
+        detectionCounter++;
+    else
+        detectionCounter = 0;
+
+    if (detectionCounter >= LONG_DETECT_COUNT)
+    {
+        detectionCounter = 0;
+        return true;
+    }
+    return false;
+}
+
+// Start the next block in place of the oldest
+static void longWindowAdvance(void)
+{
+    blockIndex = (blockIndex + 1) % LONG_WINDOW_BLOCKS;
+    memset(blockPower[blockIndex], 0, sizeof(blockPower[blockIndex]));
+#if USE_FIXED_POINT
+    memset(blockMagnitude[blockIndex], 0, sizeof(blockMagnitude[blockIndex]));
+#endif
+}
+
+// Count a frame into the current block. True when that completes a block and
+// the window holds LONG_WINDOW_BLOCKS of them; decide, then longWindowAdvance().
+static bool longWindowFrameDone(void)
+{
+    if (++blockFrames < LONG_BLOCK_FRAMES)
+        return false;
+
+    blockFrames = 0;
+    if (blocksFilled < LONG_WINDOW_BLOCKS)
+        blocksFilled++;
+    if (blocksFilled == LONG_WINDOW_BLOCKS)
+        return true;
+
+    longWindowAdvance();    // Still filling the first window
+    return false;
+}
+
+// Short window: counts up per detecting hop and decays otherwise
+static bool confirmHop(bool detected)
+{
+    if (detected)
+        detectionCounter++;
+    else if (detectionCounter > 0)
+        detectionCounter--;
+
+    if (detectionCounter >= DETECT_HOPS)
+    {
+        detectionCounter = 0;
+        return true;
+    }
+    return false;
+}
+
+
+#if USE_NOISE_FLOOR
+// Band bin furthest above its noise floor, if any rises snrRatio above it;
+// bin and peak_db are only written when one does
+static bool aboveFloor(const float *level, int startBin, int endBin, float snrRatio,
+                       int *bin, float *peak_db)
+{
+    float bestRatio = 0.0f;
+    int best = -1;
+
+    for (int i = 0; i <= endBin - startBin; i++)
+    {
+        // Floors under the absolute minimum (digital silence) rank bins by level
+        float floor = fmaxf(noiseFloorPower(i), minLevel);
+        if (level[i] <= minLevel || level[i] <= noiseFloorPower(i) * snrRatio)
+            continue;
+
+        float ratio = level[i] / floor;
+        if (ratio > bestRatio)
+        {
+            bestRatio = ratio;
+            best = i;
+        }
+    }
+
+    if (best < 0)
+        return false;
+
+    *bin = startBin + best;
+    *peak_db = 10.0f * log10f(level[best] + 1e-24f);
+    return true;
+}
+#endif
+
+
+// Parameters for the standalone analyzeBins/analyzeBinsFixed: the caller's
+// band and threshold with the module window, and the live decision mode.
+// Derived values are cached per threshold and window.
+static const detect_params_t *standaloneParams(int startBin, int endBin, float threshold_dB)
+{
+    static detect_params_t p;
+    static float cachedDb = NAN;
+    static float cachedWindowSum = NAN;
+    const detect_params_t *live = &__atomic_load_n(&detectTables, __ATOMIC_ACQUIRE)->detect;
+
+    if (threshold_dB != cachedDb || windowSum() != cachedWindowSum)
+    {
+        p.window_sum = windowSum();
+        p.level_scale = 4.0f / (p.window_sum * p.window_sum);
+        p.threshold_power = powf(10.0f, threshold_dB / 10.0f) / p.level_scale;
+        cachedDb = threshold_dB;
+        cachedWindowSum = p.window_sum;
+    }
+
+    p.bin_start    = startBin;
+    p.bin_end      = endBin;
+    p.threshold_db = threshold_dB;
+    p.long_window  = live->long_window;
+    p.snr_ratio    = live->snr_ratio;
+    return &p;
+}
+
+
+// Analyze band bins for threshold crossing; band[0..1] is bin p->bin_start
+static bool analyzeBand(const float *band, const detect_params_t *p, dsp_detection_t *result)
+{
+    bool detected = false;
+    bool confirmed = false;
+    bool tone_on = false;
+    int freq_detected = 0;
+    float tmp_powerDB = -500;
+    int tmp_i = 0;
+    int startBin = p->bin_start;
+    int endBin = p->bin_end;
+
+    if (p->long_window)
+    {
+        // -------------------------------
+        // Long-window accumulation: |X|^2 of the band bins is summed into the
+        // current block; the window is compared as a sum against threshold_power
+        // times its frame count, so there is no per-frame divide, sqrt or log
+        // -------------------------------
+        float *block = blockPower[blockIndex];
+        float frameMax = 0.0f;
+        int frameMaxBin = startBin;
+        for (int i = startBin; i <= endBin; i++)
+        {
+            float re = band[2*(i - startBin)];
+            float im = band[2*(i - startBin) + 1];
+                if (isnan(im)) {
+                    im = 0.0f;
+                }
+                if (isnan(re)) {
+                    re = 0.0f;
+                }
+            float power = re*re + im*im;
+
+            block[i - startBin] += power;
+#if USE_NOISE_FLOOR
+            bandLevel[i - startBin] = power * p->level_scale;
+#endif
+            if (power > frameMax)
+            {
+                frameMax = power;
+                frameMaxBin = i;
+            }
+        }
+
+        // This frame on its own, for the cadence recognizer
+#if USE_NOISE_FLOOR
+        float frameDB;
+        tone_on = aboveFloor(bandLevel, startBin, endBin, p->snr_ratio, &frameMaxBin, &frameDB);
+        noiseFloorUpdate(bandLevel);
+#else
+        tone_on = frameMax > p->threshold_power;
+#endif
+        if (tone_on)
+            freq_detected = (int)(frameMaxBin * FREQ_RESO + 0.5f);
+
+        if (longWindowFrameDone())
+        {
+            float peak = 0.0f;
+            tmp_i = startBin;
+            for (int i = startBin; i <= endBin; i++)
+            {
+                float sum = 0.0f;
+                for (int k = 0; k < LONG_WINDOW_BLOCKS; k++)
+                    sum += blockPower[k][i - startBin];
+                if (sum > peak)
+                {
+                    peak = sum;
+                    tmp_i = i;
+                }
+#if USE_NOISE_FLOOR
+                bandLevel[i - startBin] = sum * (p->level_scale / LONG_WINDOW_TOTAL_FRAMES);
+#endif
+            }
+
+            // Only the reported peak is converted to dB
+            tmp_powerDB = 10.0f * log10f(peak * (p->level_scale / LONG_WINDOW_TOTAL_FRAMES) + 1e-24f);
+#if USE_NOISE_FLOOR
+            detected = aboveFloor(bandLevel, startBin, endBin, p->snr_ratio, &tmp_i, &tmp_powerDB);
+#else
+            // Mean above threshold, without dividing: sum > threshold * frames
+            detected = peak > p->threshold_power * LONG_WINDOW_TOTAL_FRAMES;
+#endif
+            if (detected)
+            {
+                freq_detected = (int)(tmp_i * FREQ_RESO + 0.5f); // Rounds to nearest integer
+                // printf("%d\n", freq_detected);
+            }
+
+            confirmed = confirmWindow(detected);
+            longWindowAdvance();
+        }
+    }
+    else
+    {
+        // -------------------------------
+        // Short-window analysis
+        // -------------------------------
+        for (int i = startBin; i <= endBin; i++)
+        {
+            float re = band[2*(i - startBin)];
+            float im = band[2*(i - startBin) + 1];
+                if (isnan(im)) {
+                    im = 0.0f;
+                }
+                if (isnan(re)) {
+                    re = 0.0f;
+                }
+            float mag = sqrtf(re*re + im*im);
+
+            // Every zoom bin is a positive frequency, away from DC and Nyquist
+            if (USE_ZOOM_FFT || (i != 0 && i != (FFT_SIZE / 2)))
+                mag *= 2.0f;
+
+            float powerDB = 20.0f * log10f((mag / p->window_sum) + 1e-12f);
+#if USE_NOISE_FLOOR
+            bandLevel[i - startBin] = (mag / p->window_sum) * (mag / p->window_sum);
+#endif
+
+            if (powerDB > tmp_powerDB) {
+                tmp_powerDB = powerDB;
+                tmp_i = i;
+            }
+
+            // Optional debug
+                // printf("index %3d:  (%f)\n", i, powerDB);   //signed decimal
+                // printf("index %3d:  (%f)\n", i, im);   //signed decimal
+        }
+
+#if USE_NOISE_FLOOR
+        detected = aboveFloor(bandLevel, startBin, endBin, p->snr_ratio, &tmp_i, &tmp_powerDB);
+        noiseFloorUpdate(bandLevel);
+#else
+        detected = tmp_powerDB > p->threshold_db;
+#endif
+        if (detected)
+        {
+            freq_detected = (int)(tmp_i * FREQ_RESO + 0.5f); // Rounds to nearest integer
+            // printf("%d\n", freq_detected);
+        }
+
+        tone_on = detected;
+        confirmed = confirmHop(detected);
+    }
+
+    if (result != NULL)
+    {
+        result->detected = confirmed;
+        result->tone_on  = tone_on;
+        result->pattern  = CADENCE_NONE;
+        result->freq_hz  = freq_detected;
+        result->peak_db  = tmp_powerDB;
+    }
+
+    return confirmed;
+}
+
+
+// Analyze FFT bins for threshold crossing
+bool analyzeBins(const float *fftData, int startBin, int endBin, float threshold_dB,
+                 dsp_detection_t *result)
+{
+    return analyzeBand(&fftData[2 * (startBin - SPECTRUM_BASE_BIN)], standaloneParams(startBin, endBin, threshold_dB),
+                       result);
+}
+
+
+#if USE_FIXED_POINT
+// Integer counterpart of analyzeBand for the Q15 path: band power from
+// fixedBandPower (power[0] is p->bin_start) against the precomputed threshold
+// of the set selected with fixedUseThreshold. Only the reported peak_db is
+// converted to float, and with USE_NOISE_FLOOR the band power, since the
+// floor tracker works on float levels.
+static bool analyzeBandFixed(const uint64_t *power, int shift, const detect_params_t *p,
+                             dsp_detection_t *result)
+{
+    bool detected = false;
+    bool confirmed = false;
+    bool tone_on = false;
+    int freq_detected = 0;
+    float tmp_powerDB = -500;
+    int startBin = p->bin_start;
+    int endBin = p->bin_end;
+    int tmp_i = startBin;
+
+    if (p->long_window)
+    {
+        uint64_t *block = blockMagnitude[blockIndex];
+        uint64_t frameMax = 0;
+        int frameMaxBin = startBin;
+        for (int i = startBin; i <= endBin; i++)
+        {
+            block[i - startBin] += fixedMagnitude(power[i - startBin], shift);
+#if USE_NOISE_FLOOR
+            bandLevel[i - startBin] = fixedPowerToLevel(power[i - startBin], shift);
+#endif
+            if (power[i - startBin] > frameMax)
+            {
+                frameMax = power[i - startBin];
+                frameMaxBin = i;
+            }
+        }
+
+        // This frame on its own, for the cadence recognizer
+#if USE_NOISE_FLOOR
+        float frameDB;
+        tone_on = aboveFloor(bandLevel, startBin, endBin, p->snr_ratio, &frameMaxBin, &frameDB);
+        noiseFloorUpdate(bandLevel);
+#else
+        tone_on = frameMax > fixedPowerThreshold(shift);
+#endif
+        if (tone_on)
+            freq_detected = (int)(frameMaxBin * FREQ_RESO + 0.5f);
+
+        if (longWindowFrameDone())
+        {
+            uint64_t peak = 0;
+            for (int i = startBin; i <= endBin; i++)
+            {
+                uint64_t sum = 0;
+                for (int k = 0; k < LONG_WINDOW_BLOCKS; k++)
+                    sum += blockMagnitude[k][i - startBin];
+                if (sum > peak)
+                {
+                    peak = sum;
+                    tmp_i = i;
+                }
+#if USE_NOISE_FLOOR
+                bandLevel[i - startBin] = fixedMagnitudeToLevel(sum / LONG_WINDOW_TOTAL_FRAMES);
+#endif
+            }
+
+            tmp_powerDB = fixedMagnitudeToDb(peak / LONG_WINDOW_TOTAL_FRAMES);
+#if USE_NOISE_FLOOR
+            detected = aboveFloor(bandLevel, startBin, endBin, p->snr_ratio, &tmp_i, &tmp_powerDB);
+#else
+            // Mean above threshold, without dividing: sum > threshold * frames
+            detected = peak > fixedMagnitudeThreshold() * (uint64_t)LONG_WINDOW_TOTAL_FRAMES;
+#endif
+            if (detected)
+                freq_detected = (int)(tmp_i * FREQ_RESO + 0.5f);
+
+            confirmed = confirmWindow(detected);
+            longWindowAdvance();
+        }
+    }
+    else
+    {
+        uint64_t peak = 0;
+        for (int i = startBin; i <= endBin; i++)
+        {
+            if (power[i - startBin] > peak)
+            {
+                peak = power[i - startBin];
+                tmp_i = i;
+            }
+        }
+
+        tmp_powerDB = fixedPowerToDb(peak, shift);
+#if USE_NOISE_FLOOR
+        for (int i = startBin; i <= endBin; i++)
+            bandLevel[i - startBin] = fixedPowerToLevel(power[i - startBin], shift);
+        detected = aboveFloor(bandLevel, startBin, endBin, p->snr_ratio, &tmp_i, &tmp_powerDB);
+        noiseFloorUpdate(bandLevel);
+#else
+        detected = peak > fixedPowerThreshold(shift);
+#endif
+        if (detected)
+            freq_detected = (int)(tmp_i * FREQ_RESO + 0.5f);
+
+        tone_on = detected;
+        confirmed = confirmHop(detected);
+    }
+
+    if (result != NULL)
+    {
+        result->detected = confirmed;
+        result->tone_on  = tone_on;
+        result->pattern  = CADENCE_NONE;
+        result->freq_hz  = freq_detected;
+        result->peak_db  = tmp_powerDB;
+    }
+
+    return confirmed;
+}
+
+bool analyzeBinsFixed(const uint64_t *power, int shift, int startBin, int endBin,
+                      dsp_detection_t *result)
+{
+    const dsp_tables_t *live = __atomic_load_n(&detectTables, __ATOMIC_ACQUIRE);
+    return analyzeBandFixed(power, shift, standaloneParams(startBin, endBin, live->detect.threshold_db),
+                            result);
+}
+#endif
+
+
+// A frame the energy gate kept closed: nothing in the band comes near a
+// detectable level, so it is a silent frame for the decisions. The noise
+// floor and the long-window blocks still count it, so their timing is as
+// if it had been transformed.
+static bool analyzeSilence(const detect_params_t *p, float level_db, dsp_detection_t *result)
+{
+    if (p->long_window)
+    {
+        // Zero power into the block sums; the decision runs when a block completes
+#if USE_FIXED_POINT
+        static const uint64_t silentPower[MAX_BAND_BINS];
+        return analyzeBandFixed(silentPower, 0, p, result);
+#else
+        static const float silentBins[2 * MAX_BAND_BINS];
+        return analyzeBand(silentBins, p, result);
+#endif
+    }
+
+#if USE_NOISE_FLOOR
+    memset(bandLevel, 0, (p->bin_end - p->bin_start + 1) * sizeof(float));
+    noiseFloorUpdate(bandLevel);
+#endif
+    confirmHop(false);
+
+    if (result != NULL)
+    {
+        result->detected = false;
+        result->tone_on  = false;
+        result->pattern  = CADENCE_NONE;
+        result->freq_hz  = 0;
+        result->peak_db  = level_db;    // The whole band's level bounds any bin's
+    }
+    return false;
+}
@@ -0,0 +1,222 @@
+#pragma once
+
+/*
+ * Detection core: normalization, windowing, FFT and band analysis.
+ * Has no FreeRTOS dependency so the same code runs inside
+ * vFFTProcessorTask on the ESP32-S3 and in the host replay tool.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "audio_config.h"
+#include "config.h"
+#include "dsp_cadence.h"
+#include "dsp_config.h"
+#include "mem_plan.h"
+
+#define CAPTURE_FRAME_SIZE          4096    // Full-spectrum frame at the capture rate (85 ms)
+
+// FFT Settings. Frames are taken from the decimated capture, so sizes and
+// bin math are at the analysis rate SAMPLE_RATE, not I2S_SAMPLE_RATE_HZ.
+// Bins are numbered from 0 Hz in both modes (bin k is at k * FREQ_RESO); the
+// zoom transform only covers bins SPECTRUM_BASE_BIN..+FFT_SIZE-1 of them.
+#if USE_ZOOM_FFT
+    #define ANALYSIS_DECIMATION     ZOOM_DECIMATION
+    #define FFT_SIZE                ZOOM_FFT_SIZE       // Complex points
+    #define SAMPLE_WORDS            2                   // int32 per sample: [I, Q]
+    #define SPECTRUM_BASE_BIN       ((int)(ZOOM_CENTER_HZ / FREQ_RESO + 0.5f) - FFT_SIZE / 2)  // Bin of the transform's index 0
+    #define BAND_MIN_HZ             (ZOOM_CENTER_HZ - ZOOM_SPAN_HZ / 2)     // Analyzable range
+    #define BAND_MAX_HZ             (ZOOM_CENTER_HZ + ZOOM_SPAN_HZ / 2)
+#else
+    #define ANALYSIS_DECIMATION     DECIMATION_FACTOR
+    #define FFT_SIZE                (CAPTURE_FRAME_SIZE / DECIMATION_FACTOR)  // Must be power of 2
+    #define SAMPLE_WORDS            1
+    #define SPECTRUM_BASE_BIN       0
+    #define BAND_MIN_HZ             0
+    #define BAND_MAX_HZ             ((int)(SAMPLE_RATE / 2))
+#endif
+#define SAMPLE_RATE           (I2S_SAMPLE_RATE_HZ / ANALYSIS_DECIMATION)  // Analysis rate (complex in zoom mode)
+#define FRAME_LEN             (FFT_SIZE * SAMPLE_WORDS)  // int32 values in an analysis frame
+#define HOP_SIZE              (FFT_SIZE * (100 - FRAME_OVERLAP_PCT) / 100)  // Samples between analyses
+
+#define BIN_START                   ((int)((Freq_START_HZ * FFT_SIZE) / SAMPLE_RATE))   // default band start bin
+#define BIN_END                     ((int)((Freq_END_HZ   * FFT_SIZE) / SAMPLE_RATE))   // default band end bin
+#define FREQ_RESO                   ((float)SAMPLE_RATE / FFT_SIZE)
+#define NUM_BINS                    (FFT_SIZE / 2)  // Number of FFT bins for real FFT
+#define MAX_BAND_BINS               ((MAX_BAND_HZ * FFT_SIZE * ANALYSIS_DECIMATION) / (int)I2S_SAMPLE_RATE_HZ + 2)  // >= bins of any band up to MAX_BAND_HZ, constant for array sizes
+
+// Work buffer length (floats) needed by computeFFT. The real FFT works in
+// place on FFT_SIZE samples; the complex path widens them to [Re, Im, ...].
+#define REAL_FFT_BUFFER_LEN         (FFT_SIZE)
+#define COMPLEX_FFT_BUFFER_LEN      (FFT_SIZE * 2)
+#if USE_REAL_FFT && !USE_ZOOM_FFT
+    #define DSP_WORK_BUFFER_LEN     REAL_FFT_BUFFER_LEN
+#else
+    #define DSP_WORK_BUFFER_LEN     COMPLEX_FFT_BUFFER_LEN
+#endif
+
+// Result of analyzing one frame
+typedef struct {
+    bool  detected;     // DETECT_COUNT reached on this frame
+    bool  tone_on;      // In-band level above threshold on this frame alone
+    int   freq_hz;      // Dominant in-band frequency (rounded to Hz)
+    float peak_db;      // Peak in-band level of the evaluated spectrum
+    cadence_pattern_t pattern;  // Cadence whose group completed on this frame, or CADENCE_NONE
+} dsp_detection_t;
+
+// Window, thresholds and band derived from one detector_config_t
+typedef struct dsp_tables dsp_tables_t;
+
+// What the energy gate (USE_ENERGY_GATE) made of a stream frame
+typedef enum {
+    DSP_GATE_OPEN,          // Band level above the gate: transformed
+    DSP_GATE_CLOSED,        // Below the gate: not transformed, analyzed as silence
+    DSP_GATE_AUDIT,         // Below the gate but transformed anyway, to check it
+} dsp_gate_t;
+
+// Band spectrum of one frame, handed from the spectrum stage to detection
+typedef struct {
+#if USE_FIXED_POINT
+    uint64_t power[MAX_BAND_BINS];      // fixedBandPower output, band start first
+    int shift;                          // Block shift of the frame
+#else
+    float bins[2 * MAX_BAND_BINS];      // Interleaved [Real, Imag] of the band bins
+#endif
+    const dsp_tables_t *tables;         // Configuration the frame was computed with
+    dsp_gate_t gate;                    // DSP_GATE_CLOSED: no bins
+    float gate_db;                      // Band level the gate measured (dspComputeStreamSpectrum), peak_db scale
+} dsp_spectrum_t;
+
+typedef enum {
+    DSP_CONFIG_OK,
+    DSP_CONFIG_INVALID,     // Out of range (detectorConfigValid)
+    DSP_CONFIG_BUSY,        // The previous change has not reached both stages yet
+} dsp_config_status_t;
+
+/**
+ * @brief Initialize FFT tables and window reference. Call once before use.
+ *
+ * @return true on success
+ */
+bool dspCoreInit(void);
+
+/**
+ * @brief Switch to a new detector configuration. The tables are built here,
+ *        off the hot path; the spectrum stage picks them up on its next frame
+ *        and detection on the first frame computed with them. Per-bin state
+ *        is cleared only when the band or long/short window changes.
+ *        Call from one task at a time.
+ *
+ * @return DSP_CONFIG_BUSY until the previous change has been applied by both stages
+ */
+dsp_config_status_t dspCoreConfigure(const detector_config_t *cfg);
+
+/**
+ * @brief Latest configuration (including one not yet applied)
+ */
+void dspCoreGetConfig(detector_config_t *cfg);
+
+/**
+ * @brief Configurations the spectrum stage could not apply (counted once
+ *        each). Such a set stays pending, so dspCoreConfigure reports
+ *        DSP_CONFIG_BUSY until it applies.
+ */
+uint32_t dspCoreConfigFailures(void);
+
+/**
+ * @brief The core's static buffers, for the memory report (see mem_plan.h)
+ *
+ * @return number of entries written to `out` (up to max)
+ */
+int dspCoreBuffers(mem_block_t *out, int max);
+
+/**
+ * @brief Clear detection state (long-window average and confirmation counter)
+ */
+void dspCoreReset(void);
+
+/**
+ * @brief Run one frame (FRAME_LEN values: FFT_SIZE samples, [I, Q] pairs in
+ *        zoom mode) through the full pipeline and the cadence recognizer
+ *
+ * @return true if a detection was confirmed or a cadence matched on this frame
+ */
+bool dspProcessFrame(const int32_t *samples, dsp_detection_t *result);
+
+/**
+ * @brief Spectrum stage of dspProcessFrame: window and transform one
+ *        frame and keep its band bins. Uses the shared work buffer,
+ *        so only one task may call it.
+ */
+void dspComputeSpectrum(const int32_t *samples, dsp_spectrum_t *spectrum);
+
+/**
+ * @brief Spectrum stage for the stream's current frame (dspStreamFrame must
+ *        be non-NULL), fused over the capture channels, behind the energy
+ *        gate: a frame whose band level is below the gate is not
+ *        transformed unless it is due for an audit. Without
+ *        USE_ENERGY_GATE every frame is transformed.
+ *
+ * @return true if the frame was transformed (open or audit)
+ */
+bool dspComputeStreamSpectrum(dsp_spectrum_t *spectrum);
+
+/**
+ * @brief Transform every `every`-th gated frame anyway (DSP_GATE_AUDIT);
+ *        0 never, 1 all of them. Default GATE_AUDIT_EVERY.
+ */
+void dspGateSetAudit(int every);
+
+/**
+ * @brief Detection stage of dspProcessFrame: threshold or noise floor,
+ *        confirmation and cadence on one band spectrum, in frame order
+ *
+ * @return same as dspProcessFrame
+ */
+bool dspAnalyzeSpectrum(const dsp_spectrum_t *spectrum, dsp_detection_t *result);
+
+/**
+ * @brief Band level of every bin of `spectrum` in dB (full scale sine = 0,
+ *        the scale of peak_db). Call from the detection stage, after
+ *        dspAnalyzeSpectrum on the same spectrum. A gated frame reads its
+ *        gate level spread evenly over the band.
+ *
+ * @return number of bins written (up to MAX_BAND_BINS); `startBin` is the first
+ */
+int dspSpectrumLevels(const dsp_spectrum_t *spectrum, float *level_db, int *startBin);
+
+/**
+ * @brief Stream a capture block of any size (at I2S_SAMPLE_RATE_HZ); it is
+ *        decimated (or zoomed), and the latest FFT_SIZE samples are analyzed
+ *        every HOP_SIZE samples of the analysis rate, behind the energy gate
+ *
+ * @return true if a detection was confirmed or a cadence matched (result
+ *         holds the last such frame, otherwise the last analysis; pattern
+ *         is kept if any frame in the block matched)
+ */
+bool dspProcessBlock(const int32_t *samples, int count, dsp_detection_t *result);
+
+// Sliding analysis frame used by dspProcessBlock; takes capture-rate samples.
+// With CAPTURE_CHANNELS > 1 there is one frame per channel, and the stream
+// spectrum fuses them (each band bin from the louder channel).
+int  dspStreamPush(const int32_t *samples, int count);  // Returns samples consumed; stops when a frame is ready. Same samples to every channel
+int  dspStreamPushChannels(const int32_t *const *channels, int count);  // CAPTURE_CHANNELS buffers of `count` samples; as dspStreamPush
+const int32_t *dspStreamFrame(void);                    // Full frame (first channel), or NULL until HOP_SIZE new samples arrived
+void dspStreamAdvance(void);                            // Slide by HOP_SIZE after analyzing the frame
+void dspStreamReset(void);                              // Discard history (e.g. after dropped capture blocks)
+
+// Individual stages (used by dspProcessFrame and by the host benchmark)
+int  normalizeBuffer(const int32_t *buffer, float *real, int length);
+void applyWindow(float *data, int length);
+void computeSpectrum(float *data, int length);    // FFT of windowed samples (zoom FFT with USE_ZOOM_FFT)
+void computeFFT(float *data, int length);     // Selected by USE_REAL_FFT
+void computeRealFFT(float *data, int length);
+void computeComplexFFT(float *data, int length);
+void computeZoomFFT(float *data, int length);  // In place on `length` interleaved [I, Q] samples
+// analyzeBins: fftData as left by computeSpectrum, its first bin is SPECTRUM_BASE_BIN
+bool analyzeBins(const float *fftData, int startBin, int endBin, float threshold_dB,
+                 dsp_detection_t *result);
+
+// Q15 path (USE_FIXED_POINT): band power from fixedBandPower, threshold of the live configuration
+bool analyzeBinsFixed(const uint64_t *power, int shift, int startBin, int endBin,
+                      dsp_detection_t *result);
@@ -0,0 +1,233 @@
+#include "dsp_decimator.h"
+#include "audio_config.h"
+#include "esp_dsp.h"
+#include <math.h>
+#include <string.h>
+
+#define SAMPLE_SCALE        2147483648.0f   // windowBuild tables are pre-scaled by 1/2^31
+#define LINE_CHUNK          256             // Inputs converted per pass
+#define LINE_LEN            (DECIMATOR_MAX_TAPS + LINE_CHUNK)
+
+// Symmetric (linear phase), so the taps need no reversal for the dot product.
+// Complex output: the low-pass shifted up to the centre frequency, real part
+// in coeffs and imaginary part in coeffsQ, in line order (oldest first).
+static float coeffs[DECIMATOR_MAX_TAPS] DSP_ALIGNED;
+static float coeffsQ[DECIMATOR_MAX_TAPS] DSP_ALIGNED;
+
+// Input history as float, per capture channel. Outputs start at line + k * factor
+// after each compaction, so with a factor of 4 every dot product reads aligned vectors.
+static float line[CAPTURE_CHANNELS][LINE_LEN] DSP_ALIGNED;
+static int lineFill[CAPTURE_CHANNELS];      // Samples in line
+static int lineStart[CAPTURE_CHANNELS];     // First sample of the next output's taps
+
+static int decimFactor = 1;
+static int decimTaps = 0;
+static float decimRate = 0.0f;
+
+// Complex output: after the shifted filter each output is rotated by
+// -rotStep cycles more than the last, which brings the centre frequency
+// to half the output rate
+static bool complexOut = false;
+static double rotStep = 0.0;
+static double rotPhase[CAPTURE_CHANNELS];
+
+
+// Windowed-sinc low-pass into coeffs, normalized to unity DC gain
+static bool designLowPass(int taps, float cutoff_hz, float rate_hz, window_type_t window)
+{
+    if (!windowBuild(window, coeffs, taps, NULL))
+        return false;
+
+    double fc = cutoff_hz / rate_hz;
+    double center = (taps - 1) / 2.0;
+    double total = 0.0;
+    for (int n = 0; n < taps; n++)
+    {
+        double x = n - center;
+        double sinc = x == 0.0 ? 2.0 * fc : sin(2.0 * M_PI * fc * x) / (M_PI * x);
+        double h = sinc * coeffs[n] * SAMPLE_SCALE;
+        coeffs[n] = (float)h;
+        total += h;
+    }
+    for (int n = 0; n < taps; n++)
+        coeffs[n] = (float)(coeffs[n] / total);
+    return true;
+}
+
+static bool validParams(int factor, int taps, float cutoff_hz, float rate_hz)
+{
+    return factor >= 1 && factor <= DECIMATOR_MAX_FACTOR && taps >= factor && taps % 4 == 0 &&
+           taps <= DECIMATOR_MAX_TAPS && cutoff_hz > 0.0f && cutoff_hz < rate_hz / 2.0f;
+}
+
+
+bool decimatorInit(int factor, int taps, float cutoff_hz, float rate_hz, window_type_t window)
+{
+    if (!validParams(factor, taps, cutoff_hz, rate_hz) || !designLowPass(taps, cutoff_hz, rate_hz, window))
+        return false;
+
+    decimFactor = factor;
+    decimTaps = taps;
+    decimRate = rate_hz;
+    complexOut = false;
+    decimatorReset();
+    return true;
+}
+
+
+bool decimatorInitComplex(int factor, int taps, float cutoff_hz, float rate_hz, window_type_t window,
+                          float center_hz)
+{
+    if (!validParams(factor, taps, cutoff_hz, rate_hz) || !(center_hz > 0.0f && center_hz < rate_hz / 2.0f) ||
+        !designLowPass(taps, cutoff_hz, rate_hz, window))
+        return false;
+
+    // Mixing by e^(-jwn) and then filtering is the same as filtering with
+    // h[k] e^(jwk) and rotating the output by e^(-jwn): the mixer only runs
+    // at the output rate. line[i] is the input taps - 1 - i samples back.
+    double w = 2.0 * M_PI * center_hz / rate_hz;
+    for (int i = 0; i < taps; i++)
+    {
+        double h = coeffs[i];
+        coeffs[i]  = (float)(h * cos(w * (taps - 1 - i)));
+        coeffsQ[i] = (float)(h * sin(w * (taps - 1 - i)));
+    }
+
+    // e^(-jw * factor) per output, and e^(j pi) more to centre the band
+    decimFactor = factor;
+    decimTaps = taps;
+    decimRate = rate_hz;
+    complexOut = true;
+    rotStep = center_hz * factor / rate_hz - 0.5;
+    decimatorReset();
+    return true;
+}
+
+
+void decimatorReset(void)
+{
+    // Silent history: the first output is due after `factor` inputs
+    for (int ch = 0; ch < CAPTURE_CHANNELS; ch++)
+    {
+        lineStart[ch] = 0;
+        lineFill[ch] = decimTaps > 0 ? decimTaps - decimFactor : 0;
+        memset(line[ch], 0, lineFill[ch] * sizeof(float));
+        rotPhase[ch] = 0.0;
+    }
+}
+
+
+// Saturate instead of wrapping on the filter's overshoot
+static inline int32_t toSample(float y)
+{
+    if (y >= SAMPLE_SCALE)
+        return INT32_MAX;
+    if (y <= -SAMPLE_SCALE)
+        return INT32_MIN;
+    return (int32_t)lrintf(y);
+}
+
+
+int decimatorPush(const int32_t *in, int count, int32_t *out, int max_out, int *produced)
+{
+    return decimatorPushChannel(0, in, count, out, max_out, produced);
+}
+
+
+int decimatorPushChannel(int channel, const int32_t *in, int count, int32_t *out, int max_out, int *produced)
+{
+    float *hist = line[channel];
+    int fill = lineFill[channel];
+    int start = lineStart[channel];
+    double phase = rotPhase[channel];
+    int used = 0;
+    int done = 0;
+
+    while (used < count && done < max_out)
+    {
+        // Keep the last taps - factor samples in front, plus any partial phase
+        if (fill == LINE_LEN)
+        {
+            memmove(hist, &hist[start], (fill - start) * sizeof(float));
+            fill -= start;
+            start = 0;
+        }
+
+        // Never take input past the last output that fits in `out`
+        int needed = start + decimTaps + (max_out - done - 1) * decimFactor - fill;
+        int n = count - used;
+        if (n > LINE_LEN - fill)
+            n = LINE_LEN - fill;
+        if (n > needed)
+            n = needed;
+
+        // Samples stay in int32 units; the taps are unity gain
+        for (int i = 0; i < n; i++)
+            hist[fill + i] = (float)in[used + i];
+        fill += n;
+        used += n;
+
+        while (fill - start >= decimTaps && done < max_out)
+        {
+            float y;
+            dsps_dotprod_f32(coeffs, &hist[start], &y, decimTaps);
+
+            if (complexOut)
+            {
+                float q;
+                dsps_dotprod_f32(coeffsQ, &hist[start], &q, decimTaps);
+
+                float c = cosf(2.0f * (float)M_PI * (float)phase);
+                float s = sinf(2.0f * (float)M_PI * (float)phase);
+                phase += rotStep;
+                phase -= floor(phase);
+
+                // (y + jq) * (c - js)
+                out[2*done + 0] = toSample(y * c + q * s);
+                out[2*done + 1] = toSample(q * c - y * s);
+            }
+            else
+            {
+                out[done] = toSample(y);
+            }
+            start += decimFactor;
+            done++;
+        }
+    }
+
+    lineFill[channel] = fill;
+    lineStart[channel] = start;
+    rotPhase[channel] = phase;
+    *produced = done;
+    return used;
+}
+
+
+float decimatorResponse(float freq_hz)
+{
+    // A tone e^(j 2 pi f t) comes out scaled by sum c[i] e^(-j 2 pi f (taps - 1 - i) / rate)
+    double re = 0.0, im = 0.0;
+    for (int i = 0; i < decimTaps; i++)
+    {
+        double phase = 2.0 * M_PI * freq_hz / decimRate * (decimTaps - 1 - i);
+        double q = complexOut ? coeffsQ[i] : 0.0;
+        re += coeffs[i] * cos(phase) + q * sin(phase);
+        im += q * cos(phase) - coeffs[i] * sin(phase);
+    }
+    return (float)sqrt(re * re + im * im);
+}
+
+
+int decimatorBuffers(mem_block_t *out, int max)
+{
+    const mem_block_t blocks[] = {
+        { "decimator taps",     coeffs,         sizeof(coeffs) },
+        { "decimator taps (q)", coeffsQ,        sizeof(coeffsQ) },
+        { "decimator history",  line,           sizeof(line) },
+    };
+
+    int count = 0;
+    for (int i = 0; i < (int)(sizeof(blocks) / sizeof(blocks[0])) && count < max; i++)
+        out[count++] = blocks[i];
+    return count;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+/*
+ * Anti-alias FIR decimator between capture and analysis: low-pass the
+ * capture and keep every `factor`-th sample. Only the kept outputs are
+ * computed, each as one dot product of the taps with the latest `taps`
+ * inputs (esp-dsp's dotprod, SIMD on the S3), which is the work of a
+ * polyphase decimator: `taps` multiply-adds per output sample. Filter state
+ * carries across calls, so blocks of any size give the same output as one
+ * long stream.
+ *
+ * Each capture channel (CAPTURE_CHANNELS) has its own history; the filter
+ * is shared. Samples are the capture format (left-justified int32) on both sides.
+ * With decimatorInitComplex the filter is shifted to a centre frequency
+ * and each output is an [I, Q] pair: the band around the centre, mixed
+ * down to the middle of the output rate (the zoom FFT's input).
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "dsp_window.h"
+#include "mem_plan.h"
+
+#define DECIMATOR_MAX_FACTOR    32
+#define DECIMATOR_MAX_TAPS      384
+
+/**
+ * @brief Design a windowed-sinc low-pass (unity gain at DC) with its -6 dB
+ *        point at cutoff_hz, and clear the filter history
+ *
+ * @param taps multiple of 4, at least factor, up to DECIMATOR_MAX_TAPS
+ * @return false if factor, taps or cutoff is out of range
+ */
+bool decimatorInit(int factor, int taps, float cutoff_hz, float rate_hz, window_type_t window);
+
+/**
+ * @brief decimatorInit with the low-pass shifted up to center_hz and
+ *        complex [I, Q] outputs. center_hz comes out at half the output
+ *        rate, so bin k of an N-point FFT of the output is at
+ *        center_hz - rate/factor/2 + k * rate/factor/N; the other side of
+ *        the spectrum (-center_hz) is rejected like the aliases.
+ *
+ * @return false if a parameter is out of range or center_hz is not below Nyquist
+ */
+bool decimatorInitComplex(int factor, int taps, float cutoff_hz, float rate_hz, window_type_t window,
+                          float center_hz);
+
+/**
+ * @brief Clear the filter history of every channel (e.g. after dropped capture blocks)
+ */
+void decimatorReset(void);
+
+/**
+ * @brief Filter and decimate up to `count` input samples, stopping as soon
+ *        as `max_out` outputs were written
+ *
+ * @param produced receives the number of outputs written to `out` (pairs,
+ *        2 * produced values, after decimatorInitComplex)
+ * @return input samples consumed
+ */
+int decimatorPush(const int32_t *in, int count, int32_t *out, int max_out, int *produced);
+
+/**
+ * @brief decimatorPush on the history of capture channel `channel` (0 is decimatorPush's)
+ */
+int decimatorPushChannel(int channel, const int32_t *in, int count, int32_t *out, int max_out, int *produced);
+
+/**
+ * @brief Gain of the designed filter at `freq_hz` (linear, before decimation;
+ *        negative frequencies are the other side of a complex filter)
+ */
+float decimatorResponse(float freq_hz);
+
+/**
+ * @brief The decimator's static buffers, for the memory report (see mem_plan.h)
+ *
+ * @return number of entries written to `out` (up to max)
+ */
+int decimatorBuffers(mem_block_t *out, int max);
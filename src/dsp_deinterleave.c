@@ -0,0 +1,37 @@
+#include "dsp_deinterleave.h"
+#include "mem_plan.h"
+#ifdef ESP_PLATFORM
+    #include "sdkconfig.h"
+#endif
+
+
+void deinterleaveStereo(const int32_t *in, int32_t *left, int32_t *right, int frames)
+{
+    int i = 0;
+
+#if CONFIG_IDF_TARGET_ESP32S3
+    if ((((uintptr_t)in | (uintptr_t)left | (uintptr_t)right) % DSP_ALIGN) == 0)
+    {
+        // q0 = L0 R0 L1 R1, q1 = L2 R2 L3 R3  ->  q0 = L0 L1 L2 L3, q1 = R0 R1 R2 R3
+        for (; i + 4 <= frames; i += 4)
+        {
+            __asm__ volatile (
+                "ee.vld.128.ip  q0, %0, 16\n"
+                "ee.vld.128.ip  q1, %0, 16\n"
+                "ee.vunzip.32   q0, q1\n"
+                "ee.vst.128.ip  q0, %1, 16\n"
+                "ee.vst.128.ip  q1, %2, 16\n"
+                : "+r"(in), "+r"(left), "+r"(right)
+                :
+                : "memory");
+        }
+    }
+#endif
+
+    for (; i < frames; i++)
+    {
+        *left++ = in[0];
+        *right++ = in[1];
+        in += 2;
+    }
+}
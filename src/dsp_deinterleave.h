@@ -0,0 +1,17 @@
+#pragma once
+
+/*
+ * Stereo capture: split interleaved [left, right] I2S frames into one
+ * buffer per channel. On the ESP32-S3 four frames at a time go through the
+ * PIE vector unit (two 128-bit loads, EE.VUNZIP.32, two stores) when all
+ * three buffers are 16-byte aligned; elsewhere, and for the last frames
+ * that do not fill a vector, a plain loop does it. Task context only: the
+ * vector registers are not saved for interrupts.
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief left[i] = in[2i], right[i] = in[2i + 1] for `frames` frames
+ */
+void deinterleaveStereo(const int32_t *in, int32_t *left, int32_t *right, int frames);
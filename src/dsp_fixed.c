@@ -0,0 +1,233 @@
+#include "dsp_fixed.h"
+#include "dsp_core.h"
+#include "esp_dsp.h"
+#include "mem_plan.h"
+#include <math.h>
+#include <stddef.h>
+
+// Split twiddles e^(-j*2*pi*k/N) in Q15, k = 0..N/4
+static int16_t realTwiddleQ15[2 * (FFT_SIZE / 4 + 1)] DSP_ALIGNED;
+
+// Set built by fixedInit, and the sets each stage is using
+static fixed_tables_t defaultTables;
+static const fixed_tables_t *windowTables = &defaultTables;
+static const fixed_tables_t *thresholdTables = &defaultTables;
+
+
+static int16_t toQ15(double v)
+{
+    long q = lround(v * 32768.0);
+    return (int16_t)(q > 32767 ? 32767 : (q < -32768 ? -32768 : q));
+}
+
+static uint64_t toThreshold(double v)
+{
+    return v >= 18446744073709551615.0 ? UINT64_MAX : (uint64_t)ceil(v);
+}
+
+
+static bool validLength(int length)
+{
+    return length >= 4 && length <= FFT_SIZE && (length & (length - 1)) == 0;
+}
+
+
+bool fixedInit(window_type_t type, int length, float threshold_dB)
+{
+    if (!validLength(length))
+        return false;
+
+    if (dsps_fft2r_init_sc16(NULL, length / 2) != ESP_OK)
+        return false;
+
+    if (!fixedBuildTables(&defaultTables, type, length, threshold_dB))
+        return false;
+
+    for (int k = 0; k <= length / 4; k++)
+    {
+        double e = (2.0 * M_PI * k) / length;
+        realTwiddleQ15[2*k + 0] = toQ15(cos(e));
+        realTwiddleQ15[2*k + 1] = toQ15(-sin(e));
+    }
+
+    windowTables = &defaultTables;
+    thresholdTables = &defaultTables;
+    return true;
+}
+
+bool fixedBuildTables(fixed_tables_t *tables, window_type_t type, int length, float threshold_dB)
+{
+    if (!validLength(length))
+        return false;
+
+    if (!windowInitQ15(type, tables->window, length, &tables->window_sum))
+        return false;
+
+    tables->length = length;
+
+    // analyzeBins detects when 2|X| / windowSum > 10^(dB/20); restate that
+    // on |Y| for every block shift so the per-frame test is one compare
+    double level = pow(10.0, threshold_dB / 20.0) * tables->window_sum / 2.0;
+    double y = level / (length / 4) * 2147483648.0;     // |Y| at shift 0
+
+    for (int s = 0; s <= FIXED_MAX_BLOCK_SHIFT; s++)
+    {
+        double ys = ldexp(y, -s);
+        tables->power_threshold[s] = toThreshold(ys * ys);
+    }
+    tables->magnitude_threshold = toThreshold(y);
+
+    return true;
+}
+
+void fixedUseWindow(const fixed_tables_t *tables)
+{
+    windowTables = tables;
+}
+
+void fixedUseThreshold(const fixed_tables_t *tables)
+{
+    thresholdTables = tables;
+}
+
+
+// Shared exponent from the OR of all magnitudes, then shift and window in Q15
+int fixedWindowNormalized(const int32_t *in, int16_t *out, int length)
+{
+    uint32_t bits = 0;
+    for (int i = 0; i < length; i++)
+        bits |= (uint32_t)(in[i] ^ (in[i] >> 31));
+
+    int shift = 0;
+    while ((bits >> shift) >= (1u << FIXED_BLOCK_PEAK_BITS))
+        shift++;
+
+    int i = 0;
+    for (; i + 4 <= length; i += 4)
+    {
+        out[i + 0] = (int16_t)(in[i + 0] >> shift);
+        out[i + 1] = (int16_t)(in[i + 1] >> shift);
+        out[i + 2] = (int16_t)(in[i + 2] >> shift);
+        out[i + 3] = (int16_t)(in[i + 3] >> shift);
+    }
+    for (; i < length; i++)
+        out[i] = (int16_t)(in[i] >> shift);
+
+    dsps_mul_s16(out, windowTables->window, out, length, 1, 1, 1, 15);
+    return shift;
+}
+
+
+void fixedComputeRealFFT(int16_t *data, int length)
+{
+    dsps_fft2r_sc16(data, length / 2);      // FFT of z[k] = x[2k] + j*x[2k+1], scaled by 2/N
+    dsps_bit_rev_sc16(data, length / 2);
+}
+
+
+// Same split as computeRealFFT, evaluated only for the band and without the
+// 1/2 on Fe and Fo. Bins above N/4 use the conjugate-symmetric partner.
+void fixedBandPower(const int16_t *data, int length, int startBin, int endBin, uint64_t *power)
+{
+    int half = length / 2;     // `length` must match fixedInit
+
+    for (int bin = startBin; bin <= endBin; bin++)
+    {
+        int k = bin <= half / 2 ? bin : half - bin;
+        const int16_t *a = &data[2*k];
+        const int16_t *b = &data[2*(half - k)];
+
+        int32_t fe_re = (int32_t)a[0] + b[0];
+        int32_t fe_im = (int32_t)a[1] - b[1];
+        int32_t fo_re = (int32_t)a[1] + b[1];
+        int32_t fo_im = (int32_t)b[0] - a[0];
+
+        // Fo spans 17 bits, so the twiddle products need 64-bit sums
+        int64_t w_re = realTwiddleQ15[2*k + 0];
+        int64_t w_im = realTwiddleQ15[2*k + 1];
+        int64_t t_re = (w_re * fo_re - w_im * fo_im) >> 15;
+        int64_t t_im = (w_re * fo_im + w_im * fo_re) >> 15;
+
+        int64_t y_re = bin == k ? fe_re + t_re : fe_re - t_re;
+        int64_t y_im = bin == k ? fe_im + t_im : t_im - fe_im;
+
+        power[bin - startBin] = (uint64_t)(y_re * y_re + y_im * y_im);
+    }
+}
+
+
+uint64_t fixedPowerThreshold(int shift)
+{
+    return thresholdTables->power_threshold[shift];
+}
+
+
+// Bit-by-bit integer square root; 32 iterations for a 64-bit power
+static uint64_t isqrt64(uint64_t v)
+{
+    uint64_t root = 0;
+    uint64_t bit = 1ull << 62;
+
+    while (bit > v)
+        bit >>= 2;
+
+    while (bit != 0)
+    {
+        if (v >= root + bit)
+        {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+uint64_t fixedMagnitude(uint64_t power, int shift)
+{
+    return isqrt64(power) << shift;
+}
+
+uint64_t fixedMagnitudeThreshold(void)
+{
+    return thresholdTables->magnitude_threshold;
+}
+
+
+// 2|X| / windowSum for a common-scale magnitude, as analyzeBins normalizes it
+static float magnitudeToAmplitude(double magnitude)
+{
+    double mag = magnitude * (thresholdTables->length / 4) / 2147483648.0;
+    return (float)(2.0 * mag / thresholdTables->window_sum);
+}
+
+static float magnitudeToDb(double magnitude)
+{
+    return 20.0f * log10f(magnitudeToAmplitude(magnitude) + 1e-12f);
+}
+
+float fixedPowerToDb(uint64_t power, int shift)
+{
+    return magnitudeToDb(ldexp(sqrt((double)power), shift));
+}
+
+float fixedMagnitudeToDb(uint64_t magnitude)
+{
+    return magnitudeToDb((double)magnitude);
+}
+
+float fixedPowerToLevel(uint64_t power, int shift)
+{
+    float a = magnitudeToAmplitude(ldexp(sqrt((double)power), shift));
+    return a * a;
+}
+
+float fixedMagnitudeToLevel(uint64_t magnitude)
+{
+    float a = magnitudeToAmplitude((double)magnitude);
+    return a * a;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+/*
+ * Fixed-point (Q15) detection path. Each frame is block-scaled into int16
+ * with a shared exponent, windowed and transformed with the scaled sc16 FFT,
+ * and band power is compared against a threshold precomputed as an integer,
+ * so no float work is done per bin. Selected by USE_FIXED_POINT.
+ *
+ * Units: the spectrum of a frame with block shift s, scaled by the FFT's
+ * 1/2 per stage, relates to the float path as
+ *     |X_float| = |Y| * (length / 4) * 2^(s - 31)
+ * where Y is twice the split output (the float split's 1/2 is folded in).
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "dsp_core.h"
+#include "dsp_window.h"
+
+// Block scaling keeps |sample| < 2^14: one bit of headroom for the complex
+// butterflies on top of the FFT's own 1/2 per stage.
+#define FIXED_BLOCK_PEAK_BITS   14
+#define FIXED_MAX_BLOCK_SHIFT   (31 - FIXED_BLOCK_PEAK_BITS)
+
+// Q15 window and integer thresholds for one window type and threshold.
+// The spectrum stage uses the window, the detection stage the thresholds,
+// so each stage switches to a new set on its own frame boundary.
+typedef struct {
+    int16_t window[FFT_SIZE] __attribute__((aligned(16)));  // The S3's sc16 FFT uses 128-bit loads
+    float window_sum;
+    int length;
+    uint64_t power_threshold[FIXED_MAX_BLOCK_SHIFT + 1];    // Per block shift
+    uint64_t magnitude_threshold;
+} fixed_tables_t;
+
+/**
+ * @brief Build the twiddle tables for frames of `length` samples and a
+ *        default window/threshold set for `type` and `threshold_dB`, and
+ *        use that set for both stages
+ *
+ * @return false if the length or window is invalid or the FFT tables fail
+ */
+bool fixedInit(window_type_t type, int length, float threshold_dB);
+
+/**
+ * @brief Build a window/threshold set off the hot path
+ *
+ * @return false if the length or window is invalid
+ */
+bool fixedBuildTables(fixed_tables_t *tables, window_type_t type, int length, float threshold_dB);
+
+// Window used by fixedWindowNormalized
+void fixedUseWindow(const fixed_tables_t *tables);
+
+// Thresholds and scale used by fixedPowerThreshold and the conversions below
+void fixedUseThreshold(const fixed_tables_t *tables);
+
+/**
+ * @brief Block-scale int32 samples into Q15 and apply the window
+ *
+ * @return block shift s: out[i] = (in[i] >> s) * w[i], with |in >> s| < 2^14
+ */
+int fixedWindowNormalized(const int32_t *in, int16_t *out, int length);
+
+/**
+ * @brief In-place N/2-point sc16 FFT of the windowed frame (real samples
+ *        packed as complex pairs), in natural order
+ */
+void fixedComputeRealFFT(int16_t *data, int length);
+
+/**
+ * @brief Split the packed FFT into bins startBin..endBin and return |Y|^2
+ *        per bin in power[0 .. endBin - startBin]
+ */
+void fixedBandPower(const int16_t *data, int length, int startBin, int endBin, uint64_t *power);
+
+// Threshold on |Y|^2 for a frame scaled by `shift`
+uint64_t fixedPowerThreshold(int shift);
+
+// |Y| << shift: magnitude on a common scale so frames can be averaged
+uint64_t fixedMagnitude(uint64_t power, int shift);
+
+// Threshold on fixedMagnitude() values
+uint64_t fixedMagnitudeThreshold(void);
+
+// Reporting only: band level in dB, matching analyzeBins
+float fixedPowerToDb(uint64_t power, int shift);
+float fixedMagnitudeToDb(uint64_t magnitude);
+
+// Band level as linear power (full scale = 1), for the noise floor tracker
+float fixedPowerToLevel(uint64_t power, int shift);
+float fixedMagnitudeToLevel(uint64_t magnitude);
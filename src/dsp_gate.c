@@ -0,0 +1,122 @@
+#include "dsp_gate.h"
+#include "audio_config.h"
+#include "mem_plan.h"
+#include "esp_dsp.h"
+#include <math.h>
+#include <string.h>
+
+#define GATE_CHUNK      64      // Values converted and filtered per pass
+
+static float coeffs[5] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f };  // b0 b1 b2 a1 a2; pass-through until gateSetBand
+static float chunk[GATE_CHUNK] DSP_ALIGNED;
+
+// Per capture channel: filter state and the energy of the latest segments,
+// oldest overwritten once the newest is full
+typedef struct {
+    float delay[2];
+    float energy[GATE_MAX_SEGMENTS];
+    int fill[GATE_MAX_SEGMENTS];
+    int current;
+} gate_channel_t;
+
+static gate_channel_t channels[CAPTURE_CHANNELS];
+static int segments = 1;
+static int segLength = 1;
+static bool complexIn = false;
+
+
+bool gateInit(int length, int segment, bool complex)
+{
+    if (segment < 1 || length % segment != 0 || length / segment < 1 || length / segment > GATE_MAX_SEGMENTS)
+        return false;
+
+    segments = length / segment;
+    segLength = segment;
+    complexIn = complex;
+    gateReset();
+    return true;
+}
+
+
+void gateSetBand(float low_hz, float high_hz, float rate_hz)
+{
+    // Edges prewarped for the bilinear transform, so they come out at -3 dB exactly
+    float low = tanf((float)M_PI * low_hz / rate_hz);
+    float high = tanf((float)M_PI * high_hz / rate_hz);
+    float center = sqrtf(low * high);
+    dsps_biquad_gen_bpf0db_f32(coeffs, atanf(center) / (float)M_PI, center / (high - low));
+    for (int ch = 0; ch < CAPTURE_CHANNELS; ch++)
+        channels[ch].delay[0] = channels[ch].delay[1] = 0.0f;
+}
+
+
+void gateReset(void)
+{
+    memset(channels, 0, sizeof(channels));
+}
+
+
+void gateFeed(const int32_t *samples, int count)
+{
+    gateFeedChannel(0, samples, count);
+}
+
+
+void gateFeedChannel(int channel, const int32_t *samples, int count)
+{
+    const float scale = 1.0f / 2147483648.0f;
+    int words = complexIn ? 2 : 1;
+    gate_channel_t *c = &channels[channel];
+
+    while (count > 0)
+    {
+        // Start a new segment in place of the oldest only when its first sample
+        // arrives, so a full frame is measured until the stream moves on
+        if (c->fill[c->current] == segLength)
+        {
+            c->current = (c->current + 1) % segments;
+            c->energy[c->current] = 0.0f;
+            c->fill[c->current] = 0;
+        }
+
+        int n = segLength - c->fill[c->current];
+        if (n > count)
+            n = count;
+        if (n > GATE_CHUNK / words)
+            n = GATE_CHUNK / words;
+
+        for (int i = 0; i < n * words; i++)
+            chunk[i] = (float)samples[i] * scale;
+        if (!complexIn)
+            dsps_biquad_f32(chunk, chunk, n, coeffs, c->delay);
+
+        float energy;
+        dsps_dotprod_f32(chunk, chunk, &energy, n * words);
+        c->energy[c->current] += energy;
+        c->fill[c->current] += n;
+
+        samples += n * words;
+        count -= n;
+    }
+}
+
+
+float gateLevel(void)
+{
+    float level = 0.0f;
+    for (int ch = 0; ch < CAPTURE_CHANNELS; ch++)
+    {
+        float energy = 0.0f;
+        int fill = 0;
+        for (int s = 0; s < segments; s++)
+        {
+            energy += channels[ch].energy[s];
+            fill += channels[ch].fill[s];
+        }
+
+        // Mean square of a sine is A^2 / 2; of a complex (one-sided) one, A^2 / 4
+        if (fill > 0)
+            level = fmaxf(level, energy * (complexIn ? 4.0f : 2.0f) / fill);
+    }
+    return level;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+/*
+ * Energy gate in front of the spectrum stage: the analysis-rate samples go
+ * through a 2nd-order band-pass over the detection band (esp-dsp's biquad)
+ * and their energy is summed per segment, so the mean band power of the
+ * latest frame costs a few operations per sample and one sum per frame
+ * instead of a transform. Complex (zoom) input is already limited to the
+ * band, so its energy is taken as is.
+ *
+ * The level is on the band-level scale: a full-scale sine in the band is 1.
+ * A sine at the band edges reads 3 dB low. With several capture channels
+ * each is measured on its own and the loudest sets the level.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define GATE_MAX_SEGMENTS   16
+
+/**
+ * @brief Measure over the latest `length` samples (pairs if `complex`),
+ *        summed in segments of `segment`. Band-pass covers 0..Nyquist
+ *        until gateSetBand.
+ *
+ * @return false unless length is 1..GATE_MAX_SEGMENTS segments
+ */
+bool gateInit(int length, int segment, bool complex);
+
+/**
+ * @brief Fit the band-pass to the band: -3 dB at both edges. No effect on
+ *        complex input.
+ */
+void gateSetBand(float low_hz, float high_hz, float rate_hz);
+
+/**
+ * @brief Forget the measured samples and the filter state
+ */
+void gateReset(void);
+
+/**
+ * @brief Filter and measure `count` samples (capture format, left-justified
+ *        int32; [I, Q] pairs if complex)
+ */
+void gateFeed(const int32_t *samples, int count);
+
+/**
+ * @brief gateFeed for capture channel `channel` (0 is gateFeed's)
+ */
+void gateFeedChannel(int channel, const int32_t *samples, int count);
+
+/**
+ * @brief Mean band power of the latest `length` samples fed (full-scale sine = 1),
+ *        of the loudest channel
+ */
+float gateLevel(void);
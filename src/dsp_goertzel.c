@@ -0,0 +1,205 @@
+#include "dsp_goertzel.h"
+#include <math.h>
+#include <string.h>
+
+#define SAMPLE_SCALE    (1.0f / 2147483648.0f)      // Same scale as the window tables
+#define MAX_RAW_BINS    (GOERTZEL_MAX_BINS + 2 * (WINDOW_TERMS - 1))
+
+// Hop sums of one stream (or of a standalone frame): [Re, Im] per filtered
+// bin, per hop slot, oldest slot first from `oldest`
+typedef struct {
+    float sums[GOERTZEL_MAX_SEGMENTS][2 * MAX_RAW_BINS];
+    bool valid[GOERTZEL_MAX_SEGMENTS];
+    int oldest;
+} hop_sums_t;
+
+// Per-filter constants, structure-of-arrays so the inner loop runs across filters
+static float gCoeff[MAX_RAW_BINS];      // 2*cos(w)
+static float gEndCos[MAX_RAW_BINS];     // e^(-jw(L-1)) and e^(-jwL) turn the final state into the hop's sum
+static float gEndSin[MAX_RAW_BINS];
+static float gLenCos[MAX_RAW_BINS];
+static float gLenSin[MAX_RAW_BINS];
+static int gRot[MAX_RAW_BINS];          // Bin index mod segments: hop j of a frame is rotated by e^(-j2π k j / segments)
+
+static float rotCos[GOERTZEL_MAX_SEGMENTS];
+static float rotSin[GOERTZEL_MAX_SEGMENTS];
+static float kernel[WINDOW_TERMS];      // a0, then -a1/2, +a2/2, ... for bins k±1, k±2, ...
+
+static hop_sums_t streams[CAPTURE_CHANNELS + 1];   // Last one: standalone frames
+static float frameBins[2 * MAX_RAW_BINS];
+
+static int gStartBin = 0;
+static int gEndBin = -1;
+static int gRawStart = 0;
+static int gRawCount = 0;
+static int gTerms = 1;
+static int gHop = 1;
+static int gSegments = 1;
+
+
+bool goertzelInit(int startBin, int endBin, int length, int hop, window_type_t window)
+{
+    float terms[WINDOW_TERMS];
+    int termCount = windowCosineTerms(window, terms);
+    if (termCount == 0 || hop < 1 || length % hop != 0 || length / hop > GOERTZEL_MAX_SEGMENTS)
+        return false;
+
+    int rawStart = startBin - (termCount - 1);
+    int rawEnd = endBin + (termCount - 1);
+    if (rawStart < 0 || endBin < startBin || rawEnd >= length / 2 || endBin - startBin + 1 > GOERTZEL_MAX_BINS)
+        return false;
+
+    for (int b = 0; b <= rawEnd - rawStart; b++)
+    {
+        int k = rawStart + b;
+        double w = 2.0 * M_PI * k / length;
+        gCoeff[b]  = (float)(2.0 * cos(w));
+        gEndCos[b] = (float)cos(w * (hop - 1));
+        gEndSin[b] = (float)sin(w * (hop - 1));
+        gLenCos[b] = (float)cos(w * hop);
+        gLenSin[b] = (float)sin(w * hop);
+        gRot[b]    = k % (length / hop);
+    }
+
+    gSegments = length / hop;
+    for (int r = 0; r < gSegments; r++)
+    {
+        rotCos[r] = (float)cos(2.0 * M_PI * r / gSegments);
+        rotSin[r] = (float)sin(2.0 * M_PI * r / gSegments);
+    }
+
+    // x * (a0 - a1 cos + a2 cos2 - ...) in time is a0 X[k] - a1/2 (X[k-1] + X[k+1]) + ...
+    kernel[0] = terms[0];
+    for (int i = 1; i < termCount; i++)
+        kernel[i] = (i % 2 ? -0.5f : 0.5f) * terms[i];
+
+    gStartBin = startBin;
+    gEndBin = endBin;
+    gRawStart = rawStart;
+    gRawCount = rawEnd - rawStart + 1;
+    gTerms = termCount;
+    gHop = hop;
+    goertzelReset();
+    return true;
+}
+
+void goertzelReset(void)
+{
+    memset(streams, 0, sizeof(streams));
+}
+
+
+// Sum of one hop per filtered bin, as if the hop started at time 0:
+// s[n] = x[n] + 2cos(w) * s[n-1] - s[n-2], then sum = e^(-jw(L-1)) s[L-1] - e^(-jwL) s[L-2].
+// Eight filters per pass keep their state in registers and hide the FPU's
+// multiply-add latency, and each sample is converted once per eight bins.
+#define GROUP   8
+
+static void sumHop(const int32_t *x, float *sums)
+{
+    for (int b = 0; b < gRawCount; b += GROUP)
+    {
+        float c[GROUP], p[GROUP] = {0}, q[GROUP] = {0};
+        int n = gRawCount - b < GROUP ? gRawCount - b : GROUP;
+        for (int i = 0; i < GROUP; i++)
+            c[i] = i < n ? gCoeff[b + i] : 0.0f;
+
+        for (int m = 0; m < gHop; m++)
+        {
+            float v = (float)x[m] * SAMPLE_SCALE;
+            for (int i = 0; i < GROUP; i++)
+            {
+                float s = v + c[i] * p[i] - q[i];
+                q[i] = p[i];
+                p[i] = s;
+            }
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            sums[2*(b + i) + 0] = p[i] * gEndCos[b + i] - q[i] * gLenCos[b + i];
+            sums[2*(b + i) + 1] = q[i] * gLenSin[b + i] - p[i] * gEndSin[b + i];
+        }
+    }
+}
+
+
+// Sum the frame's missing hops, rotate every hop into place, apply the window
+static void bankFrame(hop_sums_t *h, const int32_t *frame, float *fftData)
+{
+    memset(frameBins, 0, 2 * gRawCount * sizeof(float));
+
+    for (int j = 0; j < gSegments; j++)
+    {
+        int slot = (h->oldest + j) % gSegments;
+        if (!h->valid[slot])
+        {
+            sumHop(&frame[j * gHop], h->sums[slot]);
+            h->valid[slot] = true;
+        }
+
+        const float *sums = h->sums[slot];
+        for (int b = 0; b < gRawCount; b++)
+        {
+            int r = (gRot[b] * j) % gSegments;
+            float re = sums[2*b], im = sums[2*b + 1];
+            frameBins[2*b + 0] += re * rotCos[r] + im * rotSin[r];
+            frameBins[2*b + 1] += im * rotCos[r] - re * rotSin[r];
+        }
+    }
+
+    for (int k = gStartBin; k <= gEndBin; k++)
+    {
+        const float *center = &frameBins[2 * (k - gRawStart)];
+        float re = kernel[0] * center[0];
+        float im = kernel[0] * center[1];
+        for (int i = 1; i < gTerms; i++)
+        {
+            re += kernel[i] * (center[-2*i] + center[2*i]);
+            im += kernel[i] * (center[-2*i + 1] + center[2*i + 1]);
+        }
+        fftData[2*k + 0] = re;
+        fftData[2*k + 1] = im;
+    }
+}
+
+void goertzelFrame(const int32_t *frame, float *fftData)
+{
+    hop_sums_t *h = &streams[CAPTURE_CHANNELS];
+    memset(h->valid, 0, sizeof(h->valid));
+    bankFrame(h, frame, fftData);
+}
+
+void goertzelStreamFrame(int channel, const int32_t *frame, float *fftData)
+{
+    bankFrame(&streams[channel], frame, fftData);
+}
+
+void goertzelAdvance(void)
+{
+    for (int ch = 0; ch < CAPTURE_CHANNELS; ch++)
+    {
+        hop_sums_t *h = &streams[ch];
+        h->valid[h->oldest] = false;        // Becomes the newest slot
+        h->oldest = (h->oldest + 1) % gSegments;
+    }
+}
+
+
+float goertzelWindowSum(window_type_t window, int length)
+{
+    float terms[WINDOW_TERMS];
+    return windowCosineTerms(window, terms) > 0 ? terms[0] * length : 0.0f;
+}
+
+int goertzelBuffers(mem_block_t *out, int max)
+{
+    const mem_block_t blocks[] = {
+        { "goertzel hop sums",  streams,        sizeof(streams) },
+    };
+
+    int count = 0;
+    for (int i = 0; i < (int)(sizeof(blocks) / sizeof(blocks[0])) && count < max; i++)
+        out[count++] = blocks[i];
+    return count;
+}
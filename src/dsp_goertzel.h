@@ -0,0 +1,69 @@
+#pragma once
+
+/*
+ * Goertzel filter bank over the detection band. Produces the same
+ * interleaved [Re, Im] bins as the FFT for startBin..endBin only, so
+ * analyzeBins runs unchanged on its output.
+ *
+ * The bank works on raw samples, one hop at a time: each hop is filtered
+ * once per bin into a partial DFT sum, and a frame's bins are its hops'
+ * sums rotated to their place in the frame. With overlapping frames only
+ * the newest hop is filtered per frame; the rest were summed for earlier
+ * frames. The window is applied per bin, as the cosine-sum kernel over
+ * the neighbouring bins (the periodic form of windowBuild's window), so
+ * the bank also filters the few bins either side of the band.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "audio_config.h"
+#include "dsp_window.h"
+#include "mem_plan.h"
+
+#define GOERTZEL_MAX_BINS       128
+#define GOERTZEL_MAX_SEGMENTS   4       // Hops per frame (FRAME_OVERLAP_PCT up to 75)
+
+/**
+ * @brief Set up the bank for bins startBin..endBin of frames of `length`
+ *        samples, made of `hop`-sample hops, under `window`
+ *
+ * @return false if the band (plus the window's neighbouring bins) is empty,
+ *         out of range or wider than GOERTZEL_MAX_BINS, or `hop` does not
+ *         split the frame into 1..GOERTZEL_MAX_SEGMENTS hops
+ */
+bool goertzelInit(int startBin, int endBin, int length, int hop, window_type_t window);
+
+/**
+ * @brief Forget the hop sums kept for the stream (its history was discarded)
+ */
+void goertzelReset(void);
+
+/**
+ * @brief Windowed bins of one standalone frame (capture format, `length`
+ *        samples) into `fftData` (interleaved, absolute bin index); every
+ *        hop is filtered
+ */
+void goertzelFrame(const int32_t *frame, float *fftData);
+
+/**
+ * @brief goertzelFrame for the stream's frame of capture channel `channel`:
+ *        hops already summed for an earlier frame are reused
+ */
+void goertzelStreamFrame(int channel, const int32_t *frame, float *fftData);
+
+/**
+ * @brief The stream moved on by one hop (every channel), analyzed or not
+ */
+void goertzelAdvance(void);
+
+/**
+ * @brief Coherent sum of the window the bank applies over `length` samples
+ */
+float goertzelWindowSum(window_type_t window, int length);
+
+/**
+ * @brief The bank's static buffers, for the memory report (see mem_plan.h)
+ *
+ * @return number of entries written to `out` (up to max)
+ */
+int goertzelBuffers(mem_block_t *out, int max);
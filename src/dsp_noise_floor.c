@@ -0,0 +1,96 @@
+#include "dsp_noise_floor.h"
+#include "dsp_core.h"
+#include <math.h>
+
+// Smoothing of the per-frame power before taking minima (about 3 hops)
+#define SMOOTHING               0.7f
+#define WARMUP_FRAMES           4       // Let the smoother settle: one raw deep fade would pin a bin's floor for a window
+
+// The minimum of smoothed noise power sits below its mean; this restores
+// the mean (measured on white noise at 75% overlap, see test_noise_floor)
+#define MIN_BIAS                5.0f    // ~7 dB
+
+static float smoothed[MAX_BAND_BINS];
+static float runningMin[MAX_BAND_BINS];                         // Current sub-window
+static float subwindowMin[NOISE_FLOOR_SUBWINDOWS][MAX_BAND_BINS];
+static float floorPower[MAX_BAND_BINS];
+
+static int floorBins = 0;
+static int subwindowFrames = 1;
+static int frameInSubwindow = 0;
+static int subwindowNext = 0;
+static int framesSeen = 0;
+
+
+bool noiseFloorInit(int bins, int subwindow_frames)
+{
+    if (bins < 1 || bins > MAX_BAND_BINS || subwindow_frames < 1)
+        return false;
+
+    floorBins = bins;
+    subwindowFrames = subwindow_frames;
+    noiseFloorReset();
+    return true;
+}
+
+void noiseFloorReset(void)
+{
+    for (int i = 0; i < MAX_BAND_BINS; i++)
+    {
+        runningMin[i] = INFINITY;
+        floorPower[i] = INFINITY;
+        for (int k = 0; k < NOISE_FLOOR_SUBWINDOWS; k++)
+            subwindowMin[k][i] = INFINITY;
+    }
+    frameInSubwindow = 0;
+    subwindowNext = 0;
+    framesSeen = 0;
+}
+
+
+void noiseFloorUpdate(const float *power)
+{
+    bool primed = framesSeen > 0;
+    if (framesSeen < WARMUP_FRAMES)
+        framesSeen++;
+
+    for (int i = 0; i < floorBins; i++)
+    {
+        float s = primed ? SMOOTHING * smoothed[i] + (1.0f - SMOOTHING) * power[i] : power[i];
+        smoothed[i] = s;
+
+        if (framesSeen < WARMUP_FRAMES)
+            continue;
+
+        if (s < runningMin[i])
+            runningMin[i] = s;
+
+        float m = runningMin[i];
+        for (int k = 0; k < NOISE_FLOOR_SUBWINDOWS; k++)
+            if (subwindowMin[k][i] < m)
+                m = subwindowMin[k][i];
+
+        floorPower[i] = m * MIN_BIAS;
+    }
+
+    if (framesSeen < WARMUP_FRAMES)
+        return;
+
+    // Rotate: the oldest sub-window drops out, the new one starts from the current level
+    if (++frameInSubwindow >= subwindowFrames)
+    {
+        for (int i = 0; i < floorBins; i++)
+        {
+            subwindowMin[subwindowNext][i] = runningMin[i];
+            runningMin[i] = smoothed[i];
+        }
+        subwindowNext = (subwindowNext + 1) % NOISE_FLOOR_SUBWINDOWS;
+        frameInSubwindow = 0;
+    }
+}
+
+
+float noiseFloorPower(int i)
+{
+    return floorPower[i];
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+/*
+ * Per-bin noise floor over the detection band by minimum statistics: each
+ * bin's power is smoothed over a few hops, and the floor is the minimum of
+ * the smoothed power over the last NOISE_FLOOR_WINDOW_S seconds, kept as
+ * NOISE_FLOOR_SUBWINDOWS running minima so each update is O(bins). Pulsed
+ * alarms leave gaps, so they never raise the floor; a steady tone or a
+ * louder room is absorbed after one window.
+ */
+
+#include <stdbool.h>
+
+#define NOISE_FLOOR_SUBWINDOWS   4
+
+/**
+ * @brief Track `bins` band bins; the window is NOISE_FLOOR_SUBWINDOWS
+ *        sub-windows of `subwindow_frames` updates
+ *
+ * @return false if bins exceeds MAX_BAND_BINS or subwindow_frames < 1
+ */
+bool noiseFloorInit(int bins, int subwindow_frames);
+
+/**
+ * @brief Forget the floor; nothing is above it until the next update
+ */
+void noiseFloorReset(void);
+
+/**
+ * @brief Add one frame of band power (linear, full scale = 1), power[0] is the first band bin
+ */
+void noiseFloorUpdate(const float *power);
+
+/**
+ * @brief Estimated mean noise power of band bin `i` (minimum corrected for its bias)
+ */
+float noiseFloorPower(int i);
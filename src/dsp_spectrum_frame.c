@@ -0,0 +1,86 @@
+#include "dsp_spectrum_frame.h"
+#include <math.h>
+#include <string.h>
+
+
+uint8_t spectrumQuantize(float level_db)
+{
+    float code = (level_db - SPECTRUM_DB_FLOOR) / SPECTRUM_DB_STEP + 0.5f;
+
+    // Also maps NaN to 0
+    if (!(code > 0.0f))
+        return 0;
+    if (code >= 255.0f)
+        return 255;
+    return (uint8_t)code;
+}
+
+
+static void putU16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static uint16_t getU16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+
+size_t spectrumFrameEncode(const float *level_db, int count, int startBin, float bin_hz,
+                           uint16_t seq, bool delta, uint8_t *out, size_t size)
+{
+    size_t length = SPECTRUM_FRAME_HEADER + (size_t)count;
+    if (count < 0 || count > 0xFFFF || startBin < 0 || length > size)
+        return 0;
+
+    uint32_t hz;
+    memcpy(&hz, &bin_hz, sizeof(hz));
+
+    out[0] = SPECTRUM_FRAME_VERSION;
+    out[1] = delta ? SPECTRUM_FLAG_DELTA : 0;
+    putU16(&out[2], seq);
+    putU16(&out[4], (uint16_t)startBin);
+    putU16(&out[6], (uint16_t)count);
+    putU16(&out[8], (uint16_t)hz);
+    putU16(&out[10], (uint16_t)(hz >> 16));
+
+    uint8_t *levels = &out[SPECTRUM_FRAME_HEADER];
+    uint8_t previous = 0;
+    for (int i = 0; i < count; i++)
+    {
+        uint8_t code = spectrumQuantize(level_db[i]);
+        levels[i] = delta ? (uint8_t)(code - previous) : code;
+        previous = code;
+    }
+
+    return length;
+}
+
+
+int spectrumFrameDecode(const uint8_t *frame, size_t length, float *level_db, int max,
+                        int *startBin, uint16_t *seq)
+{
+    if (length < SPECTRUM_FRAME_HEADER || frame[0] != SPECTRUM_FRAME_VERSION)
+        return -1;
+
+    int count = getU16(&frame[6]);
+    if (count > max || length != SPECTRUM_FRAME_HEADER + (size_t)count)
+        return -1;
+
+    bool delta = frame[1] & SPECTRUM_FLAG_DELTA;
+    uint8_t code = 0;
+    for (int i = 0; i < count; i++)
+    {
+        uint8_t b = frame[SPECTRUM_FRAME_HEADER + i];
+        code = delta ? (uint8_t)(code + b) : b;
+        level_db[i] = SPECTRUM_DB_FLOOR + code * SPECTRUM_DB_STEP;
+    }
+
+    if (startBin != NULL)
+        *startBin = getU16(&frame[4]);
+    if (seq != NULL)
+        *seq = getU16(&frame[2]);
+    return count;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+/*
+ * Binary frame for the live spectrum stream: one byte per bin, the level
+ * quantized to SPECTRUM_DB_STEP above SPECTRUM_DB_FLOOR. With
+ * SPECTRUM_FLAG_DELTA every byte after the first holds the change from the
+ * previous bin (mod 256), which stays small across a smooth spectrum.
+ *
+ * Layout, little-endian:
+ *   0  u8   version (SPECTRUM_FRAME_VERSION)
+ *   1  u8   flags
+ *   2  u16  sequence number (per client; gaps are dropped frames)
+ *   4  u16  first bin
+ *   6  u16  bin count
+ *   8  f32  bin spacing in Hz
+ *  12  u8   levels[count]
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SPECTRUM_FRAME_VERSION  1
+#define SPECTRUM_FRAME_HEADER   12
+#define SPECTRUM_FLAG_DELTA     0x01
+
+#define SPECTRUM_DB_FLOOR       -127.5f     // Level of code 0; lower levels clamp to it
+#define SPECTRUM_DB_STEP        0.5f        // Code 255 is 0 dB (full scale sine)
+
+/**
+ * @brief Level in dB to its 8-bit code (clamped)
+ */
+uint8_t spectrumQuantize(float level_db);
+
+/**
+ * @brief Write a frame of `count` levels starting at `startBin`
+ *
+ * @return frame length, or 0 if it does not fit in `size`
+ */
+size_t spectrumFrameEncode(const float *level_db, int count, int startBin, float bin_hz,
+                           uint16_t seq, bool delta, uint8_t *out, size_t size);
+
+/**
+ * @brief Read a frame back into dB levels (host tools and tests)
+ *
+ * @return bin count, or -1 if the frame is malformed or has more than `max` bins
+ */
+int spectrumFrameDecode(const uint8_t *frame, size_t length, float *level_db, int max,
+                        int *startBin, uint16_t *seq);
@@ -0,0 +1,158 @@
+#include "dsp_window.h"
+#include "dsp_core.h"
+#include <math.h>
+#include <stddef.h>
+
+// Coefficients pre-multiplied by 1/2^31 so the fused pass is one multiply per
+// sample. The scale is a power of two, so windowApply can undo it exactly.
+#define SAMPLE_SCALE        (1.0f / 2147483648.0f)   // 2³¹
+
+static float windowTable[FFT_SIZE] __attribute__((aligned(16)));
+static float windowCoherentSum = 0.0f;
+static window_type_t windowCurrent = WINDOW_HAMMING;
+
+// Generalized cosine-sum coefficients: w = a0 - a1 cos(x) + a2 cos(2x) - a3 cos(3x) + a4 cos(4x)
+static const double windowCoeffs[WINDOW_COUNT][WINDOW_TERMS] = {
+    [WINDOW_HAMMING]         = { 0.54,       0.46,       0.0,         0.0,         0.0 },
+    [WINDOW_HANN]            = { 0.5,        0.5,        0.0,         0.0,         0.0 },
+    [WINDOW_BLACKMAN_HARRIS] = { 0.35875,    0.48829,    0.14128,     0.01168,     0.0 },
+    [WINDOW_FLAT_TOP]        = { 0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368 },
+};
+
+static const char *windowNames[WINDOW_COUNT] = {
+    [WINDOW_HAMMING]         = "hamming",
+    [WINDOW_HANN]            = "hann",
+    [WINDOW_BLACKMAN_HARRIS] = "blackman-harris",
+    [WINDOW_FLAT_TOP]        = "flat-top",
+};
+
+
+static double windowValue(window_type_t type, int n, int length)
+{
+    const double *a = windowCoeffs[type];
+    double x = (2.0 * M_PI * n) / (length - 1);   // Symmetric, as before
+    return a[0] - a[1] * cos(x) + a[2] * cos(2.0 * x) - a[3] * cos(3.0 * x) + a[4] * cos(4.0 * x);
+}
+
+
+int windowCosineTerms(window_type_t type, float terms[WINDOW_TERMS])
+{
+    if ((unsigned)type >= WINDOW_COUNT)
+        return 0;
+
+    int count = 0;
+    for (int i = 0; i < WINDOW_TERMS; i++)
+    {
+        terms[i] = (float)windowCoeffs[type][i];
+        if (terms[i] != 0.0f)
+            count = i + 1;
+    }
+    return count;
+}
+
+
+bool windowBuild(window_type_t type, float *table, int length, float *sum)
+{
+    if ((unsigned)type >= WINDOW_COUNT || length < 2)
+        return false;
+
+    double total = 0.0;
+
+    for (int n = 0; n < length; n++)
+    {
+        double w = windowValue(type, n, length);
+        table[n] = (float)w * SAMPLE_SCALE;
+        total += w;
+    }
+
+    if (sum != NULL)
+        *sum = (float)total;
+    return true;
+}
+
+bool windowInit(window_type_t type, int length)
+{
+    if (length > FFT_SIZE || !windowBuild(type, windowTable, length, &windowCoherentSum))
+        return false;
+
+    windowCurrent = type;
+    return true;
+}
+
+bool windowInitQ15(window_type_t type, int16_t *table, int length, float *sum)
+{
+    if ((unsigned)type >= WINDOW_COUNT || length < 2 || length > FFT_SIZE)
+        return false;
+
+    double total = 0.0;
+
+    for (int n = 0; n < length; n++)
+    {
+        long q = lround(windowValue(type, n, length) * 32768.0);
+        table[n] = (int16_t)(q > 32767 ? 32767 : (q < -32768 ? -32768 : q));
+        total += table[n] / 32768.0;
+    }
+
+    if (sum != NULL)
+        *sum = (float)total;
+    return true;
+}
+
+float windowSum(void)
+{
+    return windowCoherentSum;
+}
+
+window_type_t windowType(void)
+{
+    return windowCurrent;
+}
+
+const char *windowName(window_type_t type)
+{
+    return (unsigned)type < WINDOW_COUNT ? windowNames[type] : "unknown";
+}
+
+
+// Unrolled by 4 so the host compiler vectorizes it and the Xtensa core can
+// keep its load/convert/multiply pipeline full.
+void windowApplyTable(const float *table, const int32_t *in, float *out, int length)
+{
+    const float *w = table;
+    int i = 0;
+
+    for (; i + 4 <= length; i += 4)
+    {
+        out[i + 0] = (float)in[i + 0] * w[i + 0];
+        out[i + 1] = (float)in[i + 1] * w[i + 1];
+        out[i + 2] = (float)in[i + 2] * w[i + 2];
+        out[i + 3] = (float)in[i + 3] * w[i + 3];
+    }
+    for (; i < length; i++)
+        out[i] = (float)in[i] * w[i];
+}
+
+void windowApplyNormalized(const int32_t *in, float *out, int length)
+{
+    windowApplyTable(windowTable, in, out, length);
+}
+
+void windowApplyTableComplex(const float *table, const int32_t *in, float *out, int length)
+{
+    for (int i = 0; i < length; i++)
+    {
+        out[2*i + 0] = (float)in[2*i + 0] * table[i];
+        out[2*i + 1] = (float)in[2*i + 1] * table[i];
+    }
+}
+
+void windowApplyNormalizedComplex(const int32_t *in, float *out, int length)
+{
+    windowApplyTableComplex(windowTable, in, out, length);
+}
+
+void windowApply(float *data, int length)
+{
+    for (int i = 0; i < length; i++)
+        data[i] *= windowTable[i] * 2147483648.0f;
+}
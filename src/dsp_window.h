@@ -0,0 +1,87 @@
+#pragma once
+
+/*
+ * Window engine: coefficient tables are built once and applied together
+ * with int32 -> float normalization in a single pass over the frame.
+ * windowInit builds the module's own table; the detection pipeline keeps
+ * tables of its own (windowBuild) so the next one can be prepared while
+ * the current one is in use.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    WINDOW_HAMMING,
+    WINDOW_HANN,
+    WINDOW_BLACKMAN_HARRIS,     // 4-term, -92 dB sidelobes
+    WINDOW_FLAT_TOP,            // Amplitude-accurate, wide main lobe
+    WINDOW_COUNT
+} window_type_t;
+
+#define WINDOW_TERMS    5       // Most cosine terms of any window_type_t
+
+/**
+ * @brief Build the coefficient table for `type` over `length` samples
+ *
+ * @return false if type or length is invalid (table keeps its previous contents)
+ */
+bool windowInit(window_type_t type, int length);
+
+/**
+ * @brief Build a table of `length` entries for windowApplyTable (pre-scaled
+ *        like the module's own, any length); `sum` receives the coherent sum
+ *        of the coefficients
+ *
+ * Does not touch the table used by windowApply*.
+ */
+bool windowBuild(window_type_t type, float *table, int length, float *sum);
+
+/**
+ * @brief Build a Q15 coefficient table for the fixed-point pipeline; `sum`
+ *        receives the coherent sum of the quantized coefficients
+ *
+ * Does not touch the float table used by windowApply*.
+ */
+bool windowInitQ15(window_type_t type, int16_t *table, int length, float *sum);
+
+/**
+ * @brief Sum of the window coefficients (coherent gain * length)
+ */
+float windowSum(void);
+
+window_type_t windowType(void);
+const char *windowName(window_type_t type);
+
+/**
+ * @brief Cosine-sum coefficients of `type`: w = a0 - a1 cos(x) + a2 cos(2x) - ...
+ *
+ * @return number of terms up to the last non-zero one, 0 if type is invalid
+ */
+int windowCosineTerms(window_type_t type, float terms[WINDOW_TERMS]);
+
+/**
+ * @brief out[i] = in[i] / 2^31 * w[i], `length` must match windowInit
+ */
+void windowApplyNormalized(const int32_t *in, float *out, int length);
+
+/**
+ * @brief windowApplyNormalized with a table from windowBuild
+ */
+void windowApplyTable(const float *table, const int32_t *in, float *out, int length);
+
+/**
+ * @brief windowApplyNormalized on `length` interleaved [I, Q] samples
+ *        (2 * length values in and out)
+ */
+void windowApplyNormalizedComplex(const int32_t *in, float *out, int length);
+
+/**
+ * @brief windowApplyNormalizedComplex with a table from windowBuild
+ */
+void windowApplyTableComplex(const float *table, const int32_t *in, float *out, int length);
+
+/**
+ * @brief data[i] *= w[i] on already-normalized float samples
+ */
+void windowApply(float *data, int length);
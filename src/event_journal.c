@@ -0,0 +1,326 @@
+#include "event_journal.h"
+#include <string.h>
+
+#define SECTOR_MAGIC        0x314A4145u     // "EAJ1"
+#define SECTOR_HEADER_SIZE  16
+#define READ_CHUNK_RECORDS  8
+
+// Start of every sector in use, written right after its erase
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t sector_seq;    // Increases by one per sector started
+    uint32_t first_seq;     // Seq of the first record written here
+    uint16_t boot;          // Mount count when the sector was started
+    uint16_t check;
+} sector_header_t;
+
+_Static_assert(sizeof(sector_header_t) == SECTOR_HEADER_SIZE, "sector header must stay 16 bytes");
+
+typedef bool (*record_visit_t)(const journal_record_t *record, void *arg);
+
+
+static uint8_t crc8(const uint8_t *data, size_t length)
+{
+    uint8_t crc = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++)
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+static uint16_t headerCheck(const sector_header_t *h)
+{
+    return (uint16_t)~(h->sector_seq ^ (h->sector_seq >> 16) ^ h->first_seq ^ (h->first_seq >> 16) ^ h->boot);
+}
+
+static bool recordValid(const journal_record_t *r)
+{
+    return r->crc == crc8((const uint8_t *)r, JOURNAL_RECORD_SIZE - 1);
+}
+
+static bool recordErased(const journal_record_t *r)
+{
+    const uint8_t *bytes = (const uint8_t *)r;
+    for (int i = 0; i < JOURNAL_RECORD_SIZE; i++)
+    {
+        if (bytes[i] != 0xFF)
+            return false;
+    }
+    return true;
+}
+
+static uint32_t recordsPerSector(const journal_t *j)
+{
+    return (j->flash.sector_size - SECTOR_HEADER_SIZE) / JOURNAL_RECORD_SIZE;
+}
+
+static bool readHeader(const journal_t *j, uint32_t sector, sector_header_t *h)
+{
+    if (!j->flash.read(j->flash.ctx, sector * j->flash.sector_size, h, sizeof(*h)))
+        return false;
+    return h->magic == SECTOR_MAGIC && h->check == headerCheck(h);
+}
+
+
+// Erase `sector` and make it the head; its first record will be `first_seq`
+static bool startSector(journal_t *j, uint32_t sector, uint32_t first_seq)
+{
+    sector_header_t h = {
+        .magic = SECTOR_MAGIC,
+        .sector_seq = j->sector_seq + 1,
+        .first_seq = first_seq,
+        .boot = j->boot,
+    };
+    h.check = headerCheck(&h);
+
+    uint32_t offset = sector * j->flash.sector_size;
+    if (!j->flash.erase(j->flash.ctx, offset, j->flash.sector_size) ||
+        !j->flash.write(j->flash.ctx, offset, &h, sizeof(h)))
+        return false;
+
+    j->head_sector = sector;
+    j->head_offset = SECTOR_HEADER_SIZE;
+    j->sector_seq = h.sector_seq;
+    return true;
+}
+
+
+// Visit stored, then buffered records with seq > after_seq, oldest first,
+// until `visit` returns false
+static void forEachRecord(const journal_t *j, uint32_t after_seq, record_visit_t visit, void *arg)
+{
+    journal_record_t chunk[READ_CHUNK_RECORDS];
+    uint32_t perSector = recordsPerSector(j);
+
+    // The sector after the head is the oldest once the ring has wrapped
+    for (uint32_t n = 1; n <= j->sectors; n++)
+    {
+        uint32_t sector = (j->head_sector + n) % j->sectors;
+        sector_header_t h;
+        if (!readHeader(j, sector, &h) || h.sector_seq > j->sector_seq)
+            continue;
+
+        // Seqs in a sector are increasing and at most perSector of them
+        if (h.first_seq + perSector - 1 <= after_seq)
+            continue;
+
+        uint32_t end = sector == j->head_sector ? j->head_offset : j->flash.sector_size;
+        for (uint32_t offset = SECTOR_HEADER_SIZE; offset + JOURNAL_RECORD_SIZE <= end; )
+        {
+            uint32_t count = (end - offset) / JOURNAL_RECORD_SIZE;
+            if (count > READ_CHUNK_RECORDS)
+                count = READ_CHUNK_RECORDS;
+            if (!j->flash.read(j->flash.ctx, sector * j->flash.sector_size + offset, chunk,
+                               count * JOURNAL_RECORD_SIZE))
+                break;
+            offset += count * JOURNAL_RECORD_SIZE;
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                if (recordErased(&chunk[i]))
+                {
+                    offset = end;
+                    break;
+                }
+                if (recordValid(&chunk[i]) && chunk[i].seq > after_seq && !visit(&chunk[i], arg))
+                    return;
+            }
+        }
+    }
+
+    for (int i = 0; i < j->pending_count; i++)
+    {
+        if (j->pending[i].seq > after_seq && !visit(&j->pending[i], arg))
+            return;
+    }
+}
+
+
+bool journalMount(journal_t *j, const journal_flash_t *flash)
+{
+    memset(j, 0, sizeof(*j));
+    j->flash = *flash;
+    j->sectors = flash->size / flash->sector_size;
+    if (j->sectors < 2 || flash->sector_size < SECTOR_HEADER_SIZE + JOURNAL_RECORD_SIZE)
+        return false;
+
+    // Head: the valid sector started last
+    bool found = false;
+    for (uint32_t s = 0; s < j->sectors; s++)
+    {
+        sector_header_t h;
+        if (readHeader(j, s, &h) && (!found || h.sector_seq > j->sector_seq))
+        {
+            found = true;
+            j->head_sector = s;
+            j->sector_seq = h.sector_seq;
+            j->next_seq = h.first_seq;
+            j->boot = h.boot;
+        }
+    }
+
+    if (!found)
+    {
+        j->next_seq = 1;
+        if (!startSector(j, 0, j->next_seq))
+            return false;
+    }
+    else
+    {
+        // Append point: first erased slot of the head sector
+        j->head_offset = j->flash.sector_size;
+        for (uint32_t offset = SECTOR_HEADER_SIZE; offset + JOURNAL_RECORD_SIZE <= j->flash.sector_size;
+             offset += JOURNAL_RECORD_SIZE)
+        {
+            journal_record_t r;
+            if (!j->flash.read(j->flash.ctx, j->head_sector * j->flash.sector_size + offset, &r, sizeof(r)))
+                return false;
+            if (recordErased(&r))
+            {
+                j->head_offset = offset;
+                break;
+            }
+            if (recordValid(&r))
+            {
+                j->next_seq = r.seq + 1;
+                if (r.boot > j->boot)
+                    j->boot = r.boot;
+            }
+        }
+    }
+
+    j->boot++;
+    journal_record_t boot = { .type = JOURNAL_BOOT };
+    journalAppend(j, &boot);
+    return journalFlush(j);
+}
+
+
+bool journalAppend(journal_t *j, journal_record_t *record)
+{
+    // Full buffer (flash failing): the oldest buffered record gives way
+    if (j->pending_count == JOURNAL_BATCH_RECORDS)
+    {
+        memmove(&j->pending[0], &j->pending[1], (JOURNAL_BATCH_RECORDS - 1) * sizeof(journal_record_t));
+        j->pending_count--;
+    }
+
+    record->seq = j->next_seq++;
+    record->boot = j->boot;
+    record->crc = crc8((const uint8_t *)record, JOURNAL_RECORD_SIZE - 1);
+    j->pending[j->pending_count++] = *record;
+
+    return j->pending_count == JOURNAL_BATCH_RECORDS;
+}
+
+
+bool journalFlush(journal_t *j)
+{
+    int done = 0;
+    bool ok = true;
+
+    while (done < j->pending_count)
+    {
+        if (j->head_offset + JOURNAL_RECORD_SIZE > j->flash.sector_size &&
+            !startSector(j, (j->head_sector + 1) % j->sectors, j->pending[done].seq))
+        {
+            ok = false;
+            break;
+        }
+
+        // One write per run of records that fits in the head sector
+        uint32_t room = (j->flash.sector_size - j->head_offset) / JOURNAL_RECORD_SIZE;
+        uint32_t run = (uint32_t)(j->pending_count - done) < room ? (uint32_t)(j->pending_count - done) : room;
+        uint32_t offset = j->head_sector * j->flash.sector_size + j->head_offset;
+
+        // The slots are spent either way; a failed run is retried further on
+        j->head_offset += run * JOURNAL_RECORD_SIZE;
+        if (!j->flash.write(j->flash.ctx, offset, &j->pending[done], run * JOURNAL_RECORD_SIZE))
+        {
+            ok = false;
+            break;
+        }
+        done += run;
+    }
+
+    memmove(&j->pending[0], &j->pending[done], (j->pending_count - done) * sizeof(journal_record_t));
+    j->pending_count -= done;
+    return ok;
+}
+
+
+typedef struct {
+    journal_record_t *out;
+    int max;
+    int count;
+} read_state_t;
+
+static bool collect(const journal_record_t *record, void *arg)
+{
+    read_state_t *state = arg;
+    state->out[state->count++] = *record;
+    return state->count < state->max;
+}
+
+int journalRead(const journal_t *j, uint32_t after_seq, journal_record_t *out, int max)
+{
+    read_state_t state = { .out = out, .max = max, .count = 0 };
+    if (max > 0)
+        forEachRecord(j, after_seq, collect, &state);
+    return state.count;
+}
+
+
+typedef struct {
+    uint16_t boot;
+    uint32_t time_ms;
+    uint32_t seq;
+} time_search_t;
+
+static bool findTime(const journal_record_t *record, void *arg)
+{
+    time_search_t *search = arg;
+    if (record->boot > search->boot || (record->boot == search->boot && record->time_ms >= search->time_ms))
+    {
+        search->seq = record->seq - 1;
+        return false;
+    }
+    return true;
+}
+
+uint32_t journalSeqBefore(const journal_t *j, uint16_t boot, uint32_t time_ms)
+{
+    time_search_t search = { .boot = boot, .time_ms = time_ms, .seq = j->next_seq - 1 };
+    forEachRecord(j, 0, findTime, &search);
+    return search.seq;
+}
+
+
+static bool firstRecord(const journal_record_t *record, void *arg)
+{
+    *(uint32_t *)arg = record->seq;
+    return false;
+}
+
+uint32_t journalFirstSeq(const journal_t *j)
+{
+    uint32_t seq = j->next_seq;
+    forEachRecord(j, 0, firstRecord, &seq);
+    return seq;
+}
+
+
+const char *journalTypeName(uint8_t type)
+{
+    switch (type)
+    {
+        case JOURNAL_BOOT:          return "boot";
+        case JOURNAL_ALARM_START:   return "alarm_start";
+        case JOURNAL_ALARM_ONGOING: return "alarm_ongoing";
+        case JOURNAL_ALARM_CLEAR:   return "alarm_clear";
+        default:                    return "unknown";
+    }
+}
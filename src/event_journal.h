@@ -0,0 +1,106 @@
+#pragma once
+
+/*
+ * Append-only event journal on a raw flash region, used as a ring of
+ * erase sectors. Records are 16 bytes and carry a CRC, so a write torn by
+ * a reset is skipped on read. Appends are buffered in RAM and written in
+ * batches; each sector is erased only when the ring wraps onto it, so
+ * wear is spread evenly over the region. When full, the oldest sector is
+ * recycled.
+ *
+ * Flash access goes through journal_flash_t, so the same code runs on an
+ * esp_partition and on the host. Not thread safe: callers serialize.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define JOURNAL_RECORD_SIZE     16
+#define JOURNAL_BATCH_RECORDS   16      // Appends buffered before a flush is due
+#define JOURNAL_LEVEL_UNKNOWN   INT8_MIN
+
+typedef enum {
+    JOURNAL_BOOT = 1,       // Written once per mount
+    JOURNAL_ALARM_START,    // Alarm lifecycle (dsp_alarm.h)
+    JOURNAL_ALARM_ONGOING,
+    JOURNAL_ALARM_CLEAR,
+} journal_record_type_t;
+
+// One record as stored (little-endian, packed to JOURNAL_RECORD_SIZE)
+typedef struct __attribute__((packed)) {
+    uint32_t seq;           // Journal-wide, starts at 1, never reused
+    uint32_t time_ms;       // Time since boot
+    uint16_t boot;          // Mount count at the time
+    uint8_t  type;          // journal_record_type_t
+    uint8_t  pattern;       // cadence_pattern_t
+    uint16_t freq_hz;
+    int8_t   peak_db;       // JOURNAL_LEVEL_UNKNOWN: not measured
+    uint8_t  crc;           // CRC-8 of the bytes before
+} journal_record_t;
+
+_Static_assert(sizeof(journal_record_t) == JOURNAL_RECORD_SIZE, "journal record must stay 16 bytes");
+
+// Raw flash: erased bytes read 0xFF, writes only clear bits
+typedef struct {
+    bool (*read)(void *ctx, uint32_t offset, void *data, size_t length);
+    bool (*write)(void *ctx, uint32_t offset, const void *data, size_t length);
+    bool (*erase)(void *ctx, uint32_t offset, size_t length);
+    void *ctx;
+    uint32_t size;              // Whole sectors are used
+    uint32_t sector_size;
+} journal_flash_t;
+
+typedef struct {
+    journal_flash_t flash;
+    uint32_t sectors;
+    uint32_t head_sector;       // Sector being appended to
+    uint32_t head_offset;       // Next free byte in it
+    uint32_t sector_seq;        // Use count of the head sector (increases per sector)
+    uint32_t next_seq;
+    uint16_t boot;
+    journal_record_t pending[JOURNAL_BATCH_RECORDS];
+    int pending_count;
+} journal_t;
+
+/**
+ * @brief Find the head of an existing journal, or format the region if it
+ *        holds none, then append a JOURNAL_BOOT record
+ *
+ * @return false if the region is too small or flash access fails
+ */
+bool journalMount(journal_t *j, const journal_flash_t *flash);
+
+/**
+ * @brief Buffer one record; seq, boot and crc are filled in
+ *
+ * @return true when the batch is full and journalFlush is due
+ */
+bool journalAppend(journal_t *j, journal_record_t *record);
+
+/**
+ * @brief Write every buffered record
+ *
+ * @return false on a flash error (the records stay buffered)
+ */
+bool journalFlush(journal_t *j);
+
+/**
+ * @brief Records with seq > after_seq, oldest first, including buffered ones
+ *
+ * @return number of records written to `out` (up to max)
+ */
+int journalRead(const journal_t *j, uint32_t after_seq, journal_record_t *out, int max);
+
+/**
+ * @brief Cursor for a time query: the seq just before the first record of
+ *        `boot` at or after `time_ms` (pass to journalRead as after_seq)
+ */
+uint32_t journalSeqBefore(const journal_t *j, uint16_t boot, uint32_t time_ms);
+
+/**
+ * @brief Oldest seq still stored (records before it were recycled)
+ */
+uint32_t journalFirstSeq(const journal_t *j);
+
+const char *journalTypeName(uint8_t type);
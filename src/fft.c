@@ -2,301 +2,305 @@
 #include "i2s_config.h"
 #include "esp_timer.h"
 #include <stdio.h>
-#include "esp_dsp.h"
 #include "esp_log.h"
-#include <math.h>
 #include "web_server.h"
+#include "stage_timing.h"
+#include "config_store.h"
+#include "spectrum_stream.h"
+#include "metrics.h"
+#include "dsp_alarm.h"
+#include "mem_plan.h"
+#include "audio_recorder.h"
+#include "dsp_deinterleave.h"
 #include "config.h"
 
 
 // TAG for logging
 static const char *TAG = "FFT";
 
-static float vReal[SAMPLE_BUFFER_SIZE];  // Interleaved: [Real, Imag, Real, Imag, ...]
-
-#define BIN_START                   ((int)((Freq_START_HZ * FFT_SIZE) / I2S_SAMPLE_RATE_HZ))   // calculate start bin
-#define BIN_END                     ((int)((Freq_END_HZ   * FFT_SIZE) / I2S_SAMPLE_RATE_HZ))   // calculate end bin
-#define FREQ_RESO                   ((float)I2S_SAMPLE_RATE_HZ / FFT_SIZE)
-#if USE_LONG_WINDOW
-    #define DETECT_COUNT             1      // Number of consecutive detections to trigger alarm
-#else
-    #define DETECT_COUNT             5      // Number of consecutive detections to trigger alarm
+// Band spectra from the DSP stage to the detection stage
+static QueueHandle_t xSpectrumQueue = NULL;
+static uint32_t spectraDropped = 0;
+
+// Static task and queue storage (see mem_plan.h)
+static StackType_t fftStack[FFT_TASK_STACK];
+static StackType_t detectStack[DETECT_TASK_STACK];
+static StaticTask_t fftTaskBuffer;
+static StaticTask_t detectTaskBuffer;
+static uint8_t spectrumQueueStorage[SPECTRUM_QUEUE_LEN * sizeof(dsp_spectrum_t)];
+static StaticQueue_t spectrumQueueBuffer;
+
+#if CAPTURE_CHANNELS == 2
+// One capture block per microphone, split out of the interleaved DMA frames
+static int32_t channelSamples[CAPTURE_CHANNELS][SAMPLE_BUFFER_SIZE] DSP_ALIGNED;
 #endif
 
-#define NUM_BINS                    (FFT_SIZE / 2)  // Number of FFT bins for real FFT
-#define LONG_WINDOW_SECONDS         4.0f   // 4 seconds
-#define LONG_WINDOW_FRAMES          ((int)ceil(LONG_WINDOW_SECONDS * I2S_SAMPLE_RATE_HZ / FFT_SIZE))
-
-
-static float avgSpectrum[NUM_BINS];
-static int frameCount = 0;
-static int detectionCounter = 0;
-
-// Forward declarations
-static int  normalizeBuffer(int32_t* buffer, float* real, int length);
-static void applyWindow(float* data, int length);
-static void analyzeBins(float* fftData, int startBin, int endBin, float threshold);
 
-// Windowing reference sum for normalization
-static float window_sum = 0.0f;
-static bool window_initialized = false;
-
-static void initWindowRef(void)
+// Forward an alarm lifecycle event to the web server queue
+static void sendFireAlarmEvent(const alarm_report_t *report, int64_t now_ms)
 {
-    if (window_initialized)
+    static const web_event_type_t types[] = {
+        [ALARM_START]   = EVENT_ALARM_START,
+        [ALARM_ONGOING] = EVENT_ALARM_ONGOING,
+        [ALARM_CLEAR]   = EVENT_ALARM_CLEAR,
+    };
+
+    if (xFireAlarmEventQueue == NULL)
         return;
 
-    for (int n = 0; n < FFT_SIZE; n++)
+    web_event_t event;
+    event.type = types[report->phase];
+    event.bin = report->freq_hz;
+    event.pattern = report->pattern;
+    event.timestamp_ms = now_ms;
+    event.peak_db = report->peak_db;
+    event.duration_ms = report->duration_ms;
+    event.confirmations = report->confirmations;
+    BaseType_t xStatus = xQueueSend(xFireAlarmEventQueue, &event, 0); // non-blocking
+    if (xStatus == pdPASS)
     {
-        float w = 0.54f - 0.46f * cosf((2.0f * M_PI * n) / (FFT_SIZE - 1)); // Hamming
-        window_sum += w;
+        metricsPeak(METRIC_ALARM_QUEUE_PEAK, uxQueueMessagesWaiting(xFireAlarmEventQueue));
+    }
+    else
+    {
+        metricsCount(METRIC_ALARM_EVENTS_DROPPED);
+        ESP_LOGW(TAG, "Failed to send fire alarm event to queue");
     }
-
-    window_initialized = true;
 }
 
 
-
-// FFT Task
-void vFFTProcessorTask(void* pvParameters)
+// Report capture losses since the last check (never silent, but rate-limited to changes)
+static void checkCaptureDrops(void)
 {
-    QueueHandle_t xAudioBufferQueue = (QueueHandle_t)pvParameters;
-    void* buffer;
+    static uint32_t lastDropped = 0;
+    static uint32_t lastLost = 0;
+    i2s_capture_stats_t capture;
 
-    // Initialize FFT (once)
-    esp_err_t ret = dsps_fft2r_init_fc32(NULL, FFT_SIZE);
-    if (ret != ESP_OK)
-    {
-        ESP_LOGE(TAG, "Failed to initialize FFT: %d", ret);
-        vTaskDelete(NULL);
-    }
+    vI2S_GetCaptureStats(&capture);
 
-    for (;;)
+    if (capture.blocks_dropped != lastDropped)
     {
-        if (xQueueReceive(xAudioBufferQueue, &buffer, portMAX_DELAY) == pdTRUE)
-        {
-            int32_t* audioBuffer = (int32_t*)buffer;
-
-
-            // Normalize samples to float
-            int n = normalizeBuffer(audioBuffer, vReal, SAMPLE_BUFFER_SIZE);            
-
-            // Apply windowing
-            applyWindow(vReal, n);
-
-            // Convert real → complex (interleaved)
-            for (int i = n - 1; i >= 0; i--)
-            {
-                vReal[2*i + 0] = vReal[i];
-                vReal[2*i + 1] = 0.0f;
-            }
-
-            // Perform FFT
-            dsps_fft2r_fc32(vReal, n);       // Real FFT
-            dsps_bit_rev_fc32(vReal, n);     // Bit-reversal
-            
-            
-            // Optional debug
-            // printf("Starting samples printing\n");
-            // for (int i = 0; i < SAMPLE_BUFFER_SIZE; i += 8) {
-            //         printf("index %3d:  (%f)\n", i, vReal[i]);   //signed decimal
-            //         // printf("%f\n", vReal[i]);
-            //     }
-            // printf("Finished samples printing\n");
-
-
-            // Analyze bins
-            analyzeBins(vReal, BIN_START, BIN_END, THRESHOLD_DB);
-        }
+        ESP_LOGW(TAG, "Dropped %lu audio blocks (total %lu, ring high-water %lu/%lu, lag %lu)",
+                 (unsigned long)(capture.blocks_dropped - lastDropped), (unsigned long)capture.blocks_dropped,
+                 (unsigned long)capture.ring.high_water, (unsigned long)capture.ring.capacity,
+                 (unsigned long)capture.ring.lag);
+        lastDropped = capture.blocks_dropped;
     }
-}
-
-// Normalize 32-bit samples to float [-1.0, 1.0]
-static int normalizeBuffer(int32_t *buffer, float *real, int length)
-{
-    const float scale = 1.0f / 2147483648.0f;   // 2³¹
-    // const float scale = 1.0f / 16777216.0f;   // 2²⁴
-    // const float scale = 1.0f / 8388608.0f;   // 2²³
-    int out = 0;
-    for (int i = 0; i < length; i ++)
-    { 
-        // int32_t sample24 = buffer[i] >> 8;  // Convert 32-bit to 24-bit
-        int32_t sample24 = buffer[i];  // Use full 32-bit
-        real[out++] = (float)sample24 * scale;
+    if (capture.dma_buffers_lost != lastLost)
+    {
+        ESP_LOGW(TAG, "Capture ISR late: %lu DMA buffers lost (total %lu)",
+                 (unsigned long)(capture.dma_buffers_lost - lastLost), (unsigned long)capture.dma_buffers_lost);
+        lastLost = capture.dma_buffers_lost;
     }
-    
-    return out;
 }
 
 
-// Apply Hamming window
-static void applyWindow(float *data, int length)
+// A detector configuration the spectrum stage could not apply stays pending
+// (and keeps POST /config busy); say so once per such configuration
+static void checkConfigApplied(void)
 {
-    for (int i = 0; i < length; i++)
+    static uint32_t lastFailures = 0;
+    uint32_t failures = dspCoreConfigFailures();
+
+    if (failures != lastFailures)
     {
-        float w = 0.54f - 0.46f * cosf((2.0f * M_PI * i) / (length - 1));
-        data[i] *= w;
+        detector_config_t cfg;
+        char json[192];
+        dspCoreGetConfig(&cfg);
+        detectorConfigFormat(&cfg, json, sizeof(json));
+        ESP_LOGE(TAG, "Detector config could not be applied, keeping the previous one: %s", json);
+        lastFailures = failures;
     }
 }
 
 
-// Analyze FFT bins for threshold crossing
-static void analyzeBins(float *fftData, int startBin, int endBin, float threshold_dB)
+// Hand a spectrum to detection without ever blocking capture; logs once per run of drops
+static void queueSpectrum(const dsp_spectrum_t *spectrum)
 {
-    bool detected = false;
-    int freq_detected = 0;
-    float tmp_powerDB = -500;
-    int tmp_i = 0;
-
-#if USE_LONG_WINDOW
-    // -------------------------------
-    // Long-window averaging
-    // -------------------------------
-    for (int i = 0; i < NUM_BINS; i++)
-    {
-        float re = fftData[2*i];
-        float im = fftData[2*i + 1];
-            if (isnan(im)) {
-                im = 0.0f;
-            }
-            if (isnan(re)) {
-                re = 0.0f;
-            }
-        float mag = sqrtf(re*re + im*im);
+    static bool dropping = false;
 
-        if (i != 0 && i != (FFT_SIZE / 2))
-            mag *= 2.0f;
+    if (xQueueSend(xSpectrumQueue, spectrum, 0) == pdPASS)
+    {
+        metricsPeak(METRIC_SPECTRUM_QUEUE_PEAK, uxQueueMessagesWaiting(xSpectrumQueue));
+        dropping = false;
+        return;
+    }
 
-        avgSpectrum[i] = (avgSpectrum[i] * frameCount + mag) / (frameCount + 1);
+    spectraDropped++;
+    metricsCount(METRIC_SPECTRA_DROPPED);
+    if (!dropping)
+    {
+        ESP_LOGW(TAG, "Detection task behind, dropping spectra (total %lu)", (unsigned long)spectraDropped);
+        dropping = true;
     }
+}
 
-    frameCount++;
 
-    if (frameCount >= LONG_WINDOW_FRAMES)
-    {
-        for (int i = startBin; i <= endBin; i++)
-        {
-            float powerDB = 20.0f * log10f((avgSpectrum[i] / window_sum) + 1e-12f);
-            if (powerDB > tmp_powerDB) {
-            tmp_powerDB = powerDB;
-            tmp_i = i;
-        }
-        }
+// FFT Task (DSP stage): window and transform every hop
+void vFFTProcessorTask(void* pvParameters)
+{
+    spsc_ring_t *xAudioRing = (spsc_ring_t *)pvParameters;
+    const audio_block_t *block;
+    uint32_t expectedSeq = 0;
+    static dsp_spectrum_t spectrum;
 
-        if (tmp_powerDB > threshold_dB)
-        {
-            detected = true;
-            freq_detected = (int)(tmp_i * FREQ_RESO + 0.5f); // Rounds to nearest integer
-            // printf("%d\n", freq_detected);
-        }
+    // Capture ISR notifies this task once per committed block
+    vI2S_SetConsumerTask(xTaskGetCurrentTaskHandle());
 
-        if (detected)
-            detectionCounter++;
-        else
-            detectionCounter = 0;
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 
-        if (detectionCounter >= DETECT_COUNT)
+        // Drain everything committed so far, in place
+        while ((block = spscRingPeek(xAudioRing)) != NULL)
         {
-            detectionCounter = 0;
-        
-            // Send event to web server queue
-            if (xFireAlarmEventQueue != NULL)
+            // A gap in sequence numbers means blocks were dropped: restart the sliding frame
+            if (block->seq != expectedSeq)
             {
-                web_event_t event;
-                event.type = EVENT_FIRE_ALARM;
-                event.bin = freq_detected;
-                event.timestamp_ms = esp_timer_get_time() / 1000; // ms since boot 
-                BaseType_t xStatus = xQueueSend(xFireAlarmEventQueue, &event, 0); // non-blocking
-                if (xStatus != pdPASS)
-                {
-                    ESP_LOGW(TAG, "Failed to send fire alarm event to queue");
-                }
-            }       
-        }
-
-        frameCount = 0;
-        memset(avgSpectrum, 0, sizeof(avgSpectrum));
-    }
+                checkCaptureDrops();
+                dspStreamReset();
+            }
+            expectedSeq = block->seq + 1;
 
+            // Slide the analysis frame; normalize, window and FFT every hop
+#if CAPTURE_CHANNELS == 2
+            // Split the interleaved frames, one contiguous run per microphone
+            deinterleaveStereo(block->samples, channelSamples[0], channelSamples[1], SAMPLE_BUFFER_SIZE);
+            const int32_t *samples[CAPTURE_CHANNELS] = { channelSamples[0], channelSamples[1] };
+#endif
+            int left = SAMPLE_BUFFER_SIZE;
+            while (left > 0)
+            {
+#if CAPTURE_CHANNELS == 2
+                int used = dspStreamPushChannels(samples, left);
+                samples[0] += used;
+                samples[1] += used;
 #else
-    // -------------------------------
-    // Short-window analysis
-    // -------------------------------
-    for (int i = startBin; i <= endBin; i++)
-    {
-        float re = fftData[2*i];
-        float im = fftData[2*i + 1];
-            if (isnan(im)) {
-                im = 0.0f;
-            }
-            if (isnan(re)) {
-                re = 0.0f;
+                int used = dspStreamPush(&block->samples[SAMPLE_BUFFER_SIZE - left], left);
+#endif
+                left -= used;
+
+                if (dspStreamFrame() == NULL)
+                    continue;
+
+                // The frame's newest sample is `left` samples before the end of the block
+                int64_t start_us = esp_timer_get_time();
+                metricsObserve(METRIC_CAPTURE_TO_FFT,
+                               start_us - block->timestamp_us + (int64_t)(left * 1e6f / I2S_SAMPLE_RATE_HZ));
+
+                // Quiet frames skip the transform (energy gate)
+                bool transformed = dspComputeStreamSpectrum(&spectrum);
+                dspStreamAdvance();
+                vStageRecord(STAGE_DSP, start_us);
+                if (transformed)
+                    metricsObserve(METRIC_FFT, esp_timer_get_time() - start_us);
+                else
+                    metricsCount(METRIC_FRAMES_GATED);
+
+                queueSpectrum(&spectrum);
             }
-        float mag = sqrtf(re*re + im*im);
 
-        if (i != 0 && i != (FFT_SIZE / 2))
-            mag *= 2.0f;
+            checkConfigApplied();
 
-        float powerDB = 20.0f * log10f((mag / window_sum) + 1e-12f);
-        
-        if (powerDB > tmp_powerDB) {
-            tmp_powerDB = powerDB;
-            tmp_i = i;
-        }
+            // Raw copy for GET /capture, if one is recording
+            vAudioRecorderFeed(block);
 
-        // Optional debug 
-            // printf("index %3d:  (%f)\n", i, powerDB);   //signed decimal    
-            // printf("index %3d:  (%f)\n", i, im);   //signed decimal
-            // printf("%f\n", vReal[i]);
+            // Return the slot to the capture ISR
+            spscRingRelease(xAudioRing);
+        }
     }
+}
 
-    if (tmp_powerDB > threshold_dB)
-    {
-        detected = true;
-        freq_detected = (int)(tmp_i * FREQ_RESO + 0.5f); // Rounds to nearest integer
-        // printf("%d\n", freq_detected);
-    }
 
-    if (detected) 
-        detectionCounter++;
-    else if (detectionCounter > 0)
-        detectionCounter--;
+// Detection Task: threshold or noise floor, confirmation and cadence, in frame order
+void vDetectTask(void* pvParameters)
+{
+    static dsp_spectrum_t spectrum;
 
-    if (detectionCounter >= DETECT_COUNT)
+    for (;;)
     {
-        detectionCounter = 0;
-        
-        // Send event to web server queue
-        if (xFireAlarmEventQueue != NULL)
+        if (xQueueReceive(xSpectrumQueue, &spectrum, portMAX_DELAY) != pdPASS)
+            continue;
+
+        dsp_detection_t detection;
+        alarm_report_t report;
+        int64_t start_us = esp_timer_get_time();
+        dspAnalyzeSpectrum(&spectrum, &detection);
+        metricsObserve(METRIC_ANALYSIS, esp_timer_get_time() - start_us);
+        vSpectrumStreamPublish(&spectrum);
+        vStageRecord(STAGE_DETECT, start_us);
+
+        // A tone in a frame the gate would have skipped means the margin is too thin
+        if (spectrum.gate == DSP_GATE_AUDIT)
         {
-            web_event_t event;
-            event.type = EVENT_FIRE_ALARM;
-            event.bin = freq_detected;
-            event.timestamp_ms = esp_timer_get_time() / 1000; // ms since boot 
-            BaseType_t xStatus = xQueueSend(xFireAlarmEventQueue, &event, 0); // non-blocking
-            if (xStatus != pdPASS)
+            metricsCount(METRIC_GATE_AUDITS);
+            if (detection.tone_on)
             {
-                ESP_LOGW(TAG, "Failed to send fire alarm event to queue");
+                metricsCount(METRIC_GATE_MISSES);
+                ESP_LOGW(TAG, "Energy gate missed a tone at %d Hz (%.1f dB, band %.1f dB)",
+                         detection.freq_hz, detection.peak_db, spectrum.gate_db);
             }
         }
-        
+
+        // Confirmations are coalesced into start / ongoing / clear
+        if (alarmUpdate(&detection, start_us / 1000, &report))
+        {
+            sendFireAlarmEvent(&report, start_us / 1000);
+        }
     }
-#endif
 }
 
 
-// Start FFT Task
-void vStartFFTTask(QueueHandle_t xAudioBufferQueue)
+// Start DSP and detection tasks on their configured cores
+void vStartFFTTask(spsc_ring_t *xAudioRing)
 {
-    initWindowRef();  // precompute window reference
-    xTaskCreatePinnedToCore(
+    // Initialize FFT tables and window reference (once), before either stage runs
+    if (!dspCoreInit())
+    {
+        ESP_LOGE(TAG, "Failed to initialize FFT");
+        return;
+    }
+
+    // A configuration saved through POST /config replaces the config.h defaults
+    detector_config_t stored;
+    if (xConfigStoreLoad(&stored) == ESP_OK)
+    {
+        char json[192];
+        detectorConfigFormat(&stored, json, sizeof(json));
+        if (dspCoreConfigure(&stored) == DSP_CONFIG_OK)
+            ESP_LOGI(TAG, "Stored detector config: %s", json);
+    }
+
+    xSpectrumQueue = xQueueCreateStatic(SPECTRUM_QUEUE_LEN, sizeof(dsp_spectrum_t),
+                                        spectrumQueueStorage, &spectrumQueueBuffer);
+
+    xTaskCreateStaticPinnedToCore(
+        vDetectTask,             // Task function
+        DETECT_TASK_NAME,        // Name
+        DETECT_TASK_STACK,       // Stack size
+        NULL,                    // Parameters
+        DETECT_TASK_PRIORITY,    // Priority
+        detectStack,             // Stack
+        &detectTaskBuffer,       // Task control block
+        DETECT_TASK_CORE         // Core
+    );
+
+    xTaskCreateStaticPinnedToCore(
         vFFTProcessorTask,       // Task function
         FFT_TASK_NAME,           // Name
         FFT_TASK_STACK,          // Stack size
-        xAudioBufferQueue,       // Parameters
-        FFT_TASK_PRIORITY,       // Priority
-        NULL,                    // Task handle
-        0                        // Core 0
+        xAudioRing,              // Parameters
+        DSP_TASK_PRIORITY,       // Priority
+        fftStack,                // Stack
+        &fftTaskBuffer,          // Task control block
+        DSP_TASK_CORE            // Core
     );
-}
 
+    mem_block_t blocks[12];
+    int count = dspCoreBuffers(blocks, 12);
+    for (int i = 0; i < count; i++)
+        vMemPlanAdd("dsp", blocks[i].name, blocks[i].addr, blocks[i].size);
+    vMemPlanAdd("pipeline", "fft task stack", fftStack, sizeof(fftStack));
+    vMemPlanAdd("pipeline", "detect task stack", detectStack, sizeof(detectStack));
+    vMemPlanAdd("pipeline", "spectrum queue", spectrumQueueStorage, sizeof(spectrumQueueStorage));
+}
@@ -3,16 +3,21 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "dsp_core.h"
+#include "spsc_ring.h"
 
-// FFT Task Config
+// FFT Task Config (core and priority: DSP_TASK_* in config.h)
 #define FFT_TASK_NAME         "TaskFFTProcessor"
 #define FFT_TASK_STACK        8192
-#define FFT_TASK_PRIORITY     4
 
-// FFT Settings
-#define FFT_SIZE              4096  // Must be power of 2 and <= SAMPLE_BUFFER_SIZE
-#define SAMPLE_RATE           I2S_SAMPLE_RATE_HZ 
+// Detection Task Config (core and priority: DETECT_TASK_* in config.h)
+#define DETECT_TASK_NAME      "TaskDetect"
+#define DETECT_TASK_STACK     4096
+
+// Band spectra waiting for the detection task; a full queue drops the newest
+#define SPECTRUM_QUEUE_LEN    4
 
 // Function Prototypes
 void vFFTProcessorTask(void* pvParameters);
-void vStartFFTTask(QueueHandle_t xAudioBufferQueue);
\ No newline at end of file
+void vDetectTask(void* pvParameters);
+void vStartFFTTask(spsc_ring_t *xAudioRing);
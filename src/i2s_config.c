@@ -1,94 +1,133 @@
 #include "i2s_config.h"
+#include "stage_timing.h"
+#include "config.h"
+#include "esp_attr.h"
+#include "mem_plan.h"
 #include "esp_log.h"
+#include <string.h>
 
 // ------------------------------------
 // GLOBALS
 // ------------------------------------
 i2s_chan_handle_t xI2S_RXChanHandle = NULL;
-TaskHandle_t xMicTaskHandle = NULL;  // Define the task handle
-QueueHandle_t xAudioBufferQueue = NULL;  // Define the queue handle
+spsc_ring_t xAudioRing;
+
+// Capture storage in internal RAM: the I2S ISR is IRAM-safe (CONFIG_I2S_ISR_IRAM_SAFE)
+// and keeps filling it while a flash erase or write has the cache, and PSRAM, off
+static audio_block_t captureBlocks[CAPTURE_RING_SLOTS];
+static TaskHandle_t xConsumerTask = NULL;
 
 
 // TAG for logging
 static const char *TAG = "I2S_Config";
 
-// Ping-pong buffers for small chunks
- int32_t I2S_Buffer_A[SAMPLE_BUFFER_SIZE];
- int32_t I2S_Buffer_B[SAMPLE_BUFFER_SIZE];
+_Static_assert(SAMPLE_BUFFER_SIZE % I2S_DMA_FRAME_NUM == 0, "DMA buffers must tile a capture block");
+_Static_assert(CAPTURE_CHANNELS == 1 || CAPTURE_CHANNELS == 2, "one I2S bus carries one or two microphones");
+
+// Block being filled by the ISR, NULL while dropping because the ring is full
+static audio_block_t *fillBlock = NULL;
+static int fillCount = 0;          // 32-bit slots, not frames
+static uint32_t captureSeq = 0;
 
- int32_t *activeBuffer = I2S_Buffer_A;
- int32_t *inactiveBuffer = I2S_Buffer_B;
+// The driver reports only the newest finished buffer per interrupt, so a
+// late ISR (cache disabled, a long critical section) shows up as a longer
+// gap between callbacks rather than as an event. Integer only: no FPU in ISRs.
+#define DMA_BUFFER_US   ((uint32_t)(I2S_DMA_FRAME_NUM * 1000000LL / (long long)I2S_SAMPLE_RATE_HZ))
+static int64_t lastRecv_us = 0;
+static uint32_t dmaBuffersLost = 0;
 
 
 // ------------------------------------
-// I2S READER TASK (Timer-driven, small buffer)
+// I2S RECEIVE CALLBACK (ISR, once per DMA buffer)
 // ------------------------------------
-void vTaskI2SReader(void *pvParameters)
+static IRAM_ATTR bool onI2SRecv(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx)
 {
-    size_t bytesRead = 0;
+    int64_t start_us = esp_timer_get_time();
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    int count = event->size / sizeof(int32_t);
+
+    // Buffers skipped or overwritten since the last callback: drop the partly
+    // filled block and leave a sequence gap, so the consumer restarts its
+    // frame instead of analyzing spliced audio
+    uint32_t since_us = (uint32_t)(start_us - lastRecv_us);
+    if (lastRecv_us != 0 && since_us > DMA_BUFFER_US * 3 / 2)
+    {
+        dmaBuffersLost += (since_us + DMA_BUFFER_US / 2) / DMA_BUFFER_US - 1;
+        fillCount = 0;
+        fillBlock = NULL;           // Reserved slot is handed out again by the next reserve
+        captureSeq++;
+    }
+    lastRecv_us = start_us;
+
+    // Start of a block: reserve a ring slot (counts an overrun if full)
+    if (fillCount == 0)
+    {
+        fillBlock = spscRingReserve(&xAudioRing);
+    }
+
+    if (fillBlock != NULL)
+    {
+        memcpy(&fillBlock->samples[fillCount], event->dma_buf, count * sizeof(int32_t));
+    }
+    fillCount += count;
 
-    for (;;)
+    if (fillCount >= CAPTURE_BLOCK_VALUES)
     {
-        // Wait for timer notification
-        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-
-        esp_err_t err = i2s_channel_read(
-            xI2S_RXChanHandle,
-            activeBuffer,
-            BUFFER_READ_SIZE,
-            &bytesRead,
-            portMAX_DELAY);
-
-        int samplesRead = bytesRead / sizeof(int32_t);    
-        if (err == ESP_OK && bytesRead == BUFFER_READ_SIZE)
+        uint32_t seq = captureSeq++;
+        fillCount = 0;
+
+        if (fillBlock != NULL)
         {
-            // Swap buffers
-            void *tmp = activeBuffer;
-            activeBuffer = inactiveBuffer;
-            inactiveBuffer = tmp;
-
-            // Optional debug
-            // printf("Starting samples printing\n");
-            // for (int i = 0; i < samplesRead; i++) {
-            //         printf("index %3d:  (%ld)\n", i, inactiveBuffer[i]);   //signed decimal
-            //         // printf("%ld\n", inactiveBuffer[i]);
-            //     }
-            // printf("Finished samples printing\n");
-            
-            
-            // Send inactiveBuffer to FFT task via queue
-            if (xAudioBufferQueue != NULL)
+            fillBlock->seq = seq;
+            fillBlock->timestamp_us = esp_timer_get_time();
+            spscRingCommit(&xAudioRing);
+            fillBlock = NULL;
+
+            if (xConsumerTask != NULL)
             {
-                BaseType_t xStatus = xQueueSendToBack(xAudioBufferQueue, &inactiveBuffer, 0);  // No wait
-                if (xStatus != pdPASS)
-                {
-                    ESP_LOGW(TAG, "Failed to send buffer to queue");
-                }
+                vTaskNotifyGiveFromISR(xConsumerTask, &xHigherPriorityTaskWoken);
             }
-
-            
-        }
-        else
-        {
-            ESP_LOGE(TAG, "I2S read error: %d, bytes: %u", err, (unsigned)bytesRead);
         }
     }
+
+    vStageRecord(STAGE_CAPTURE, start_us);
+    return xHigherPriorityTaskWoken == pdTRUE;
+}
+
+void vI2S_SetConsumerTask(TaskHandle_t xTask)
+{
+    xConsumerTask = xTask;
+}
+
+void vI2S_GetCaptureStats(i2s_capture_stats_t *stats)
+{
+    spscRingGetStats(&xAudioRing, &stats->ring);
+    stats->blocks_dropped = stats->ring.overruns;
+    stats->dma_buffers_lost = dmaBuffersLost;
 }
 
 
 // ------------------------------------
 // I2S RX INITIALIZATION
 // ------------------------------------
-void vI2S_InitRX(void)
+static void setupRX(void)
 {
     esp_err_t xErr;
 
+    // Capture ring must exist before the first callback
+    if (!spscRingInit(&xAudioRing, captureBlocks, sizeof(audio_block_t), CAPTURE_RING_SLOTS))
+    {
+        ESP_LOGE(TAG, "Invalid capture ring size %d", CAPTURE_RING_SLOTS);
+        return;
+    }
+    vMemPlanAdd("capture", "audio ring", captureBlocks, sizeof(captureBlocks));
+
     // Configure RX channel
     i2s_chan_config_t chanCfg = {
         .id = I2S_NUM_0,
         .role = I2S_ROLE_MASTER,
-        .dma_desc_num = 6,
-        .dma_frame_num = 240,  // Smaller for low latency
+        .dma_desc_num = I2S_DMA_DESC_NUM,
+        .dma_frame_num = I2S_DMA_FRAME_NUM,  // Smaller for low latency
         .auto_clear = false,
     };
 
@@ -105,15 +144,20 @@ void vI2S_InitRX(void)
         .bclk_div = 8,
     };
 
-    // Slot config (Mono, 32-bit)
+    // Slot config (32-bit; mono or both mics on one data line)
     // i2s_std_slot_config_t slotCfg =
     //     I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_SAMPLE_BITS, I2S_SLOT_MODE_MONO);
     i2s_std_slot_config_t slotCfg =
     {
         .data_bit_width = I2S_SAMPLE_BITS,
         .slot_bit_width = I2S_SLOT_BIT_WIDTH_32BIT,
+#if CAPTURE_CHANNELS == 2
+        .slot_mode = I2S_SLOT_MODE_STEREO,
+        .slot_mask = I2S_STD_SLOT_BOTH,  // L/R pin low on one mic, high on the other
+#else
         .slot_mode = I2S_SLOT_MODE_MONO,
         .slot_mask = I2S_STD_SLOT_LEFT,  // Use left slot for mono
+#endif
         .ws_width = I2S_SLOT_BIT_WIDTH_32BIT,
         .ws_pol = false,
         .bit_shift = true,
@@ -142,55 +186,44 @@ void vI2S_InitRX(void)
     xErr = i2s_channel_init_std_mode(xI2S_RXChanHandle, &stdCfg);
     ESP_ERROR_CHECK(xErr);
 
-    xErr = i2s_channel_enable(xI2S_RXChanHandle);
+    // Capture is driven by DMA completion; no reader task or timer
+    i2s_event_callbacks_t cbs = {
+        .on_recv = onI2SRecv,
+        .on_recv_q_ovf = NULL,      // Nothing reads the driver's queue: it is always full
+        .on_sent = NULL,
+        .on_send_q_ovf = NULL,
+    };
+    xErr = i2s_channel_register_event_callback(xI2S_RXChanHandle, &cbs, NULL);
     ESP_ERROR_CHECK(xErr);
 
-    ESP_LOGI("INMP441", "I2S RX initialized: MONO, %d-bit, %d Hz", I2S_SAMPLE_BITS, I2S_SAMPLE_RATE_HZ);
-
+    xErr = i2s_channel_enable(xI2S_RXChanHandle);
+    ESP_ERROR_CHECK(xErr);
 
-    // Create audio buffer queue
-    xAudioBufferQueue = xQueueCreate(5, sizeof(void*));
+    ESP_LOGI("INMP441", "I2S RX initialized: %s, %d-bit, %d Hz", CAPTURE_CHANNELS == 2 ? "STEREO" : "MONO",
+             I2S_SAMPLE_BITS, (int)I2S_SAMPLE_RATE_HZ);
+    ESP_LOGI(TAG, "Capture: %d-sample blocks, %d DMA buffers of %d, ring of %d",
+             SAMPLE_BUFFER_SIZE, I2S_DMA_DESC_NUM, I2S_DMA_FRAME_NUM, CAPTURE_RING_SLOTS);
 }
 
-// ------------------------------------
-// MICROPHONE TIMER SETUP
-
-esp_timer_handle_t periodicTimer = NULL;
 
-void timerCallback(void* arg)
+// The DMA interrupt is allocated on the core that initializes the channel,
+// so setup runs in a short-lived task pinned to CAPTURE_CORE
+static void vI2SInitTask(void *pvParameters)
 {
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    vTaskNotifyGiveFromISR(xMicTaskHandle, &xHigherPriorityTaskWoken);
-    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
-}
+    TaskHandle_t xCaller = (TaskHandle_t)pvParameters;
 
-void setupMicrophoneTimer(void)
-{
-    esp_timer_create_args_t timerArgs = {
-        .callback = &timerCallback,
-        .arg = NULL,
-        .dispatch_method = ESP_TIMER_TASK,
-        .name = "MicrophoneTimer"
-    };
-    esp_timer_create(&timerArgs, &periodicTimer);
-    esp_timer_start_periodic(periodicTimer, 85333);  // 85.33 ms period
+    setupRX();
+    xTaskNotifyGive(xCaller);
+    vTaskDelete(NULL);
 }
 
-
-// ------------------------------------
-// START TASK
-// ------------------------------------
-void vI2S_StartReaderTask(void)
+void vI2S_InitRX(void)
 {
-    BaseType_t res = xTaskCreatePinnedToCore(
-        vTaskI2SReader,
-        TASK_I2S_READER_NAME,
-        TASK_I2S_READER_STACK,
-        NULL,
-        TASK_I2S_READER_PRIORITY,
-        &xMicTaskHandle, // Save task handle
-        0);  
-
-    configASSERT(res == pdPASS);
+    if (xTaskCreatePinnedToCore(vI2SInitTask, I2S_INIT_TASK_NAME, I2S_INIT_TASK_STACK,
+                                xTaskGetCurrentTaskHandle(), I2S_INIT_TASK_PRIORITY, NULL, CAPTURE_CORE) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to start I2S init task");
+        return;
+    }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 }
-
@@ -6,26 +6,48 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "audio_config.h"
+#include "mem_plan.h"
+#include "spsc_ring.h"
 
 // I2S config constants
-#define I2S_SAMPLE_RATE_HZ    48000.0f   // Match your mic specs
 #define I2S_SAMPLE_BITS       I2S_DATA_BIT_WIDTH_32BIT      // or 16
 
-// FFT-related settings
-#define SAMPLE_BUFFER_SIZE    4096     // Number of samples per FFT frame
-#define BUFFER_READ_SIZE      SAMPLE_BUFFER_SIZE * sizeof(int32_t)
+// DMA buffers: the on_recv callback fires once per buffer
+#define I2S_DMA_DESC_NUM      6
+#define I2S_DMA_FRAME_NUM     256      // Frames (one sample per channel) per DMA buffer, must divide SAMPLE_BUFFER_SIZE
 
-// Task config
-#define TASK_I2S_READER_NAME      "TaskI2SReader"
-#define TASK_I2S_READER_STACK     4096
-#define TASK_I2S_READER_PRIORITY  5
+// 32-bit slots in a capture block: SAMPLE_BUFFER_SIZE frames of CAPTURE_CHANNELS
+#define CAPTURE_BLOCK_VALUES  (SAMPLE_BUFFER_SIZE * CAPTURE_CHANNELS)
+
+// Capture ring between the I2S ISR and the DSP task
+#define CAPTURE_RING_SLOTS    8        // Power of 2
+
+// Runs channel setup on CAPTURE_CORE (config.h), where the DMA interrupt lands
+#define I2S_INIT_TASK_NAME      "I2SInit"
+#define I2S_INIT_TASK_STACK     4096
+#define I2S_INIT_TASK_PRIORITY  5
+
+// One capture block, filled in place by the ISR. Stereo frames stay
+// interleaved [left, right] as the DMA delivers them.
+typedef struct {
+    int32_t samples[CAPTURE_BLOCK_VALUES] DSP_ALIGNED;
+    uint32_t seq;                   // Capture sequence number (gaps = dropped blocks)
+    int64_t timestamp_us;           // esp_timer time of the last sample
+} audio_block_t;
+
+// Capture counters (updated from the I2S ISR)
+typedef struct {
+    uint32_t blocks_dropped;        // Blocks lost because the ring was full
+    uint32_t dma_buffers_lost;      // DMA buffers the ISR serviced too late to copy (callback spacing)
+    spsc_ring_stats_t ring;         // Committed/released, high-water mark, consumer lag
+} i2s_capture_stats_t;
 
 // External handles
 extern i2s_chan_handle_t xI2S_RXChanHandle;
-extern TaskHandle_t xMicTaskHandle;
-extern QueueHandle_t xAudioBufferQueue;
+extern spsc_ring_t xAudioRing;     // audio_block_t slots; consumer peeks and releases
 
 // Prototypes
-void vI2S_InitRX(void);
-void vI2S_StartReaderTask(void);
-void setupMicrophoneTimer(void);
\ No newline at end of file
+void vI2S_InitRX(void);                          // Returns once capture is running on CAPTURE_CORE
+void vI2S_SetConsumerTask(TaskHandle_t xTask);   // Notified once per committed block
+void vI2S_GetCaptureStats(i2s_capture_stats_t *stats);
@@ -2,22 +2,31 @@
 #include "fft.h"
 #include "wifi_comm.h"
 #include "web_server.h"
+#include "alarm_journal.h"
+#include "stage_timing.h"
+#include "mem_plan.h"
 
 void app_main(void)
 {
-    // 1. Initialize I2S microphone
+    // 1. Initialize I2S microphone (DMA callbacks fill the capture ring)
     vI2S_InitRX();              
-    vI2S_StartReaderTask();     
-    setupMicrophoneTimer();     
 
-    // 2. Start FFT processing task
-    vStartFFTTask(xAudioBufferQueue); 
+    // 2. Start DSP and detection tasks (placement in config.h)
+    vStartFFTTask(&xAudioRing); 
 
     // 3. Initialize Wi-Fi 
     vWifiInitSta();            
 
-    // 4. Start web server (it will only serve if Wi-Fi is connected)
+    // 4. Mount the alarm event journal (records this boot)
+    vAlarmJournalStart();
+
+    // 5. Start web server (it will only serve if Wi-Fi is connected)
     vWebServerStart();          
 
+    // 6. Periodic per-stage run time report
+    vStageTimingStart();
+
+    // 7. Static footprint per subsystem; from here on the pipeline takes nothing from the heap
+    vMemPlanReport();
 }
 
@@ -0,0 +1,78 @@
+#include "mem_plan.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_memory_utils.h"
+#include "freertos/FreeRTOS.h"
+#include <stdint.h>
+#include <string.h>
+
+// TAG for logging
+static const char *TAG = "MemPlan";
+
+typedef struct {
+    const char *subsystem;
+    mem_block_t block;
+} mem_entry_t;
+
+// Filled during startup from app_main and the tasks it starts
+static mem_entry_t entries[MEM_PLAN_MAX_BLOCKS];
+static int entryCount = 0;
+static portMUX_TYPE entriesLock = portMUX_INITIALIZER_UNLOCKED;
+
+
+void vMemPlanAdd(const char *subsystem, const char *name, const void *addr, size_t size)
+{
+    portENTER_CRITICAL(&entriesLock);
+    if (entryCount < MEM_PLAN_MAX_BLOCKS)
+    {
+        entries[entryCount].subsystem = subsystem;
+        entries[entryCount].block = (mem_block_t){ .name = name, .addr = addr, .size = size };
+        entryCount++;
+    }
+    portEXIT_CRITICAL(&entriesLock);
+}
+
+
+void vMemPlanReport(void)
+{
+    size_t internal = 0, psram = 0;
+
+    for (int i = 0; i < entryCount; i++)
+    {
+        // Subsystem total, printed at its first entry
+        bool first = true;
+        for (int k = 0; k < i && first; k++)
+            first = strcmp(entries[k].subsystem, entries[i].subsystem) != 0;
+        if (!first)
+            continue;
+
+        size_t subInternal = 0, subPsram = 0;
+        for (int k = i; k < entryCount; k++)
+        {
+            if (strcmp(entries[k].subsystem, entries[i].subsystem) == 0)
+                *(esp_ptr_external_ram(entries[k].block.addr) ? &subPsram : &subInternal) += entries[k].block.size;
+        }
+        ESP_LOGI(TAG, "%-10s %7u B internal, %7u B psram", entries[i].subsystem,
+                 (unsigned)subInternal, (unsigned)subPsram);
+
+        for (int k = i; k < entryCount; k++)
+        {
+            const mem_block_t *b = &entries[k].block;
+            if (strcmp(entries[k].subsystem, entries[i].subsystem) != 0)
+                continue;
+            ESP_LOGI(TAG, "    %-24s %7u B  %-8s%s", b->name, (unsigned)b->size,
+                     esp_ptr_external_ram(b->addr) ? "psram" : "internal",
+                     ((uintptr_t)b->addr % DSP_ALIGN) == 0 ? "" : "  (not 16-byte aligned)");
+        }
+        internal += subInternal;
+        psram += subPsram;
+    }
+
+    ESP_LOGI(TAG, "Static total: %u B internal, %u B psram", (unsigned)internal, (unsigned)psram);
+    ESP_LOGI(TAG, "Heap after startup: internal %u B free (largest block %u B), psram %u B free",
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+             (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL),
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+    if (entryCount == MEM_PLAN_MAX_BLOCKS)
+        ESP_LOGW(TAG, "Report truncated at MEM_PLAN_MAX_BLOCKS entries");
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+/*
+ * Memory plan. DSP working buffers are static, 16-byte aligned (esp-dsp's
+ * SIMD kernels load 128 bits at a time) and in internal RAM. Bulk storage
+ * that is only streamed through (long-window history) is static in PSRAM;
+ * the capture ring is not, because the I2S ISR fills it during flash
+ * operations, when PSRAM is unreachable. Pipeline tasks, queues and
+ * mutexes are created from static storage, so the heap is only used
+ * during startup by the IDF components; a larger FFT_SIZE or a new
+ * feature fails at link time rather than by fragmentation at run time.
+ *
+ * Modules register their static objects with vMemPlanAdd; vMemPlanReport
+ * logs the footprint per subsystem once startup is done.
+ */
+
+#include <stddef.h>
+
+#define DSP_ALIGN           16
+#define DSP_ALIGNED         __attribute__((aligned(DSP_ALIGN)))
+
+// Zero-initialized static in PSRAM (CONFIG_SPIRAM_ALLOW_BSS_SEG_EXTERNAL_MEMORY);
+// plain .bss on the host. Not for data used by IRAM-safe ISRs or DMA.
+#ifdef ESP_PLATFORM
+    #include "esp_attr.h"
+    #define PSRAM_BSS       EXT_RAM_BSS_ATTR
+#else
+    #define PSRAM_BSS
+#endif
+
+// One static object, as listed by a module
+typedef struct {
+    const char *name;
+    const void *addr;
+    size_t size;
+} mem_block_t;
+
+#define MEM_PLAN_MAX_BLOCKS 48
+
+/**
+ * @brief Record a static object of `subsystem` for the boot report; the
+ *        region is taken from its address
+ */
+void vMemPlanAdd(const char *subsystem, const char *name, const void *addr, size_t size);
+
+/**
+ * @brief Log every registered object, the totals per subsystem and region,
+ *        and the heap left over
+ */
+void vMemPlanReport(void);
@@ -0,0 +1,163 @@
+#include "metrics.h"
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+// Bucket upper bounds in µs; durations above the last finite one land in +Inf
+static const uint32_t bucketBound_us[METRICS_HIST_BUCKETS - 1] = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000
+};
+
+static const struct {
+    const char *name;
+    const char *help;
+} histogramInfo[METRIC_HISTOGRAM_COUNT] = {
+    [METRIC_CAPTURE_TO_FFT] = { "capture_to_fft_seconds", "Time from a frame's newest sample to the start of its FFT" },
+    [METRIC_FFT]            = { "fft_seconds",            "Window and FFT of one analysis frame" },
+    [METRIC_ANALYSIS]       = { "analysis_seconds",       "Detection on one band spectrum" },
+};
+
+static const struct {
+    const char *name;
+    const char *help;
+} counterInfo[METRIC_COUNTER_COUNT] = {
+    [METRIC_ALARM_EVENTS_DROPPED] = { "alarm_events_dropped_total", "Alarm events lost because the notify queue was full" },
+    [METRIC_SPECTRA_DROPPED]      = { "spectra_dropped_total",      "Spectra lost because the detect task was behind" },
+    [METRIC_FRAMES_GATED]         = { "frames_gated_total",         "Frames below the energy gate, not transformed" },
+    [METRIC_GATE_AUDITS]          = { "gate_audits_total",          "Frames below the energy gate transformed anyway to check it" },
+    [METRIC_GATE_MISSES]          = { "gate_misses_total",          "Audited frames with a tone on: the gate would have hidden it" },
+};
+
+static const char *const peakQueue[METRIC_PEAK_COUNT] = {
+    [METRIC_SPECTRUM_QUEUE_PEAK] = "spectrum",
+    [METRIC_ALARM_QUEUE_PEAK]    = "alarm_events",
+    [METRIC_AUDIO_RING_PEAK]     = "audio_ring",
+};
+
+// Sequence-counted histogram: odd while its writer is mid-update
+typedef struct {
+    uint32_t seq;
+    metrics_histogram_t h;
+} histogram_slot_t;
+
+static histogram_slot_t histograms[METRIC_HISTOGRAM_COUNT];
+static uint32_t counters[METRIC_COUNTER_COUNT];
+static uint32_t peaks[METRIC_PEAK_COUNT];
+
+
+void metricsObserve(metric_histogram_t id, int64_t duration_us)
+{
+    histogram_slot_t *slot = &histograms[id];
+    metrics_histogram_t *h = &slot->h;
+    uint32_t us = duration_us < 0 ? 0 : (duration_us > UINT32_MAX ? UINT32_MAX : (uint32_t)duration_us);
+
+    int b = 0;
+    while (b < METRICS_HIST_BUCKETS - 1 && us > bucketBound_us[b])
+        b++;
+
+    // Single writer, so no read-modify-write atomics; readers retry on seq
+    __atomic_store_n(&slot->seq, slot->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&h->buckets[b], h->buckets[b] + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&h->count, h->count + 1, __ATOMIC_RELAXED);
+    h->sum_us += us;
+    __atomic_store_n(&slot->seq, slot->seq + 1, __ATOMIC_RELEASE);
+}
+
+void metricsCount(metric_counter_t id)
+{
+    __atomic_fetch_add(&counters[id], 1, __ATOMIC_RELAXED);
+}
+
+void metricsPeak(metric_peak_t id, uint32_t value)
+{
+    uint32_t peak = __atomic_load_n(&peaks[id], __ATOMIC_RELAXED);
+    while (value > peak &&
+           !__atomic_compare_exchange_n(&peaks[id], &peak, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+
+void metricsGetHistogram(metric_histogram_t id, metrics_histogram_t *snapshot)
+{
+    const histogram_slot_t *slot = &histograms[id];
+    uint32_t seq;
+
+    do
+    {
+        seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        for (int b = 0; b < METRICS_HIST_BUCKETS; b++)
+            snapshot->buckets[b] = __atomic_load_n(&slot->h.buckets[b], __ATOMIC_RELAXED);
+        snapshot->count = __atomic_load_n(&slot->h.count, __ATOMIC_RELAXED);
+        snapshot->sum_us = slot->h.sum_us;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((seq & 1) || __atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq);
+}
+
+uint32_t metricsGetCounter(metric_counter_t id)
+{
+    return __atomic_load_n(&counters[id], __ATOMIC_RELAXED);
+}
+
+uint32_t metricsGetPeak(metric_peak_t id)
+{
+    return __atomic_load_n(&peaks[id], __ATOMIC_RELAXED);
+}
+
+
+void metricsAppend(char *buf, size_t size, size_t *pos, const char *fmt, ...)
+{
+    if (*pos >= size)
+        return;
+
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf + *pos, size - *pos, fmt, args);
+    va_end(args);
+
+    *pos = (n < 0 || (size_t)n >= size - *pos) ? size : *pos + n;
+}
+
+size_t metricsFormat(char *buf, size_t size)
+{
+    size_t pos = 0;
+
+    for (int id = 0; id < METRIC_HISTOGRAM_COUNT; id++)
+    {
+        const char *name = histogramInfo[id].name;
+        metrics_histogram_t h;
+        metricsGetHistogram(id, &h);
+
+        metricsAppend(buf, size, &pos, "# HELP " METRICS_PREFIX "%s %s\n# TYPE " METRICS_PREFIX "%s histogram\n",
+                      name, histogramInfo[id].help, name);
+
+        uint32_t cumulative = 0;
+        for (int b = 0; b < METRICS_HIST_BUCKETS - 1; b++)
+        {
+            cumulative += h.buckets[b];
+            metricsAppend(buf, size, &pos, METRICS_PREFIX "%s_bucket{le=\"%g\"} %lu\n",
+                          name, bucketBound_us[b] * 1e-6, (unsigned long)cumulative);
+        }
+        metricsAppend(buf, size, &pos, METRICS_PREFIX "%s_bucket{le=\"+Inf\"} %lu\n", name, (unsigned long)h.count);
+        metricsAppend(buf, size, &pos, METRICS_PREFIX "%s_sum %.6f\n", name, h.sum_us * 1e-6);
+        metricsAppend(buf, size, &pos, METRICS_PREFIX "%s_count %lu\n", name, (unsigned long)h.count);
+    }
+
+    for (int id = 0; id < METRIC_COUNTER_COUNT; id++)
+    {
+        const char *name = counterInfo[id].name;
+        metricsAppend(buf, size, &pos, "# HELP " METRICS_PREFIX "%s %s\n# TYPE " METRICS_PREFIX "%s counter\n"
+                      METRICS_PREFIX "%s %lu\n", name, counterInfo[id].help, name, name,
+                      (unsigned long)metricsGetCounter(id));
+    }
+
+    metricsAppend(buf, size, &pos, "# HELP " METRICS_PREFIX "queue_high_water Most items ever waiting in a queue\n"
+                  "# TYPE " METRICS_PREFIX "queue_high_water gauge\n");
+    for (int id = 0; id < METRIC_PEAK_COUNT; id++)
+    {
+        metricsAppend(buf, size, &pos, METRICS_PREFIX "queue_high_water{queue=\"%s\"} %lu\n",
+                      peakQueue[id], (unsigned long)metricsGetPeak(id));
+    }
+
+    return pos >= size ? 0 : pos;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+/*
+ * Pipeline metrics for the /metrics endpoint: latency histograms, event
+ * counters and peak gauges. Updates are lock-free. Each histogram has a
+ * single writer (the task that runs the measured stage); counters and
+ * peaks may be updated from any task. metricsFormat writes them in the
+ * Prometheus text format; system gauges (heap, stacks) are added by the
+ * HTTP handler.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define METRICS_PREFIX          "firealarm_"
+#define METRICS_HIST_BUCKETS    11      // Upper bounds in metrics.c, the last one +Inf
+
+typedef enum {
+    METRIC_CAPTURE_TO_FFT,      // Newest sample of a frame captured -> its FFT starts
+    METRIC_FFT,                 // Window + FFT of one frame (DSP task)
+    METRIC_ANALYSIS,            // Detection on one band spectrum (detect task)
+    METRIC_HISTOGRAM_COUNT
+} metric_histogram_t;
+
+typedef enum {
+    METRIC_ALARM_EVENTS_DROPPED,    // xFireAlarmEventQueue full
+    METRIC_SPECTRA_DROPPED,         // Spectrum queue full (detect task behind)
+    METRIC_FRAMES_GATED,            // Frames the energy gate kept from the FFT
+    METRIC_GATE_AUDITS,             // Gated frames transformed anyway to check the gate
+    METRIC_GATE_MISSES,             // Audited frames in which detection saw a tone
+    METRIC_COUNTER_COUNT
+} metric_counter_t;
+
+typedef enum {
+    METRIC_SPECTRUM_QUEUE_PEAK,     // Most spectra waiting for the detect task
+    METRIC_ALARM_QUEUE_PEAK,        // Most alarm events waiting for the notifier
+    METRIC_AUDIO_RING_PEAK,         // Capture ring high-water mark (copied from its stats)
+    METRIC_PEAK_COUNT
+} metric_peak_t;
+
+typedef struct {
+    uint32_t buckets[METRICS_HIST_BUCKETS];    // Per bucket, not cumulative
+    uint32_t count;
+    uint64_t sum_us;
+} metrics_histogram_t;
+
+/**
+ * @brief Record one duration; call only from the histogram's own task
+ */
+void metricsObserve(metric_histogram_t id, int64_t duration_us);
+
+/**
+ * @brief Count one event
+ */
+void metricsCount(metric_counter_t id);
+
+/**
+ * @brief Raise a peak gauge to `value` if it is higher
+ */
+void metricsPeak(metric_peak_t id, uint32_t value);
+
+/**
+ * @brief Consistent copy of a histogram (retries while its writer is mid-update)
+ */
+void metricsGetHistogram(metric_histogram_t id, metrics_histogram_t *snapshot);
+
+uint32_t metricsGetCounter(metric_counter_t id);
+uint32_t metricsGetPeak(metric_peak_t id);
+
+/**
+ * @brief Write every histogram, counter and peak in Prometheus text format
+ *
+ * @return length written, or 0 if `size` is too small
+ */
+size_t metricsFormat(char *buf, size_t size);
+
+/**
+ * @brief snprintf at buf + *pos that advances *pos; on overflow *pos = size
+ *        and later calls write nothing
+ */
+void metricsAppend(char *buf, size_t size, size_t *pos, const char *fmt, ...)
+    __attribute__((format(printf, 4, 5)));
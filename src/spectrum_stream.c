@@ -0,0 +1,305 @@
+#include "spectrum_stream.h"
+#include "dsp_spectrum_frame.h"
+#include "web_server.h"
+#include "config.h"
+#include "mem_plan.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include <stdlib.h>
+#include <string.h>
+
+// TAG for logging
+static const char *TAG = "Spectrum";
+
+#define SETTINGS_MAX_LEN    96      // Longest settings query or text message
+
+typedef struct {
+    int      fd;                // -1: free slot
+    int      rate_hz;
+    int      from_hz;           // 0: band start
+    int      to_hz;             // 0: band end
+    bool     delta;
+    bool     pending;           // Previous frame still queued in httpd
+    uint16_t seq;
+    int64_t  next_us;           // Due time of the next frame
+    uint32_t dropped;
+} spectrum_client_t;
+
+// Band levels of one frame, detection task -> stream task
+typedef struct {
+    int64_t timestamp_us;
+    int     start_bin;
+    int     count;
+    float   level_db[MAX_BAND_BINS];
+} spectrum_levels_t;
+
+static spectrum_client_t clients[SPECTRUM_MAX_CLIENTS];
+static int clientCount = 0;
+static SemaphoreHandle_t clientsLock = NULL;
+
+static QueueHandle_t levelsMailbox = NULL;      // One slot, overwritten
+
+// Static task, mailbox and mutex storage (see mem_plan.h)
+static StackType_t streamStack[SPECTRUM_TASK_STACK];
+static StaticTask_t streamTaskBuffer;
+static uint8_t mailboxStorage[sizeof(spectrum_levels_t)];
+static StaticQueue_t mailboxBuffer;
+static StaticSemaphore_t clientsLockBuffer;
+static int64_t publishInterval_us = 0;          // Fastest client's period
+
+
+static int64_t periodOf(int rate_hz)
+{
+    return 1000000LL / rate_hz;
+}
+
+// Call with clientsLock held
+static void updatePublishInterval(void)
+{
+    int64_t fastest = periodOf(1);
+    for (int i = 0; i < SPECTRUM_MAX_CLIENTS; i++)
+    {
+        if (clients[i].fd >= 0 && periodOf(clients[i].rate_hz) < fastest)
+            fastest = periodOf(clients[i].rate_hz);
+    }
+    __atomic_store_n(&publishInterval_us, fastest, __ATOMIC_RELEASE);
+}
+
+
+static bool paramInt(const char *params, const char *key, int min, int max, int *out)
+{
+    char value[16];
+    char *end;
+
+    if (httpd_query_key_value(params, key, value, sizeof(value)) != ESP_OK)
+        return true;    // Absent: keep
+
+    long v = strtol(value, &end, 10);
+    if (end == value || *end != '\0' || v < min || v > max)
+        return false;
+    *out = (int)v;
+    return true;
+}
+
+// Apply "rate", "from", "to", "delta" from `params`; false leaves `c` unchanged
+static bool applySettings(const char *params, spectrum_client_t *c)
+{
+    spectrum_client_t next = *c;
+    int delta = next.delta;
+
+    if (!paramInt(params, "rate", 1, SPECTRUM_MAX_RATE_HZ, &next.rate_hz) ||
+        !paramInt(params, "from", 0, BAND_MAX_HZ, &next.from_hz) ||
+        !paramInt(params, "to", 0, BAND_MAX_HZ, &next.to_hz) ||
+        !paramInt(params, "delta", 0, 1, &delta))
+        return false;
+
+    next.delta = delta;
+    *c = next;
+    return true;
+}
+
+
+// Bins of `levels` the client asked for, clipped to the band
+static void clientRange(const spectrum_client_t *c, const spectrum_levels_t *levels, int *first, int *last)
+{
+    int bandEnd = levels->start_bin + levels->count - 1;
+    int lo = c->from_hz > 0 ? (int)(c->from_hz / FREQ_RESO + 0.5f) : levels->start_bin;
+    int hi = c->to_hz > 0 ? (int)(c->to_hz / FREQ_RESO + 0.5f) : bandEnd;
+
+    lo = lo < levels->start_bin ? levels->start_bin : (lo > bandEnd ? bandEnd : lo);
+    hi = hi > bandEnd ? bandEnd : (hi < lo ? lo : hi);
+    *first = lo;
+    *last = hi;
+}
+
+
+// Encode and queue one frame for every due client; drops for those still sending
+static void sendFrames(const spectrum_levels_t *levels)
+{
+    static uint8_t frame[SPECTRUM_FRAME_HEADER + MAX_BAND_BINS];
+
+    xSemaphoreTake(clientsLock, portMAX_DELAY);
+    for (int i = 0; i < SPECTRUM_MAX_CLIENTS; i++)
+    {
+        spectrum_client_t *c = &clients[i];
+        if (c->fd < 0 || levels->timestamp_us < c->next_us)
+            continue;
+
+        c->next_us += periodOf(c->rate_hz);
+        if (c->next_us < levels->timestamp_us)
+            c->next_us = levels->timestamp_us;
+        c->seq++;   // Also for a dropped frame, so the client sees the gap
+
+        if (__atomic_load_n(&c->pending, __ATOMIC_ACQUIRE))
+        {
+            c->dropped++;
+            continue;
+        }
+
+        int first, last;
+        clientRange(c, levels, &first, &last);
+        size_t length = spectrumFrameEncode(&levels->level_db[first - levels->start_bin], last - first + 1,
+                                            first, FREQ_RESO, c->seq, c->delta, frame, sizeof(frame));
+
+        if (!webserver_send_to(c->fd, frame, length, HTTPD_WS_TYPE_BINARY, &c->pending))
+            c->dropped++;
+    }
+    xSemaphoreGive(clientsLock);
+}
+
+
+static void vSpectrumStreamTask(void *pvParameters)
+{
+    static spectrum_levels_t levels;
+
+    for (;;)
+    {
+        if (xQueueReceive(levelsMailbox, &levels, portMAX_DELAY) == pdPASS)
+            sendFrames(&levels);
+    }
+}
+
+
+void vSpectrumStreamPublish(const dsp_spectrum_t *spectrum)
+{
+    static spectrum_levels_t levels;
+    static int64_t nextPublish_us = 0;
+
+    QueueHandle_t mailbox = __atomic_load_n(&levelsMailbox, __ATOMIC_ACQUIRE);
+    if (mailbox == NULL || __atomic_load_n(&clientCount, __ATOMIC_ACQUIRE) == 0)
+        return;
+
+    int64_t now_us = esp_timer_get_time();
+    if (now_us < nextPublish_us)
+        return;
+    nextPublish_us = now_us + __atomic_load_n(&publishInterval_us, __ATOMIC_ACQUIRE);
+
+    levels.timestamp_us = now_us;
+    levels.count = dspSpectrumLevels(spectrum, levels.level_db, &levels.start_bin);
+    xQueueOverwrite(mailbox, &levels);
+}
+
+
+esp_err_t spectrum_ws_handler(httpd_req_t *req)
+{
+    char params[SETTINGS_MAX_LEN + 1] = "";
+    int fd = httpd_req_to_sockfd(req);
+
+    if (req->method == HTTP_GET)
+    {
+        spectrum_client_t client = {
+            .fd = fd,
+            .rate_hz = SPECTRUM_DEFAULT_RATE_HZ,
+            .next_us = esp_timer_get_time(),
+        };
+
+        size_t query_len = httpd_req_get_url_query_len(req);
+        if (query_len > SETTINGS_MAX_LEN ||
+            (query_len > 0 && (httpd_req_get_url_query_str(req, params, sizeof(params)) != ESP_OK ||
+                               !applySettings(params, &client))))
+        {
+            ESP_LOGW(TAG, "Invalid spectrum settings (fd=%d)", fd);
+            return ESP_FAIL;
+        }
+
+        int slot = -1;
+        xSemaphoreTake(clientsLock, portMAX_DELAY);
+        for (int i = 0; i < SPECTRUM_MAX_CLIENTS && slot < 0; i++)
+        {
+            if (clients[i].fd < 0)
+                slot = i;
+        }
+        if (slot >= 0)
+        {
+            clients[slot] = client;
+            __atomic_add_fetch(&clientCount, 1, __ATOMIC_ACQ_REL);
+            updatePublishInterval();
+        }
+        xSemaphoreGive(clientsLock);
+
+        if (slot < 0)
+        {
+            ESP_LOGW(TAG, "Spectrum client refused (fd=%d), %d clients connected", fd, SPECTRUM_MAX_CLIENTS);
+            return ESP_FAIL;
+        }
+        ESP_LOGI(TAG, "Spectrum client connected (fd=%d, %d Hz)", fd, client.rate_hz);
+        return ESP_OK;
+    }
+
+    // Settings change as a text message
+    httpd_ws_frame_t ws_pkt = { .type = HTTPD_WS_TYPE_TEXT };
+    esp_err_t ret = httpd_ws_recv_frame(req, &ws_pkt, 0);
+    if (ret != ESP_OK || ws_pkt.len > SETTINGS_MAX_LEN)
+        return ret == ESP_OK ? ESP_FAIL : ret;
+
+    ws_pkt.payload = (uint8_t *)params;
+    ret = httpd_ws_recv_frame(req, &ws_pkt, SETTINGS_MAX_LEN);
+    if (ret != ESP_OK || ws_pkt.type != HTTPD_WS_TYPE_TEXT)
+        return ret;
+    params[ws_pkt.len] = '\0';
+
+    bool applied = false;
+    xSemaphoreTake(clientsLock, portMAX_DELAY);
+    for (int i = 0; i < SPECTRUM_MAX_CLIENTS; i++)
+    {
+        if (clients[i].fd == fd)
+        {
+            applied = applySettings(params, &clients[i]);
+            updatePublishInterval();
+        }
+    }
+    xSemaphoreGive(clientsLock);
+
+    if (!applied)
+        ESP_LOGW(TAG, "Ignoring spectrum settings \"%s\" (fd=%d)", params, fd);
+    return ESP_OK;
+}
+
+
+void vSpectrumStreamClose(int fd)
+{
+    if (clientsLock == NULL)
+        return;
+
+    xSemaphoreTake(clientsLock, portMAX_DELAY);
+    for (int i = 0; i < SPECTRUM_MAX_CLIENTS; i++)
+    {
+        if (clients[i].fd == fd)
+        {
+            ESP_LOGI(TAG, "Spectrum client removed (fd=%d, %lu frames dropped)", fd,
+                     (unsigned long)clients[i].dropped);
+            clients[i].fd = -1;
+            __atomic_sub_fetch(&clientCount, 1, __ATOMIC_ACQ_REL);
+            updatePublishInterval();
+        }
+    }
+    xSemaphoreGive(clientsLock);
+}
+
+
+void vSpectrumStreamStart(void)
+{
+    for (int i = 0; i < SPECTRUM_MAX_CLIENTS; i++)
+        clients[i].fd = -1;
+
+    clientsLock = xSemaphoreCreateMutexStatic(&clientsLockBuffer);
+    QueueHandle_t mailbox = xQueueCreateStatic(1, sizeof(spectrum_levels_t), mailboxStorage, &mailboxBuffer);
+
+    xTaskCreateStaticPinnedToCore(
+        vSpectrumStreamTask,        // Task function
+        SPECTRUM_TASK_NAME,         // Name
+        SPECTRUM_TASK_STACK,        // Stack size
+        NULL,                       // Parameters
+        SPECTRUM_TASK_PRIORITY,     // Priority
+        streamStack,                // Stack
+        &streamTaskBuffer,          // Task control block
+        NOTIFY_TASK_CORE            // Core
+    );
+
+    vMemPlanAdd("web", "spectrum task stack", streamStack, sizeof(streamStack));
+    vMemPlanAdd("web", "spectrum mailbox", mailboxStorage, sizeof(mailboxStorage));
+
+    // Publishing starts once the task can drain the mailbox
+    __atomic_store_n(&levelsMailbox, mailbox, __ATOMIC_RELEASE);
+}
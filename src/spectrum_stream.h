@@ -0,0 +1,50 @@
+#pragma once
+
+/*
+ * Live band spectrum over the /spectrum WebSocket. The detection task
+ * publishes levels into a one-slot mailbox (never blocks, newest wins);
+ * the stream task encodes a dsp_spectrum_frame per client at the client's
+ * rate and range. A client whose previous frame is still queued in httpd
+ * skips frames instead of building a backlog.
+ *
+ * Client settings, as query parameters on connect or as a text message
+ * ("rate=10&from=2900&to=3100&delta=1") at any time:
+ *   rate   updates per second, 1..SPECTRUM_MAX_RATE_HZ
+ *   from   first frequency in Hz (clipped to the detection band)
+ *   to     last frequency in Hz
+ *   delta  1 = delta-encoded levels
+ */
+
+#include <stdbool.h>
+#include "esp_http_server.h"
+#include "dsp_core.h"
+
+// Stream task config (core: NOTIFY_TASK_CORE, below the alarm notifier)
+#define SPECTRUM_TASK_NAME      "SpectrumStream"
+#define SPECTRUM_TASK_STACK     3072
+#define SPECTRUM_TASK_PRIORITY  (NOTIFY_TASK_PRIORITY - 1)
+
+// Spectrum subscribers served at once (each also takes one httpd socket)
+#define SPECTRUM_MAX_CLIENTS    2
+
+/**
+ * @brief Create the mailbox and start the stream task
+ */
+void vSpectrumStreamStart(void);
+
+/**
+ * @brief Offer one analyzed spectrum (detection task, after dspAnalyzeSpectrum).
+ *        Returns at once when nobody listens or no client is due.
+ */
+void vSpectrumStreamPublish(const dsp_spectrum_t *spectrum);
+
+/**
+ * @brief WebSocket handler for /spectrum: subscribe on connect, settings
+ *        from text messages
+ */
+esp_err_t spectrum_ws_handler(httpd_req_t *req);
+
+/**
+ * @brief Forget `fd` if it is a subscriber (session closed)
+ */
+void vSpectrumStreamClose(int fd);
@@ -0,0 +1,27 @@
+#include "spsc_ring.h"
+#include <string.h>
+
+bool spscRingInit(spsc_ring_t *ring, void *storage, uint32_t slot_size, uint32_t slots)
+{
+    if (storage == NULL || slot_size == 0 || slots == 0 || (slots & (slots - 1)) != 0)
+        return false;
+
+    memset(ring, 0, sizeof(*ring));
+    ring->storage = storage;
+    ring->slot_size = slot_size;
+    ring->mask = slots - 1;
+    return true;
+}
+
+void spscRingGetStats(const spsc_ring_t *ring, spsc_ring_stats_t *stats)
+{
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    stats->committed  = head;
+    stats->released   = tail;
+    stats->overruns   = __atomic_load_n(&ring->overruns, __ATOMIC_RELAXED);
+    stats->high_water = __atomic_load_n(&ring->high_water, __ATOMIC_RELAXED);
+    stats->lag        = head - tail;
+    stats->capacity   = ring->mask + 1;
+}
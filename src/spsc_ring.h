@@ -0,0 +1,118 @@
+#pragma once
+
+/*
+ * Lock-free single-producer / single-consumer ring of fixed-size slots.
+ * The producer fills a slot in place (reserve/commit) and the consumer
+ * reads it in place (peek/release), so blocks are never copied.
+ * Producer and consumer indices live on separate cache lines.
+ *
+ * The hot operations are forced inline (SPSC_INLINE), so they compile into
+ * their caller at any optimization level: called from an IRAM ISR they
+ * run from IRAM too, never from flash.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Inlined whatever the optimization level (-Og included)
+#define SPSC_INLINE         static inline __attribute__((always_inline))
+
+#ifndef SPSC_CACHE_LINE
+#define SPSC_CACHE_LINE     64
+#endif
+
+typedef struct {
+    // Producer side
+    uint32_t head __attribute__((aligned(SPSC_CACHE_LINE)));    // Slots committed (free-running)
+    uint32_t overruns;                                           // Reserve failed: ring full
+    uint32_t high_water;                                         // Max slots occupied
+
+    // Consumer side
+    uint32_t tail __attribute__((aligned(SPSC_CACHE_LINE)));    // Slots released (free-running)
+
+    // Fixed after init
+    uint8_t *storage __attribute__((aligned(SPSC_CACHE_LINE)));
+    uint32_t slot_size;
+    uint32_t mask;
+} spsc_ring_t;
+
+typedef struct {
+    uint32_t committed;         // Blocks produced
+    uint32_t released;          // Blocks consumed
+    uint32_t overruns;          // Blocks the producer could not place
+    uint32_t high_water;        // Max occupancy seen
+    uint32_t lag;               // Blocks waiting for the consumer now
+    uint32_t capacity;
+} spsc_ring_stats_t;
+
+/**
+ * @brief Set up a ring over `storage` (slots * slot_size bytes); slots must be a power of 2
+ */
+bool spscRingInit(spsc_ring_t *ring, void *storage, uint32_t slot_size, uint32_t slots);
+
+void spscRingGetStats(const spsc_ring_t *ring, spsc_ring_stats_t *stats);
+
+
+// -------- Producer --------
+
+/**
+ * @brief Slot to fill next, or NULL (and an overrun counted) if the ring is full
+ */
+SPSC_INLINE void *spscRingReserve(spsc_ring_t *ring)
+{
+    uint32_t head = ring->head;
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    if (head - tail > ring->mask)
+    {
+        ring->overruns++;
+        return NULL;
+    }
+    return ring->storage + (head & ring->mask) * ring->slot_size;
+}
+
+/**
+ * @brief Publish the reserved slot to the consumer
+ */
+SPSC_INLINE void spscRingCommit(spsc_ring_t *ring)
+{
+    uint32_t head = ring->head + 1;
+    uint32_t used = head - __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+
+    if (used > ring->high_water)
+        ring->high_water = used;
+    __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+}
+
+
+// -------- Consumer --------
+
+/**
+ * @brief Oldest committed slot, or NULL if empty
+ */
+SPSC_INLINE const void *spscRingPeek(spsc_ring_t *ring)
+{
+    uint32_t tail = ring->tail;
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+    if (head == tail)
+        return NULL;
+    return ring->storage + (tail & ring->mask) * ring->slot_size;
+}
+
+/**
+ * @brief Hand the peeked slot back to the producer
+ */
+SPSC_INLINE void spscRingRelease(spsc_ring_t *ring)
+{
+    __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Committed blocks the consumer has not released yet
+ */
+SPSC_INLINE uint32_t spscRingLag(const spsc_ring_t *ring)
+{
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,102 @@
+#include "stage_timing.h"
+#include "i2s_config.h"
+#include "dsp_core.h"
+#include "config.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+// TAG for logging
+static const char *TAG = "Stages";
+
+static stage_time_t stageTimes[STAGE_COUNT];
+static volatile uint32_t reportEpoch = 0;
+
+// Period of each stage: a run longer than this falls behind real time
+static DRAM_ATTR const uint32_t stageBudget_us[STAGE_COUNT] = {
+    [STAGE_CAPTURE] = (uint32_t)(1e6f * I2S_DMA_FRAME_NUM / I2S_SAMPLE_RATE_HZ),
+    [STAGE_DSP]     = (uint32_t)(1e6f * HOP_SIZE / SAMPLE_RATE),
+    [STAGE_DETECT]  = (uint32_t)(1e6f * HOP_SIZE / SAMPLE_RATE),
+    [STAGE_NOTIFY]  = 0,    // Event driven
+};
+
+
+IRAM_ATTR void vStageRecord(pipeline_stage_t stage, int64_t start_us)
+{
+    stage_time_t *t = &stageTimes[stage];
+    uint32_t us = (uint32_t)(esp_timer_get_time() - start_us);
+
+    // First run since a report starts a new max
+    if (t->epoch != reportEpoch)
+    {
+        t->epoch = reportEpoch;
+        t->max_us = 0;
+    }
+
+    t->runs++;
+    t->busy_us += us;
+    if (us > t->max_us)
+        t->max_us = us;
+    if (stageBudget_us[stage] != 0 && us > stageBudget_us[stage])
+        t->over_budget++;
+}
+
+void vStageGetTime(pipeline_stage_t stage, stage_time_t *time)
+{
+    *time = stageTimes[stage];
+}
+
+
+#if STAGE_REPORT_INTERVAL_S > 0
+static const char *const stageNames[STAGE_COUNT] = { "capture", "dsp", "detect", "notify" };
+static const int stageCores[STAGE_COUNT] = { CAPTURE_CORE, DSP_TASK_CORE, DETECT_TASK_CORE, NOTIFY_TASK_CORE };
+
+// esp_timer callback: one line per stage with the differences since the last report
+static void reportStages(void *arg)
+{
+    static stage_time_t last[STAGE_COUNT];
+    static int64_t lastReport_us = 0;
+
+    int64_t now_us = esp_timer_get_time();
+    float interval_us = (float)(now_us - lastReport_us);
+
+    for (int s = 0; s < STAGE_COUNT; s++)
+    {
+        stage_time_t t;
+        vStageGetTime(s, &t);
+
+        uint32_t runs = t.runs - last[s].runs;
+        uint32_t busy = t.busy_us - last[s].busy_us;
+        uint32_t over = t.over_budget - last[s].over_budget;
+        uint32_t max = t.epoch == reportEpoch ? t.max_us : 0;
+        char core = stageCores[s] == tskNO_AFFINITY ? '*' : (char)('0' + stageCores[s]);
+
+        ESP_LOGI(TAG, "%-7s core %c: %5lu runs, mean %6lu us, max %6lu us, %5.1f%% CPU, %lu over %lu us",
+                 stageNames[s], core, (unsigned long)runs, (unsigned long)(runs ? busy / runs : 0),
+                 (unsigned long)max, 100.0f * busy / interval_us, (unsigned long)over,
+                 (unsigned long)stageBudget_us[s]);
+        last[s] = t;
+    }
+
+    reportEpoch++;
+    lastReport_us = now_us;
+}
+#endif
+
+
+void vStageTimingStart(void)
+{
+#if STAGE_REPORT_INTERVAL_S > 0
+    static esp_timer_handle_t reportTimer = NULL;
+    const esp_timer_create_args_t args = {
+        .callback = reportStages,
+        .name = "stage_report",
+    };
+
+    if (esp_timer_create(&args, &reportTimer) != ESP_OK ||
+        esp_timer_start_periodic(reportTimer, STAGE_REPORT_INTERVAL_S * 1000000LL) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to start stage timing report");
+    }
+#endif
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+/*
+ * Run time of each pipeline stage. Every stage records its own runs from
+ * the one task or ISR that executes it, so the counters need no locks.
+ * The periodic report logs runs, mean and max time, and each stage's share
+ * of its core, so the placement in config.h can be tuned from data.
+ */
+
+#include <stdint.h>
+
+typedef enum {
+    STAGE_CAPTURE,      // I2S DMA callback, once per DMA buffer
+    STAGE_DSP,          // Window + FFT, once per hop
+    STAGE_DETECT,       // Band analysis and cadence, once per hop
+    STAGE_NOTIFY,       // Alarm message and WebSocket send, once per event
+    STAGE_COUNT
+} pipeline_stage_t;
+
+typedef struct {
+    uint32_t runs;          // Free-running; intervals are differences
+    uint32_t busy_us;       // Free-running
+    uint32_t max_us;        // Longest run since the last report
+    uint32_t over_budget;   // Runs longer than the stage's period (free-running)
+    uint32_t epoch;         // Report interval max_us belongs to
+} stage_time_t;
+
+/**
+ * @brief Count one run of `stage` that started at `start_us` (esp_timer
+ *        time) and ends now. ISR safe; call only from the stage's own context.
+ */
+void vStageRecord(pipeline_stage_t stage, int64_t start_us);
+
+/**
+ * @brief Copy the counters of `stage`
+ */
+void vStageGetTime(pipeline_stage_t stage, stage_time_t *time);
+
+/**
+ * @brief Log every STAGE_REPORT_INTERVAL_S seconds (no-op if 0)
+ */
+void vStageTimingStart(void);
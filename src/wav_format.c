@@ -0,0 +1,51 @@
+#include "wav_format.h"
+#include <string.h>
+
+static void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    put16(p, (uint16_t)v);
+    put16(p + 2, (uint16_t)(v >> 16));
+}
+
+
+void wavHeader(uint8_t header[WAV_HEADER_SIZE], uint32_t sample_rate, int bits, int channels, uint32_t data_bytes)
+{
+    int block_align = channels * bits / 8;
+
+    memcpy(header, "RIFF", 4);
+    put32(header + 4, 36 + data_bytes);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    put32(header + 16, 16);                         // fmt chunk size
+    put16(header + 20, 1);                          // PCM
+    put16(header + 22, (uint16_t)channels);
+    put32(header + 24, sample_rate);
+    put32(header + 28, sample_rate * block_align);  // Byte rate
+    put16(header + 32, (uint16_t)block_align);
+    put16(header + 34, (uint16_t)bits);
+    memcpy(header + 36, "data", 4);
+    put32(header + 40, data_bytes);
+}
+
+
+int wavPackSamples(const int32_t *samples, int count, int bits, uint8_t *out)
+{
+    if (bits == 32)
+    {
+        for (int i = 0; i < count; i++)
+            put32(out + 4 * i, (uint32_t)samples[i]);
+        return count * 4;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        int64_t v = ((int64_t)samples[i] + 0x8000) >> 16;
+        put16(out + 2 * i, (uint16_t)(int16_t)(v > INT16_MAX ? INT16_MAX : v));
+    }
+    return count * 2;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+/*
+ * Minimal PCM WAV writer for streamed captures: a 44-byte header with the
+ * final data size, then sample blocks packed as they arrive. Samples are
+ * the capture format (left-justified int32); 16-bit output keeps the top
+ * bits, rounded and saturated.
+ */
+
+#include <stdint.h>
+
+#define WAV_HEADER_SIZE     44
+
+/**
+ * @brief Canonical RIFF/WAVE header for PCM
+ *
+ * @param bits 16 or 32
+ * @param channels interleaved channels per frame (1 = mono)
+ * @param data_bytes size of the sample data that will follow
+ */
+void wavHeader(uint8_t header[WAV_HEADER_SIZE], uint32_t sample_rate, int bits, int channels, uint32_t data_bytes);
+
+/**
+ * @brief Pack `count` samples little-endian at 16 or 32 bits
+ *
+ * @return bytes written to `out` (count * bits / 8)
+ */
+int wavPackSamples(const int32_t *samples, int count, int bits, uint8_t *out);
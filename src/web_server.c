@@ -1,17 +1,80 @@
 #include "web_server.h"
+#include "stage_timing.h"
+#include "config_store.h"
+#include "dsp_core.h"
+#include "spectrum_stream.h"
+#include "metrics.h"
+#include "alarm_journal.h"
+#include "audio_recorder.h"
+#include "dsp_spectrum_frame.h"
+#include "mem_plan.h"
+#include "fft.h"
+#include "i2s_config.h"
+#include "config.h"
 #include "esp_http_server.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
 
 static const char *TAG = "web_server";
+
+/* POST /config: largest query or form body, and how long to wait for the DSP to apply a previous change */
+#define CONFIG_REQUEST_MAX      256
+#define CONFIG_BUSY_RETRIES     10
+#define CONFIG_BUSY_DELAY_MS    50
+
+/* GET /metrics: buffer for each of the two response chunks (handlers run one at a time in the httpd task, so buffers are static) */
+#define METRICS_CHUNK_SIZE      4096
+
+/* GET /events: records per page, and the buffer each chunk is built in */
+#define EVENTS_PAGE_DEFAULT     32
+#define EVENTS_PAGE_MAX         64
+#define EVENTS_CHUNK_SIZE       1024
 static httpd_handle_t server = NULL;
 
 QueueHandle_t xFireAlarmEventQueue = NULL;
 TaskHandle_t xWebNotifyTaskHandle = NULL;
 
-/* Track one WebSocket client (enough for now) */
-static int ws_client_fd = -1;
+/* WebSocket subscribers. Added and reaped in the httpd task, read by broadcasters. */
+static int ws_clients[WS_MAX_CLIENTS];
+static int ws_client_count = 0;
+static SemaphoreHandle_t ws_clients_lock = NULL;
+
+/* One broadcast frame, shared by every client's send. Each queued send holds
+ * a reference; the last one to finish returns it to the pool. */
+typedef struct ws_buffer ws_buffer_t;
+
+typedef struct {
+    ws_buffer_t *buf;
+    int fd;
+    bool *pending;          // Cleared once the send has run (NULL: not tracked)
+} ws_send_t;
+
+struct ws_buffer {
+    int refs;
+    httpd_ws_type_t type;
+    size_t len;
+    ws_send_t sends[WS_MAX_CLIENTS];    // Work item argument per client
+    uint8_t payload[WS_PAYLOAD_MAX];
+};
+
+_Static_assert(SPECTRUM_FRAME_HEADER + MAX_BAND_BINS <= WS_PAYLOAD_MAX, "spectrum frames must fit a pool buffer");
+_Static_assert(WS_POOL_BUFFERS <= 32, "pool bitmap is 32 bits");
+
+/* Static storage (see mem_plan.h): frame pool, notifier task, queue and lock */
+static ws_buffer_t ws_pool[WS_POOL_BUFFERS];
+static uint32_t ws_pool_used = 0;           /* Bit per ws_pool entry */
+static StackType_t notify_stack[TASK_WEB_READER_STACK];
+static StaticTask_t notify_task_buffer;
+static uint8_t event_queue_storage[ALARM_EVENT_QUEUE_LEN * sizeof(web_event_t)];
+static StaticQueue_t event_queue_buffer;
+static StaticSemaphore_t ws_clients_lock_buffer;
+static char metrics_buf[METRICS_CHUNK_SIZE];
 
 /* Embedded HTML page */
 static const char index_html[] =
@@ -24,13 +87,44 @@ static const char index_html[] =
 "    body { font-family: Arial; text-align: center; margin-top: 50px; }\n"
 "    #log { font-family: monospace; text-align: left; margin: 20px auto; width: 80%; height: 300px;\n"
 "           overflow-y: scroll; border: 1px solid #ccc; padding: 10px; background-color: #f9f9f9; }\n"
+"    #spectrum { border: 1px solid #ccc; background-color: #111; width: 80%; height: 200px; }\n"
 "  </style>\n"
 "</head>\n"
 "<body>\n"
 "  <h1>🚨 ESP32 Fire Alarm Monitor 🚨</h1>\n"
 "  <div id='log'>System Normal</div>\n"
+"  <label><input type='checkbox' id='live'> Live spectrum</label>\n"
+"  <div id='band'></div>\n"
+"  <canvas id='spectrum' width='800' height='200' hidden></canvas>\n"
 "\n"
 "  <script>\n"
+"    // Binary frames: see dsp_spectrum_frame.h\n"
+"    let sws = null;\n"
+"    document.getElementById('live').onchange = function(e) {\n"
+"      const cv = document.getElementById('spectrum');\n"
+"      cv.hidden = !e.target.checked;\n"
+"      if (!e.target.checked) { if (sws) sws.close(); sws = null; return; }\n"
+"      sws = new WebSocket('ws://' + location.host + '/spectrum?rate=10&delta=1');\n"
+"      sws.binaryType = 'arraybuffer';\n"
+"      sws.onmessage = function(event) {\n"
+"        const v = new DataView(event.data);\n"
+"        if (v.getUint8(0) != 1) return;\n"
+"        const delta = v.getUint8(1) & 1, first = v.getUint16(4, true), n = v.getUint16(6, true);\n"
+"        const hz = v.getFloat32(8, true), ctx = cv.getContext('2d'), w = cv.width / n;\n"
+"        ctx.fillStyle = '#111'; ctx.fillRect(0, 0, cv.width, cv.height);\n"
+"        ctx.fillStyle = '#4c4';\n"
+"        let code = 0;\n"
+"        for (let i = 0; i < n; i++) {\n"
+"          const b = v.getUint8(12 + i);\n"
+"          code = delta ? (code + b) & 255 : b;\n"
+"          const h = code * cv.height / 255;\n"
+"          ctx.fillRect(i * w, cv.height - h, Math.max(w - 1, 1), h);\n"
+"        }\n"
+"        document.getElementById('band').textContent =\n"
+"          Math.round(first * hz) + ' - ' + Math.round((first + n - 1) * hz) + ' Hz, -127.5 .. 0 dB';\n"
+"      };\n"
+"    };\n"
+"\n"
 "    const ws = new WebSocket('ws://' + location.host + '/ws');\n"
 "    ws.onmessage = function(event) {\n"
 "      const logDiv = document.getElementById('log');\n"
@@ -55,13 +149,90 @@ static esp_err_t root_get_handler(httpd_req_t *req)
     return ESP_OK;
 }
 
+/* -----------------------------
+ * WebSocket client registry
+ * ----------------------------- */
+static bool ws_client_add(int fd)
+{
+    bool added = false;
+
+    xSemaphoreTake(ws_clients_lock, portMAX_DELAY);
+    for (int i = 0; i < ws_client_count; i++)
+    {
+        if (ws_clients[i] == fd)
+            added = true;
+    }
+    if (!added && ws_client_count < WS_MAX_CLIENTS)
+    {
+        ws_clients[ws_client_count++] = fd;
+        added = true;
+    }
+    xSemaphoreGive(ws_clients_lock);
+
+    return added;
+}
+
+static void ws_client_remove(int fd)
+{
+    xSemaphoreTake(ws_clients_lock, portMAX_DELAY);
+    for (int i = 0; i < ws_client_count; i++)
+    {
+        if (ws_clients[i] == fd)
+        {
+            ws_clients[i] = ws_clients[--ws_client_count];
+            ESP_LOGI(TAG, "WebSocket client removed (fd=%d, %d left)", fd, ws_client_count);
+            break;
+        }
+    }
+    xSemaphoreGive(ws_clients_lock);
+}
+
+/* Drop registered fds that are no longer open WebSockets */
+static void ws_client_reap(void)
+{
+    int fds[WS_MAX_CLIENTS];
+    int count;
+
+    xSemaphoreTake(ws_clients_lock, portMAX_DELAY);
+    count = ws_client_count;
+    memcpy(fds, ws_clients, count * sizeof(int));
+    xSemaphoreGive(ws_clients_lock);
+
+    for (int i = 0; i < count; i++)
+    {
+        if (httpd_ws_get_fd_info(server, fds[i]) != HTTPD_WS_CLIENT_WEBSOCKET)
+            ws_client_remove(fds[i]);
+    }
+}
+
+/* Session close hook: unregister, then close the socket as httpd would */
+static void ws_close_fn(httpd_handle_t hd, int sockfd)
+{
+    (void)hd;
+    ws_client_remove(sockfd);
+    vSpectrumStreamClose(sockfd);
+    close(sockfd);
+}
+
+
 /* WebSocket handler */
 static esp_err_t ws_handler(httpd_req_t *req)
 {
     if (req->method == HTTP_GET)
     {
-        ws_client_fd = httpd_req_to_sockfd(req);
-        ESP_LOGI(TAG, "WebSocket client connected (fd=%d)", ws_client_fd);
+        int fd = httpd_req_to_sockfd(req);
+
+        // Full: make room from clients that went away without a close
+        if (!ws_client_add(fd))
+        {
+            ws_client_reap();
+            if (!ws_client_add(fd))
+            {
+                ESP_LOGW(TAG, "WebSocket client refused (fd=%d), %d clients connected", fd, WS_MAX_CLIENTS);
+                return ESP_FAIL;
+            }
+        }
+        ESP_LOGI(TAG, "WebSocket client connected (fd=%d)", fd);
         return ESP_OK;
     }
 
@@ -75,23 +246,462 @@ static esp_err_t ws_handler(httpd_req_t *req)
     return ret;
 }
 
+/* HTTP handler for GET '/config': current detector configuration as JSON */
+static esp_err_t config_get_handler(httpd_req_t *req)
+{
+    detector_config_t cfg;
+    char json[192];
+
+    dspCoreGetConfig(&cfg);
+    detectorConfigFormat(&cfg, json, sizeof(json));
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, json, HTTPD_RESP_USE_STRLEN);
+    return ESP_OK;
+}
+
+/* Apply every known key found in `params` (key=value&...) to `cfg` */
+static bool config_parse_params(const char *params, detector_config_t *cfg)
+{
+    char value[32];
+
+    for (int k = 0; detectorConfigKeys[k] != NULL; k++)
+    {
+        if (httpd_query_key_value(params, detectorConfigKeys[k], value, sizeof(value)) != ESP_OK)
+            continue;
+        if (!detectorConfigSet(cfg, detectorConfigKeys[k], value))
+            return false;
+    }
+    return true;
+}
+
+/* HTTP handler for POST '/config': fields from the query string and/or a
+ * form body; omitted fields keep their current value. Applied, then saved. */
+static esp_err_t config_post_handler(httpd_req_t *req)
+{
+    detector_config_t cfg;
+    char params[CONFIG_REQUEST_MAX + 1];
+    bool parsed = true;
+
+    dspCoreGetConfig(&cfg);
+
+    size_t query_len = httpd_req_get_url_query_len(req);
+    if (query_len > CONFIG_REQUEST_MAX)
+        parsed = false;
+    else if (query_len > 0 && httpd_req_get_url_query_str(req, params, sizeof(params)) == ESP_OK)
+        parsed = config_parse_params(params, &cfg);
+
+    if (parsed && req->content_len > CONFIG_REQUEST_MAX)
+        parsed = false;
+    else if (parsed && req->content_len > 0)
+    {
+        int received = 0;
+        while (received < (int)req->content_len)
+        {
+            int ret = httpd_req_recv(req, params + received, req->content_len - received);
+            if (ret <= 0)
+                return ESP_FAIL;
+            received += ret;
+        }
+        params[received] = '\0';
+        parsed = config_parse_params(params, &cfg);
+    }
+
+    if (!parsed || !detectorConfigValid(&cfg))
+    {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid detector config");
+        return ESP_OK;
+    }
+
+    // The DSP takes one change per frame boundary
+    dsp_config_status_t status = dspCoreConfigure(&cfg);
+    for (int i = 0; status == DSP_CONFIG_BUSY && i < CONFIG_BUSY_RETRIES; i++)
+    {
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_BUSY_DELAY_MS));
+        status = dspCoreConfigure(&cfg);
+    }
+
+    if (status != DSP_CONFIG_OK)
+    {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_send(req, "Detector busy, retry", HTTPD_RESP_USE_STRLEN);
+        return ESP_OK;
+    }
+
+    if (xConfigStoreSave(&cfg) != ESP_OK)
+        ESP_LOGW(TAG, "Detector config applied but not saved");
+
+    char json[192];
+    detectorConfigFormat(&cfg, json, sizeof(json));
+    ESP_LOGI(TAG, "Detector config: %s", json);
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, json, HTTPD_RESP_USE_STRLEN);
+    return ESP_OK;
+}
+
 /* -----------------------------
- * Send arbitrary JSON message
+ * Metrics
  * ----------------------------- */
-void webserver_send_message(const char *msg)
+/* Capture counters, task stacks and heap, read at scrape time */
+static size_t metrics_format_system(char *buf, size_t size)
+{
+    static const char *const tasks[] = {
+        FFT_TASK_NAME, DETECT_TASK_NAME, TASK_WEB_READER_NAME, SPECTRUM_TASK_NAME, ALARM_JOURNAL_TASK_NAME,
+        CAPTURE_TASK_NAME, "httpd"
+    };
+    static const struct { const char *name; uint32_t caps; } regions[] = {
+        { "internal", MALLOC_CAP_INTERNAL },
+        { "psram",    MALLOC_CAP_SPIRAM },
+    };
+    i2s_capture_stats_t capture;
+    size_t pos = 0;
+
+    vI2S_GetCaptureStats(&capture);
+    metricsAppend(buf, size, &pos,
+        "# HELP " METRICS_PREFIX "audio_blocks_dropped_total Capture blocks lost because the audio ring was full\n"
+        "# TYPE " METRICS_PREFIX "audio_blocks_dropped_total counter\n"
+        METRICS_PREFIX "audio_blocks_dropped_total %lu\n"
+        "# HELP " METRICS_PREFIX "dma_buffers_lost_total I2S DMA buffers overwritten or skipped before the capture ISR ran\n"
+        "# TYPE " METRICS_PREFIX "dma_buffers_lost_total counter\n"
+        METRICS_PREFIX "dma_buffers_lost_total %lu\n",
+        (unsigned long)capture.blocks_dropped, (unsigned long)capture.dma_buffers_lost);
+
+    metricsAppend(buf, size, &pos,
+        "# HELP " METRICS_PREFIX "task_stack_free_bytes Least free stack a task has had\n"
+        "# TYPE " METRICS_PREFIX "task_stack_free_bytes gauge\n");
+    for (int i = 0; i < sizeof(tasks) / sizeof(tasks[0]); i++)
+    {
+        TaskHandle_t task = xTaskGetHandle(tasks[i]);
+        if (task != NULL)
+            metricsAppend(buf, size, &pos, METRICS_PREFIX "task_stack_free_bytes{task=\"%s\"} %u\n",
+                          tasks[i], (unsigned)uxTaskGetStackHighWaterMark(task));
+    }
+
+    metricsAppend(buf, size, &pos,
+        "# HELP " METRICS_PREFIX "heap_free_bytes Free heap\n"
+        "# TYPE " METRICS_PREFIX "heap_free_bytes gauge\n");
+    for (int i = 0; i < sizeof(regions) / sizeof(regions[0]); i++)
+        metricsAppend(buf, size, &pos, METRICS_PREFIX "heap_free_bytes{region=\"%s\"} %u\n",
+                      regions[i].name, (unsigned)heap_caps_get_free_size(regions[i].caps));
+
+    metricsAppend(buf, size, &pos,
+        "# HELP " METRICS_PREFIX "heap_min_free_bytes Lowest free heap since boot\n"
+        "# TYPE " METRICS_PREFIX "heap_min_free_bytes gauge\n");
+    for (int i = 0; i < sizeof(regions) / sizeof(regions[0]); i++)
+        metricsAppend(buf, size, &pos, METRICS_PREFIX "heap_min_free_bytes{region=\"%s\"} %u\n",
+                      regions[i].name, (unsigned)heap_caps_get_minimum_free_size(regions[i].caps));
+
+    metricsAppend(buf, size, &pos,
+        "# HELP " METRICS_PREFIX "uptime_seconds Time since boot\n"
+        "# TYPE " METRICS_PREFIX "uptime_seconds gauge\n"
+        METRICS_PREFIX "uptime_seconds %.3f\n", esp_timer_get_time() * 1e-6);
+
+    return pos >= size ? 0 : pos;
+}
+
+/* HTTP handler for GET '/metrics': Prometheus text format, sent in two chunks */
+static esp_err_t metrics_get_handler(httpd_req_t *req)
+{
+    char *buf = metrics_buf;
+    i2s_capture_stats_t capture;
+    vI2S_GetCaptureStats(&capture);
+    metricsPeak(METRIC_AUDIO_RING_PEAK, capture.ring.high_water);
+
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+
+    esp_err_t ret = ESP_FAIL;
+    size_t length = metricsFormat(buf, METRICS_CHUNK_SIZE);
+    if (length > 0 && httpd_resp_send_chunk(req, buf, length) == ESP_OK)
+    {
+        length = metrics_format_system(buf, METRICS_CHUNK_SIZE);
+        if (length > 0 && httpd_resp_send_chunk(req, buf, length) == ESP_OK)
+            ret = httpd_resp_send_chunk(req, NULL, 0);
+    }
+
+    if (ret != ESP_OK)
+        ESP_LOGW(TAG, "Metrics response failed");
+    return ret;
+}
+
+/* -----------------------------
+ * Event journal
+ * ----------------------------- */
+typedef struct {
+    httpd_req_t *req;
+    char buf[EVENTS_CHUNK_SIZE];
+    size_t pos;
+    esp_err_t err;
+} events_chunk_t;
+
+/* Append to the response, sending the chunk first when `text` does not fit */
+static void events_append(events_chunk_t *chunk, const char *text, int len)
 {
-    if (server == NULL || ws_client_fd < 0)
+    if (chunk->err != ESP_OK || len < 0)
         return;
 
+    if (chunk->pos + len > sizeof(chunk->buf))
+    {
+        chunk->err = httpd_resp_send_chunk(chunk->req, chunk->buf, chunk->pos);
+        chunk->pos = 0;
+    }
+    if (chunk->err == ESP_OK && (size_t)len <= sizeof(chunk->buf))
+    {
+        memcpy(chunk->buf + chunk->pos, text, len);
+        chunk->pos += len;
+    }
+}
+
+static int events_format_record(const journal_record_t *r, char *buf, size_t size)
+{
+    int n = snprintf(buf, size, "{\"seq\":%lu,\"boot\":%u,\"time_ms\":%lu,\"type\":\"%s\"",
+                     (unsigned long)r->seq, r->boot, (unsigned long)r->time_ms,
+                     journalTypeName(r->type));
+    if (r->type != JOURNAL_BOOT && n > 0 && (size_t)n < size)
+        n += snprintf(buf + n, size - n, ",\"freq_hz\":%u,\"pattern\":\"%s\"",
+                      r->freq_hz, cadenceName((cadence_pattern_t)r->pattern));
+    if (r->type != JOURNAL_BOOT && r->peak_db != JOURNAL_LEVEL_UNKNOWN && n > 0 && (size_t)n < size)
+        n += snprintf(buf + n, size - n, ",\"peak_db\":%d", r->peak_db);
+    if (n > 0 && (size_t)n < size)
+        n += snprintf(buf + n, size - n, "}");
+    return n > 0 && (size_t)n < size ? n : -1;
+}
+
+/* HTTP handler for GET '/events': journaled events, oldest first, one page
+ * per request. Page by seq with ?after=<seq>&limit=<n> (pass the returned
+ * "next" as the following "after"), or start at a time with
+ * ?boot=<boot>&since_ms=<ms since that boot>. */
+static esp_err_t events_get_handler(httpd_req_t *req)
+{
+    char params[96] = "";
+    char value[16];
+    uint32_t after = 0;
+    int limit = EVENTS_PAGE_DEFAULT;
+
+    size_t query_len = httpd_req_get_url_query_len(req);
+    if (query_len >= sizeof(params) ||
+        (query_len > 0 && httpd_req_get_url_query_str(req, params, sizeof(params)) != ESP_OK))
+    {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Query too long");
+        return ESP_OK;
+    }
+
+    if (httpd_query_key_value(params, "limit", value, sizeof(value)) == ESP_OK)
+        limit = atoi(value);
+    if (httpd_query_key_value(params, "after", value, sizeof(value)) == ESP_OK)
+        after = strtoul(value, NULL, 10);
+    if (httpd_query_key_value(params, "boot", value, sizeof(value)) == ESP_OK)
+    {
+        uint16_t boot = (uint16_t)strtoul(value, NULL, 10);
+        uint32_t since_ms = 0;
+        if (httpd_query_key_value(params, "since_ms", value, sizeof(value)) == ESP_OK)
+            since_ms = strtoul(value, NULL, 10);
+        after = uxAlarmJournalSeqBefore(boot, since_ms);
+    }
+    if (limit < 1 || limit > EVENTS_PAGE_MAX)
+    {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "limit out of range");
+        return ESP_OK;
+    }
+
+    // One extra record tells whether another page follows
+    static journal_record_t records[EVENTS_PAGE_MAX + 1];
+    static events_chunk_t events_chunk;
+    events_chunk_t *chunk = &events_chunk;
+
+    int count = xAlarmJournalRead(after, records, limit + 1);
+    if (count < 0)
+    {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_send(req, "Event journal not available", HTTPD_RESP_USE_STRLEN);
+        return ESP_OK;
+    }
+
+    bool more = count > limit;
+    if (more)
+        count = limit;
+
+    uint32_t first_seq;
+    uint16_t boot;
+    vAlarmJournalInfo(&first_seq, &boot);
+
+    chunk->req = req;
+    chunk->pos = 0;
+    chunk->err = ESP_OK;
+    httpd_resp_set_type(req, "application/json");
+
+    char line[160];
+    int n = snprintf(line, sizeof(line), "{\"first\":%lu,\"boot\":%u,\"events\":[",
+                     (unsigned long)first_seq, boot);
+    events_append(chunk, line, n);
+    for (int i = 0; i < count; i++)
+    {
+        if (i > 0)
+            events_append(chunk, ",", 1);
+        events_append(chunk, line, events_format_record(&records[i], line, sizeof(line)));
+    }
+    n = snprintf(line, sizeof(line), "],\"next\":%lu,\"more\":%s}",
+                 (unsigned long)(count > 0 ? records[count - 1].seq : after), more ? "true" : "false");
+    events_append(chunk, line, n);
+
+    esp_err_t ret = chunk->err;
+    if (ret == ESP_OK && chunk->pos > 0)
+        ret = httpd_resp_send_chunk(req, chunk->buf, chunk->pos);
+    if (ret == ESP_OK)
+        ret = httpd_resp_send_chunk(req, NULL, 0);
+
+    if (ret != ESP_OK)
+        ESP_LOGW(TAG, "Events response failed");
+    return ret;
+}
+
+/* -----------------------------
+ * Broadcast
+ * ----------------------------- */
+static ws_buffer_t *ws_pool_take(void)
+{
+    uint32_t used = __atomic_load_n(&ws_pool_used, __ATOMIC_RELAXED);
+    for (;;)
+    {
+        if (used == (uint32_t)((1ull << WS_POOL_BUFFERS) - 1))
+            return NULL;
+        int i = __builtin_ctz(~used);
+        if (__atomic_compare_exchange_n(&ws_pool_used, &used, used | (1u << i), false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            return &ws_pool[i];
+    }
+}
+
+static void ws_buffer_release(ws_buffer_t *buf)
+{
+    if (__atomic_sub_fetch(&buf->refs, 1, __ATOMIC_ACQ_REL) == 0)
+        __atomic_fetch_and(&ws_pool_used, ~(1u << (buf - ws_pool)), __ATOMIC_RELEASE);
+}
+
+/* httpd work item: send the shared frame to one client, reaping it on failure */
+static void ws_send_work(void *arg)
+{
+    ws_send_t *send = arg;
+    ws_buffer_t *buf = send->buf;
+
     httpd_ws_frame_t ws_pkt = {
         .final = true,
         .fragmented = false,
-        .type = HTTPD_WS_TYPE_TEXT,
-        .payload = (uint8_t *)msg,
-        .len = strlen(msg)
+        .type = buf->type,
+        .payload = buf->payload,
+        .len = buf->len
     };
 
-    httpd_ws_send_frame_async(server, ws_client_fd, &ws_pkt);
+    if (httpd_ws_get_fd_info(server, send->fd) != HTTPD_WS_CLIENT_WEBSOCKET)
+    {
+        ws_client_remove(send->fd);
+        vSpectrumStreamClose(send->fd);
+    }
+    else if (httpd_ws_send_frame_async(server, send->fd, &ws_pkt) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "WebSocket send failed (fd=%d), closing", send->fd);
+        ws_client_remove(send->fd);
+        vSpectrumStreamClose(send->fd);
+        httpd_sess_trigger_close(server, send->fd);
+    }
+
+    if (send->pending != NULL)
+        __atomic_store_n(send->pending, false, __ATOMIC_RELEASE);
+    ws_buffer_release(buf);
+}
+
+/* Shared copy of a frame for `sends` clients, plus the reference held while queueing */
+static ws_buffer_t *ws_buffer_create(int sends, const void *data, size_t len, httpd_ws_type_t type)
+{
+    if (len > WS_PAYLOAD_MAX)
+    {
+        ESP_LOGE(TAG, "WebSocket frame too long (%u bytes)", (unsigned)len);
+        return NULL;
+    }
+
+    // Copied once; the caller's buffer may be gone before the sends run
+    ws_buffer_t *buf = ws_pool_take();
+    if (buf == NULL)
+    {
+        ESP_LOGW(TAG, "All %d WebSocket frame buffers in flight, dropping", WS_POOL_BUFFERS);
+        return NULL;
+    }
+    buf->refs = sends + 1;
+    buf->type = type;
+    buf->len = len;
+    memcpy(buf->payload, data, len);
+    return buf;
+}
+
+/* Queue buf->sends[i]; drops its reference if the work queue is full */
+static bool ws_buffer_queue(ws_buffer_t *buf, int i, int fd, bool *pending)
+{
+    buf->sends[i].buf = buf;
+    buf->sends[i].fd = fd;
+    buf->sends[i].pending = pending;
+    if (pending != NULL)
+        __atomic_store_n(pending, true, __ATOMIC_RELEASE);
+
+    if (httpd_queue_work(server, ws_send_work, &buf->sends[i]) == ESP_OK)
+        return true;
+
+    if (pending != NULL)
+        __atomic_store_n(pending, false, __ATOMIC_RELEASE);
+    ws_buffer_release(buf);
+    return false;
+}
+
+int webserver_broadcast(const void *data, size_t len, httpd_ws_type_t type)
+{
+    int fds[WS_MAX_CLIENTS];
+    int count;
+
+    if (server == NULL)
+        return 0;
+
+    xSemaphoreTake(ws_clients_lock, portMAX_DELAY);
+    count = ws_client_count;
+    memcpy(fds, ws_clients, count * sizeof(int));
+    xSemaphoreGive(ws_clients_lock);
+
+    if (count == 0)
+        return 0;
+
+    ws_buffer_t *buf = ws_buffer_create(count, data, len, type);
+    if (buf == NULL)
+        return 0;
+
+    int queued = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (ws_buffer_queue(buf, i, fds[i], NULL))
+            queued++;
+    }
+
+    ws_buffer_release(buf);
+    return queued;
+}
+
+bool webserver_send_to(int fd, const void *data, size_t len, httpd_ws_type_t type, bool *pending)
+{
+    if (server == NULL)
+        return false;
+
+    ws_buffer_t *buf = ws_buffer_create(1, data, len, type);
+    if (buf == NULL)
+        return false;
+
+    bool queued = ws_buffer_queue(buf, 0, fd, pending);
+    ws_buffer_release(buf);
+    return queued;
+}
+
+/* -----------------------------
+ * Send arbitrary JSON message
+ * ----------------------------- */
+void webserver_send_message(const char *msg)
+{
+    webserver_broadcast(msg, strlen(msg), HTTPD_WS_TYPE_TEXT);
 }
 
 
@@ -106,32 +716,41 @@ void vWebNotifyTask(void *pvParameters)
     {
         if (xQueueReceive(xFireAlarmEventQueue, &event, portMAX_DELAY) == pdPASS)
         {
+            int64_t start_us = esp_timer_get_time();
+
+            // Prepare log message
+            char log_msg[160];
             switch(event.type)
             {
-                case EVENT_FIRE_ALARM:
-                {
-                    // Prepare log message
-                    char log_msg[128];
-                    snprintf(log_msg, sizeof(log_msg), "[%lld ms] 🚨 Fire Alarm detected! at Frequency : %d Hz", event.timestamp_ms, event.bin);
-
-                    // Print to UART
-                    printf("%s\n", log_msg);
-
-                    // Send to WebSocket
-                    if (server != NULL && ws_client_fd >= 0)
-                    {
-                        httpd_ws_frame_t ws_pkt = {
-                            .final = true,
-                            .fragmented = false,
-                            .type = HTTPD_WS_TYPE_TEXT,
-                            .payload = (uint8_t *)log_msg,
-                            .len = strlen(log_msg)
-                        };
-                        httpd_ws_send_frame_async(server, ws_client_fd, &ws_pkt);
-                    }
-                }
-                break;
+                case EVENT_ALARM_START:
+                    if (event.pattern != CADENCE_NONE)
+                        snprintf(log_msg, sizeof(log_msg), "[%lld ms] 🚨 %s alarm pattern detected! at Frequency : %d Hz", event.timestamp_ms, cadenceName(event.pattern), event.bin);
+                    else
+                        snprintf(log_msg, sizeof(log_msg), "[%lld ms] 🚨 Fire Alarm detected! at Frequency : %d Hz", event.timestamp_ms, event.bin);
+                    break;
+
+                case EVENT_ALARM_ONGOING:
+                    snprintf(log_msg, sizeof(log_msg), "[%lld ms] 🚨 Alarm ongoing for %lld s (%s pattern), peak %.1f dB at %d Hz, %lu confirmations",
+                             event.timestamp_ms, event.duration_ms / 1000, cadenceName(event.pattern), event.peak_db, event.bin, (unsigned long)event.confirmations);
+                    break;
+
+                case EVENT_ALARM_CLEAR:
+                default:
+                    snprintf(log_msg, sizeof(log_msg), "[%lld ms] ✅ Alarm cleared after %lld s (%s pattern), peak %.1f dB at %d Hz",
+                             event.timestamp_ms, event.duration_ms / 1000, cadenceName(event.pattern), event.peak_db, event.bin);
+                    break;
             }
+
+            // Print to UART
+            printf("%s\n", log_msg);
+
+            // Send to every WebSocket client
+            webserver_send_message(log_msg);
+
+            // Audit trail in flash
+            vAlarmJournalRecord(&event);
+
+            vStageRecord(STAGE_NOTIFY, start_us);
         }
     }
 }
@@ -144,7 +763,13 @@ void vWebNotifyTask(void *pvParameters)
 void vWebServerStart(void)
 {
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
-    config.max_uri_handlers = 8;
+    config.max_uri_handlers = 10;
+    config.close_fn = ws_close_fn;
+    config.core_id = NOTIFY_TASK_CORE;      // With the other network-side tasks, off the audio core
+
+    ws_clients_lock = xSemaphoreCreateMutexStatic(&ws_clients_lock_buffer);
+    vSpectrumStreamStart();
+    vAudioRecorderStart();
 
     ESP_LOGI(TAG, "Starting HTTP server...");
     ESP_ERROR_CHECK(httpd_start(&server, &config));
@@ -164,19 +789,69 @@ void vWebServerStart(void)
     };
     httpd_register_uri_handler(server, &ws_uri);
 
+    httpd_uri_t spectrum_uri = {
+        .uri        = "/spectrum",
+        .method     = HTTP_GET,
+        .handler    = spectrum_ws_handler,
+        .is_websocket = true
+    };
+    httpd_register_uri_handler(server, &spectrum_uri);
+
+    httpd_uri_t metrics_uri = {
+        .uri      = "/metrics",
+        .method   = HTTP_GET,
+        .handler  = metrics_get_handler
+    };
+    httpd_register_uri_handler(server, &metrics_uri);
+
+    httpd_uri_t capture_uri = {
+        .uri      = "/capture",
+        .method   = HTTP_GET,
+        .handler  = capture_get_handler
+    };
+    httpd_register_uri_handler(server, &capture_uri);
+
+    httpd_uri_t events_uri = {
+        .uri      = "/events",
+        .method   = HTTP_GET,
+        .handler  = events_get_handler
+    };
+    httpd_register_uri_handler(server, &events_uri);
+
+    httpd_uri_t config_get_uri = {
+        .uri      = "/config",
+        .method   = HTTP_GET,
+        .handler  = config_get_handler
+    };
+    httpd_register_uri_handler(server, &config_get_uri);
+
+    httpd_uri_t config_post_uri = {
+        .uri      = "/config",
+        .method   = HTTP_POST,
+        .handler  = config_post_handler
+    };
+    httpd_register_uri_handler(server, &config_post_uri);
+
     // Create event queue
-    xFireAlarmEventQueue = xQueueCreate(5, sizeof(web_event_t));
+    xFireAlarmEventQueue = xQueueCreateStatic(ALARM_EVENT_QUEUE_LEN, sizeof(web_event_t),
+                                              event_queue_storage, &event_queue_buffer);
 
-    // Start notification task pinned to Core 1
-    xTaskCreatePinnedToCore(
+    // Start notification task on its configured core
+    xWebNotifyTaskHandle = xTaskCreateStaticPinnedToCore(
         vWebNotifyTask,             // Task function
         TASK_WEB_READER_NAME,       // Name
         TASK_WEB_READER_STACK,      // Stack size
         NULL,                       // Parameters
-        TASK_WEB_READER_PRIORITY,   // Priority
-        &xWebNotifyTaskHandle,      // Task handle
-        1                           // Core 1
+        NOTIFY_TASK_PRIORITY,       // Priority
+        notify_stack,               // Stack
+        &notify_task_buffer,        // Task control block
+        NOTIFY_TASK_CORE            // Core
     );
 
+    vMemPlanAdd("web", "frame pool", ws_pool, sizeof(ws_pool));
+    vMemPlanAdd("web", "notify task stack", notify_stack, sizeof(notify_stack));
+    vMemPlanAdd("web", "alarm event queue", event_queue_storage, sizeof(event_queue_storage));
+    vMemPlanAdd("web", "metrics buffer", metrics_buf, sizeof(metrics_buf));
+
     ESP_LOGI(TAG, "Web server started");
 }
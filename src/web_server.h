@@ -2,23 +2,39 @@
 #include "esp_http_server.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
+#include "dsp_cadence.h"
 
 
-// Event types for web server notifications
+// Event types for web server notifications: the lifecycle of one alarm (dsp_alarm.h)
 typedef enum {
-    EVENT_FIRE_ALARM
+    EVENT_ALARM_START,
+    EVENT_ALARM_ONGOING,
+    EVENT_ALARM_CLEAR,
 } web_event_type_t;
 
 typedef struct {
     web_event_type_t type;
-    int bin;
+    int bin;                    // Dominant frequency in Hz
+    cadence_pattern_t pattern;  // CADENCE_NONE: tone confirmed, cadence not recognized
     int64_t timestamp_ms;
+    float peak_db;              // Loudest level of the alarm so far
+    int64_t duration_ms;        // First to latest confirmation
+    uint32_t confirmations;
 } web_event_t;
 
-// Task config
+// WebSocket subscribers served at once (each also takes one of httpd's max_open_sockets)
+#define WS_MAX_CLIENTS            4
+
+// WebSocket frames in flight for all clients together, and the largest payload
+#define WS_POOL_BUFFERS           8
+#define WS_PAYLOAD_MAX            256
+
+// Alarm events waiting for the notification task
+#define ALARM_EVENT_QUEUE_LEN     5
+
+// Task config (core and priority: NOTIFY_TASK_* in config.h)
 #define TASK_WEB_READER_NAME      "WebNotifyTask"
 #define TASK_WEB_READER_STACK     4096
-#define TASK_WEB_READER_PRIORITY  3
 
 // Queue handle for fire alarm events
 extern QueueHandle_t xFireAlarmEventQueue;
@@ -29,6 +45,29 @@ extern QueueHandle_t xFireAlarmEventQueue;
  */
 void vWebServerStart(void);
 
+/**
+ * @brief Queue one frame to every WebSocket client. The data is copied once
+ *        and shared by all sends; clients whose socket has gone are reaped.
+ *        Safe to call from any task.
+ *
+ * @return number of clients the frame was queued for
+ */
+int webserver_broadcast(const void *data, size_t len, httpd_ws_type_t type);
+
+/**
+ * @brief Queue one frame to a single WebSocket client. `pending` (optional)
+ *        is set while the frame waits in the httpd work queue, so a caller
+ *        can drop frames for a client that has not caught up.
+ *
+ * @return false if the frame could not be queued
+ */
+bool webserver_send_to(int fd, const void *data, size_t len, httpd_ws_type_t type, bool *pending);
+
+/**
+ * @brief Broadcast a text message to all WebSocket clients
+ */
+void webserver_send_message(const char *msg);
+
 /**
  * @brief Send fire alarm notification to all clients
  */